@@ -0,0 +1,160 @@
+/*
+ * Entry points of the scanner other than cool_yylex(), for drivers that
+ * lex several files at once.
+ */
+
+#ifndef COOL_LEX_H
+#define COOL_LEX_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <cool-parse.h>
+#include <stringtab.h>
+
+/*
+ * The scanner locates tokens by byte offset.  A line_index holds the
+ * offsets of the newlines of one input, collected a block at a time
+ * with a vectorized pass, and turns offsets into lines and columns
+ * when they are asked for.
+ */
+class line_index {
+private:
+	int first_line;
+	size_t scanned;			/* bytes added so far */
+	std::vector<size_t> newlines;
+
+public:
+	line_index() : first_line(1), scanned(0) { }
+
+	void reset(int first);
+	void add(const char *text, size_t len);
+	size_t size() const { return scanned; }
+
+	/* line and column (both from 1) of the byte at offset */
+	int line(size_t offset) const;
+	int column(size_t offset) const;
+
+	/*
+	 * line() for offsets asked for mostly in increasing order, as a
+	 * scanner does.  cursor counts the newlines before the last offset
+	 * and moves along from there, so a pass over the input costs a step
+	 * per newline rather than a search per token.
+	 */
+	int line(size_t offset, size_t &cursor) const;
+};
+
+/*
+ * One token as returned by cool_yylex(): the offset of its first byte,
+ * the line it ends on (what cool_yylex() leaves in curr_lineno) and its
+ * value.
+ */
+struct cool_token {
+	int token;
+	int line;
+	size_t offset;
+	YYSTYPE value;
+};
+
+/*
+ * A batch of tokens in struct of arrays form.  The caller provides the
+ * arrays, each with room for capacity tokens.  payload holds the value
+ * of a BOOL_CONST or of an INT_CONST (-1 if it does not fit in 32 bits),
+ * so neither needs a lookup.
+ */
+struct cool_token_batch {
+	int *token;
+	int *line;
+	YYSTYPE *value;
+	int *payload;
+	size_t capacity;
+	size_t count;
+	bool eof;
+};
+
+/*
+ * Lex up to batch.capacity tokens of fin into batch, as that many calls
+ * of cool_yylex() would, and return how many there were.  eof is set
+ * once fin is exhausted; curr_lineno is left at the last token's line.
+ * Once eof has been set, further calls on the same fin return 0.
+ */
+size_t lex_batch(cool_token_batch &batch);
+
+/*
+ * Lex every file of files concurrently, leaving the tokens of files[i]
+ * in tokens[i] and, if lines is given, its newline index in lines[i].
+ * Symbols end up in idtable, inttable and stringtable as if the files
+ * had been lexed one after the other.
+ */
+void lex_files(const std::vector<FILE *> &files,
+	       std::vector<std::vector<cool_token> > &tokens,
+	       std::vector<line_index> *lines = NULL);
+
+/*
+ * Integer constants are parsed once, when the scanner interns them.
+ * int_value() gives the value of an inttable entry and int_symbol() the
+ * entry for a value.  A constant too large for 32 bits is still an
+ * INT_CONST, as in the course lexer; int_too_large() is true for it,
+ * and int_value() gives 0.
+ */
+int int_value(Symbol sym);
+bool int_too_large(Symbol sym);
+Symbol int_symbol(int value);
+
+/*
+ * Incremental relexing, for editors and watch modes.  A relexer holds
+ * the text of one file and its tokens, in runs of a few tokens that
+ * each start where the scanner is in INITIAL with no comment open.
+ * edit() replaces removed bytes at offset with added bytes of text and
+ * relexes from the start of the run the edit falls in, stopping as
+ * soon as a token ends where an old one did, in the same state, past
+ * the edit: from there on the old tokens are kept.  A token holds its
+ * offset and line from the start of its run, so moving the rest of the
+ * file along by the size of the edit costs one step per run rather
+ * than one per token.  Relexing always uses the hand written scanner,
+ * which can start anywhere in the text without copying it.
+ */
+struct cool_scanner;
+
+class relexer {
+private:
+	struct entry {
+		cool_token token;	/* offset and line from its run's */
+		size_t end;		/* from its run's offset */
+		bool initial;		/* leaves the scanner in INITIAL */
+	};
+
+	struct run {
+		size_t first;		/* index of its first token */
+		size_t offset;
+		int line;		/* of the byte at offset */
+		std::vector<entry> tokens;
+	};
+
+	std::string src;
+	std::vector<run> runs;
+	line_index nl;			/* newlines of the text being relexed */
+	size_t every;			/* tokens a run is cut at */
+	size_t last_relexed;
+	cool_scanner *scanner;
+
+	size_t run_at(size_t offset) const;
+
+public:
+	relexer(const char *text, size_t len, size_t run_length = 64);
+	~relexer();
+
+	void edit(size_t offset, size_t removed, const char *text, size_t added);
+
+	const std::string &text() const { return src; }
+	size_t size() const {
+		return runs.back().first + runs.back().tokens.size();
+	}
+	cool_token token(size_t i) const;
+	std::vector<cool_token> tokens() const;
+	int line(size_t offset) const;	/* of the byte at offset */
+	size_t relexed() const { return last_relexed; }	/* by the last edit */
+};
+
+#endif
@@ -0,0 +1,194 @@
+# chmod a+x lexer-batch-bench.pl
+#!/usr/bin/perl -w
+
+# Microbenchmark of the two ways of taking tokens from the scanner: one
+# cool_yylex() call per token, and lex_batch() filling arrays of a few
+# thousand tokens.  Builds a small driver against the objects 'make
+# lexer' leaves behind (all but lextest.o), generates a synthetic
+# corpus, and gives the best tokens per second of each interface with
+# the flex DFA and with COOL_LEXER=fast.  Both interfaces must see the
+# same tokens on the same lines.
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $cxx = "g++";
+my $cxxflags = "-O2 -I. -I/usr/class/cool/include/PA2";
+my $objs = "cool-lex.o utilities.o stringtab.o handle_flags.o";
+my $runs = 3;
+my $size = 100;
+my $capacity = 4096;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -cxx <path>        - compiler [default = \"$cxx\"]\n";
+    print "             -cxxflags <flags>  - its flags [default = \"$cxxflags\"]\n";
+    print "             -objs <files>      - objects of the lexer\n";
+    print "                                  [default = \"$objs\"]\n";
+    print "             -runs <n>          - best of n runs [default = $runs]\n";
+    print "             -size <MB>         - size of the corpus [default = $size]\n";
+    print "             -capacity <n>      - tokens per batch [default = $capacity]\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("cxx=s" => \$cxx,
+		      "cxxflags=s" => \$cxxflags,
+		      "objs=s" => \$objs,
+		      "runs=i" => \$runs,
+		      "size=i" => \$size,
+		      "capacity=i" => \$capacity,
+		      "help" => sub { usage(); exit 0; }));
+
+foreach my $o (split(' ', $objs)) {
+    die "$o not found; build the lexer with 'make lexer'\n" unless -f $o;
+}
+
+# The driver.  It stands in for lextest.cc, so it defines what that
+# does; curr_lineno and verbose_flag are weak in case one of the support
+# files defines them instead.
+my $driver = <<'END';
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+#include "cool-parse.h"
+#include "cool-lex.h"
+
+FILE *fin;
+YYSTYPE cool_yylval;
+int curr_lineno __attribute__((weak)) = 1;
+int verbose_flag __attribute__((weak));
+
+extern int cool_yylex();
+
+static double now()
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void open_input(const char *file)
+{
+	if ((fin = fopen(file, "r")) == NULL) {
+		perror(file);
+		exit(1);
+	}
+	curr_lineno = 1;
+}
+
+/* Tokens of file, one call each; sum is a checksum of kinds and lines. */
+static size_t per_call(const char *file, unsigned long &sum)
+{
+	size_t n = 0;
+	int token;
+
+	open_input(file);
+	sum = 0;
+	while ((token = cool_yylex()) != 0) {
+		sum = sum * 31 + token * 7 + curr_lineno;
+		n++;
+	}
+	fclose(fin);
+	return n;
+}
+
+static size_t batched(const char *file, size_t capacity, unsigned long &sum)
+{
+	std::vector<int> token(capacity), line(capacity), payload(capacity);
+	std::vector<YYSTYPE> value(capacity);
+	cool_token_batch batch = { token.data(), line.data(), value.data(),
+				   payload.data(), capacity, 0, false };
+	size_t n = 0;
+
+	open_input(file);
+	sum = 0;
+	do {
+		lex_batch(batch);
+		for (size_t i = 0; i < batch.count; i++)
+			sum = sum * 31 + token[i] * 7 + line[i];
+		n += batch.count;
+	} while (!batch.eof);
+	fclose(fin);
+	return n;
+}
+
+int main(int argc, char **argv)
+{
+	const char *file = argv[1];
+	int runs = atoi(argv[2]);
+	size_t capacity = (size_t) atol(argv[3]);
+	size_t counts[2];
+	unsigned long sums[2];
+
+	for (int mode = 0; mode < 2; mode++) {
+		double best = 0;
+
+		for (int i = 0; i < runs; i++) {
+			double start = now();
+			counts[mode] = mode == 0 ? per_call(file, sums[mode]) :
+				       batched(file, capacity, sums[mode]);
+			double t = now() - start;
+			if (i == 0 || t < best)
+				best = t;
+		}
+		printf("%s %lu %.3f\n", mode == 0 ? "per-call" : "batch",
+		       (unsigned long) counts[mode], best);
+	}
+	return counts[0] == counts[1] && sums[0] == sums[1] ? 0 : 1;
+}
+END
+
+# Code with every kind of token, repeated with a new class name.
+my $code = <<'END';
+class C%N% inherits IO {
+  x : Int <- %N%;
+  f(a : Int, s : String) : Object {
+    let b : Bool <- true in
+      if isvoid s then a * 2 + 1 else while not b loop b <- false pool fi
+  };
+  g() : String { case self of o : Object => "text %N%\n"; esac };
+};
+END
+
+my $dir = tempdir("lexer-batch-bench-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+open(my $out, ">", "$dir/bench.cc") or die "$dir/bench.cc: $!\n";
+print $out $driver;
+close($out);
+system("$cxx $cxxflags $dir/bench.cc $objs -o $dir/bench -lpthread") == 0
+    or die "could not build the driver\n";
+
+my $file = "$dir/corpus.cl";
+my $bytes = $size << 20;
+open($out, ">", $file) or die "$file: $!\n";
+for (my ($n, $written) = (0, 0); $written < $bytes; $n++) {
+    (my $class = $code) =~ s/%N%/$n/g;
+    print $out $class;
+    $written += length($class);
+}
+close($out);
+
+my $failed = 0;
+printf("%-8s %-9s %12s %10s %10s\n", "scanner", "interface", "tokens", "s",
+       "Mtokens/s");
+foreach my $fast (0, 1) {
+    my $scanner = $fast ? "fast" : "flex";
+    local $ENV{COOL_LEXER} = $fast ? "fast" : "";
+    open(my $pipe, "-|", "$dir/bench", $file, $runs, $capacity)
+	or die "$dir/bench: $!\n";
+    while (<$pipe>) {
+	my ($interface, $tokens, $t) = split;
+	printf("%-8s %-9s %12d %10.3f %10.2f\n", $scanner, $interface, $tokens,
+	       $t, $tokens / $t / 1e6);
+    }
+    close($pipe);
+    if ($? != 0) {
+	print "$scanner: the interfaces saw different tokens\n";
+	$failed++;
+    }
+}
+exit($failed ? 1 : 0);
@@ -0,0 +1,244 @@
+# chmod a+x lexer-bench.pl
+#!/usr/bin/perl -w
+
+# Lexer benchmark.  Generates inputs that stress one part of the
+# scanner, checks that each lexes to the tokens it should, and times the
+# lexer over them with the flex DFA and with COOL_LEXER=fast, each
+# reading the file through a mapping and, with COOL_LEX_INPUT=fread,
+# through stdio.  Given -base, a lexer built from an older cool.flex is
+# timed alongside and must produce the same dumps.  The sizes of the DFA tables are read
+# from the scanner flex generated, for each lexer given one.
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+use Time::HiRes qw(time);
+
+my $lexer = "./lexer";
+my $base;
+my $dfa = "cool-lexer.cc";
+my $base_dfa;
+my $runs = 5;
+my $size = 8;
+my $only;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path> - lexer to time [default = \"$lexer\"]\n";
+    print "             -base <path>  - older lexer to compare against\n";
+    print "             -dfa <file>   - scanner flex made for the lexer\n";
+    print "                             [default = \"$dfa\"]\n";
+    print "             -base-dfa <file> - the same for the older lexer\n";
+    print "             -runs <n>     - best of n runs [default = $runs]\n";
+    print "             -size <MB>    - size of each input [default = $size]\n";
+    print "             -only <name>  - run the inputs whose name matches\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "base=s" => \$base,
+		      "dfa=s" => \$dfa,
+		      "base-dfa=s" => \$base_dfa,
+		      "runs=i" => \$runs,
+		      "size=i" => \$size,
+		      "only=s" => \$only,
+		      "help" => sub { usage(); exit 0; }));
+
+foreach my $l ($lexer, defined($base) ? $base : ()) {
+    die "$l is not executable; build it with 'make lexer'\n" unless -x $l;
+}
+
+my $bytes = $size << 20;
+
+# A class after every comment, so the dump shows what the comments left.
+sub class_after {
+    my ($n) = @_;
+    return "class C$n { };\n";
+}
+
+sub class_tokens {
+    my ($n) = @_;
+    return ("CLASS", "TYPEID C$n", "'{'", "'}'", "';'");
+}
+
+# Text for comment bodies, with the ( ) and * that a body may hold
+# without opening or closing a comment.
+my $prose = "Permission is hereby granted, free of charge (subject to\n" .
+    "the conditions below), to any person obtaining a copy * of this\n" .
+    "software; f(a) * g((b)) ** h, x := y * (z) -- not a dash comment\n";
+
+# Code with a keyword, in some mix of cases, for every few identifiers;
+# %N% is replaced by the number of the class.
+my $code = <<'END';
+class C%N% INHERITS IO {
+  f(x : Int, s : String) : Object {
+    let y : Int <- x * 2 + %N% in
+      IF isvoid s Then y else WHILE not tRUE LOOP y <- y - 1 pool FI
+  };
+  g() : Bool { case self of o : Object => true; True : Bool => fALSE; esac };
+  h : String <- "str%N%";
+};
+END
+my @code_tokens = (
+    "CLASS", "TYPEID C%N%", "INHERITS", "TYPEID IO", "'{'",
+    "OBJECTID f", "'('", "OBJECTID x", "':'", "TYPEID Int", "','",
+    "OBJECTID s", "':'", "TYPEID String", "')'", "':'", "TYPEID Object",
+    "'{'",
+    "LET", "OBJECTID y", "':'", "TYPEID Int", "ASSIGN", "OBJECTID x", "'*'",
+    "INT_CONST 2", "'+'", "INT_CONST %N%", "IN",
+    "IF", "ISVOID", "OBJECTID s", "THEN", "OBJECTID y", "ELSE", "WHILE",
+    "NOT", "BOOL_CONST true", "LOOP", "OBJECTID y", "ASSIGN", "OBJECTID y",
+    "'-'", "INT_CONST 1", "POOL", "FI",
+    "'}'", "';'",
+    "OBJECTID g", "'('", "')'", "':'", "TYPEID Bool", "'{'", "CASE",
+    "OBJECTID self", "OF", "OBJECTID o", "':'", "TYPEID Object", "DARROW",
+    "BOOL_CONST true", "';'", "TYPEID True", "':'", "TYPEID Bool", "DARROW",
+    "BOOL_CONST false", "';'", "ESAC", "'}'", "';'",
+    "OBJECTID h", "':'", "TYPEID String", "ASSIGN", "STR_CONST \"str%N%\"",
+    "';'",
+    "'}'", "';'",
+);
+
+# Each input is a name, a sub returning its text and the tokens it must
+# lex to.
+my @inputs = (
+    [ "keywords", sub {
+	my ($text, @tokens) = ("");
+	for (my $n = 0; length($text) < $bytes; $n++) {
+	    (my $class = $code) =~ s/%N%/$n/g;
+	    $text .= $class;
+	    push(@tokens, map { (my $t = $_) =~ s/%N%/$n/g; $t } @code_tokens);
+	}
+	return ($text, @tokens);
+    } ],
+    [ "long-comments", sub {
+	my ($text, @tokens) = ("");
+	for (my $n = 0; length($text) < $bytes; $n++) {
+	    $text .= "(*\n" . ($prose x 160) . "*)\n" . class_after($n);
+	    push(@tokens, class_tokens($n));
+	}
+	return ($text, @tokens);
+    } ],
+    [ "deep-nesting", sub {
+	my ($text, @tokens) = ("");
+	for (my $n = 0; length($text) < $bytes; $n++) {
+	    my $depth = 1 + $n % 200;
+	    $text .= ("(* " . $prose) x $depth . ($prose . " *)") x $depth;
+	    $text .= "\n" . class_after($n);
+	    push(@tokens, class_tokens($n));
+	}
+	return ($text, @tokens);
+    } ],
+    [ "license-headers", sub {
+	my ($text, @tokens) = ("");
+	for (my $n = 0; length($text) < $bytes; $n++) {
+	    $text .= "(*\n" . ($prose x 12) . " *)\n" . class_after($n);
+	    $text .= "-- " . substr($prose, 0, 40) . "\n";
+	    push(@tokens, class_tokens($n));
+	}
+	return ($text, @tokens);
+    } ],
+    [ "eof-in-comment", sub {
+	my $text = "(* (* *)\n";
+	$text .= $prose while length($text) < $bytes;
+	return ($text, "ERROR \"EOF in comment\"");
+    } ],
+);
+
+sub dump_tokens {
+    my ($l, $fast, $read, $file) = @_;
+    my $out;
+
+    local $ENV{COOL_LEXER} = $fast ? "fast" : "";
+    local $ENV{COOL_LEX_INPUT} = $read eq "fread" ? "fread" : "";
+    open(my $pipe, "-|", $l, $file) or die "$l: $!\n";
+    { local $/; $out = <$pipe>; }
+    close($pipe);
+    die "$l $file: exit status $?\n" if $? != 0;
+    return $out;
+}
+
+# Entries and bytes of the tables in a scanner made by flex, and the
+# number of states of its DFA.
+sub dfa_size {
+    my ($file) = @_;
+    my %width = ("flex_int16_t" => 2, "flex_int32_t" => 4, "YY_CHAR" => 1,
+		 "flex_uint8_t" => 1, "short" => 2, "int" => 4, "char" => 1);
+    my ($entries, $bytes, $states) = (0, 0, 0);
+
+    open(my $in, "<", $file) or return;
+    while (<$in>) {
+	next unless /^static\s+(?:yyconst\s+|const\s+)*(\w+)(?:\s+int)?\s+(yy_\w+)\[(\d+)\]/;
+	next unless exists $width{$1};
+	$entries += $3;
+	$bytes += $3 * $width{$1};
+	$states = $3 - 1 if $2 eq "yy_accept";
+    }
+    close($in);
+    return sprintf("%d states, %d table entries, %d bytes", $states,
+		   $entries, $bytes);
+}
+
+sub best_time {
+    my ($l, $fast, $read, $file) = @_;
+    my $best;
+
+    local $ENV{COOL_LEXER} = $fast ? "fast" : "";
+    local $ENV{COOL_LEX_INPUT} = $read eq "fread" ? "fread" : "";
+    for (my $i = 0; $i < $runs; $i++) {
+	my $start = time();
+	system("'$l' '$file' > /dev/null") == 0 or die "$l $file: failed\n";
+	my $t = time() - $start;
+	$best = $t if !defined($best) || $t < $best;
+    }
+    return $best;
+}
+
+my $dir = tempdir("lexer-bench-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+my $failed = 0;
+
+foreach my $d ([ "base", $base_dfa ], [ "lexer", $dfa ]) {
+    my ($which, $file) = @$d;
+    next unless defined($file);
+    my $size = dfa_size($file);
+    print "$which DFA ($file): ", defined($size) ? $size : "not found", "\n";
+}
+printf("%-16s %-8s %-6s %10s %10s %10s %10s\n", "input", "scanner", "read",
+       "base s", "lexer s", "MB/s", "Mtokens/s");
+foreach my $input (@inputs) {
+    my ($name, $make) = @$input;
+    next if defined($only) && $name !~ /$only/;
+
+    my ($text, @tokens) = $make->();
+    my $file = "$dir/$name.cl";
+    open(my $out, ">", $file) or die "$file: $!\n";
+    print $out $text;
+    close($out);
+
+    my $want = join("\n", @tokens);
+    foreach my $fast (0, 1) {
+	foreach my $read ("mmap", "fread") {
+	    my $scanner = $fast ? "fast" : "flex";
+	    my $dump = dump_tokens($lexer, $fast, $read, $file);
+	    my $got = join("\n", map { s/^#\d+ //; $_ } grep { !/^#name / }
+			   split(/\n/, $dump));
+	    if ($got ne $want) {
+		print "$name: $scanner/$read does not lex to the expected tokens\n";
+		$failed++;
+	    }
+	    if (defined($base) && dump_tokens($base, $fast, $read, $file) ne $dump) {
+		print "$name: $scanner/$read differs from $base\n";
+		$failed++;
+	    }
+
+	    my $t = best_time($lexer, $fast, $read, $file);
+	    printf("%-16s %-8s %-6s %10s %10.3f %10.1f %10.2f\n", $name, $scanner,
+		   $read, defined($base) ?
+		   sprintf("%.3f", best_time($base, $fast, $read, $file)) : "-",
+		   $t, length($text) / $t / (1 << 20), @tokens / $t / 1e6);
+	}
+    }
+}
+exit($failed ? 1 : 0);
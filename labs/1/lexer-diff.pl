@@ -0,0 +1,479 @@
+# chmod a+x lexer-diff.pl
+#!/usr/bin/perl -w
+
+# Differential test of the two scanners: runs the lexer built from
+# cool.flex with the flex DFA and with COOL_LEXER=fast over the example
+# programs and over fuzzed inputs, and reports every file whose token
+# dumps differ, with the first line where they do.
+#
+# It also builds a small driver against the objects 'make lexer' leaves
+# behind (all but lextest.o) and checks the other two ways of lexing
+# against the plain one: a relexer given random edits must hold the
+# tokens a new relexer of the edited text would, after every edit, and
+# lex_files() over all the files must give the tokens and the symbol
+# tables of lexing them one after the other with cool_yylex().
+
+use strict;
+
+use File::Basename;
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $root = dirname(__FILE__) . "/../..";
+my $lexer = "./lexer";
+my $cxx = "g++";
+my $cxxflags = "-O2 -I. -I/usr/class/cool/include/PA2";
+my $objs = "cool-lex.o utilities.o stringtab.o handle_flags.o";
+my $count = 500;
+my $seed = 1;
+my $edits = 20;
+my $run_length = 4;
+my $no_driver;
+my $keep;
+my $verbose;
+
+sub usage {
+    print "Usage: $0 [options] [file.cl ...]\n";
+    print "    Options: -lexer <path>      - lexer to run [default = \"$lexer\"]\n";
+    print "             -n <count>         - fuzzed inputs to make [default = $count]\n";
+    print "             -seed <n>          - seed of the first one [default = $seed]\n";
+    print "             -edits <n>         - edits per file for the relexer\n";
+    print "                                  [default = $edits]\n";
+    print "             -run-length <n>    - tokens per run of the relexer\n";
+    print "                                  [default = $run_length]\n";
+    print "             -cxx <path>        - compiler [default = \"$cxx\"]\n";
+    print "             -cxxflags <flags>  - its flags [default = \"$cxxflags\"]\n";
+    print "             -objs <files>      - objects of the lexer\n";
+    print "                                  [default = \"$objs\"]\n";
+    print "             -no-driver         - only compare the two scanners\n";
+    print "             -keep              - keep the fuzzed inputs\n";
+    print "             -v                 - name each file as it is checked\n";
+    print "    Files given are checked too.  COOL_LEX_INPUT and\n";
+    print "    COOL_LEX_THREADS are passed on to both scanners.\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "n=i" => \$count,
+		      "seed=i" => \$seed,
+		      "edits=i" => \$edits,
+		      "run-length=i" => \$run_length,
+		      "cxx=s" => \$cxx,
+		      "cxxflags=s" => \$cxxflags,
+		      "objs=s" => \$objs,
+		      "no-driver" => \$no_driver,
+		      "keep" => \$keep,
+		      "v" => \$verbose,
+		      "help" => sub { usage(); exit 0; }));
+
+die "$lexer is not executable; build it with 'make lexer'\n" unless -x $lexer;
+unless ($no_driver) {
+    foreach my $o (split(' ', $objs)) {
+	die "$o not found; build the lexer with 'make lexer'\n" unless -f $o;
+    }
+}
+
+my @examples = (glob("$root/examples/*.cl"), "$root/tasks/stack.cl",
+		"$root/labs/2/good.cl", "$root/labs/2/bad.cl");
+my @files = (@examples, @ARGV);
+
+# Pieces the fuzzer strings together: whole tokens, the edges of
+# comments and strings, escapes, and bytes the scanners treat apart.
+my @pieces = (
+    "class", "CLASS", "Class", "inherits", "if", "then", "else", "fi",
+    "while", "loop", "pool", "let", "in", "case", "of", "esac", "new",
+    "isvoid", "not", "true", "false", "True", "fALSE", "tRuE",
+    "x", "y1", "self", "SELF_TYPE", "Main", "Foo_bar", "_x", "a" x 70,
+    "0", "007", "42", "2147483647", "2147483648", "99999999999",
+    "<-", "<=", "=>", "<", "=", "-", "+", "*", "/", "~", "@", ".", ",",
+    ":", ";", "(", ")", "{", "}", "[", "]", "!", "#", "\$", "%", "^",
+    "&", "|", "?", "`", "'", ">", "\\",
+    "(*", "*)", "(*)", "(**)", "*", "--", "-- text\n", "(* a (* b *) c *)",
+    "\"", "\"abc\"", "\"a\\nb\"", "\"\\t\\b\\f\\\"\"", "\"\\\n\"",
+    "\"\\q\\0\"", "\"x\ny\"", "\"" . ("s" x 1030) . "\"", "\\\"",
+    " ", "  ", "\t", "\n", "\r", "\f", "\013", "\r\n", "\n\n\n",
+    "\000", "\001", "\177", "\200", "\377", "\303\251",
+);
+
+sub fuzz {
+    my ($n) = @_;
+    my $text = "";
+
+    srand($n);
+    # half the inputs are splices of the examples with pieces dropped in
+    if ($n % 2 == 0) {
+	my $file = $examples[int(rand(@examples))];
+	local $/;
+	open(my $in, "<", $file) or die "$file: $!\n";
+	$text = <$in>;
+	close($in);
+	for (my $i = int(rand(8)); $i >= 0; $i--) {
+	    my $at = int(rand(length($text) + 1));
+	    my $cut = int(rand(4));
+	    substr($text, $at, $cut) = $pieces[int(rand(@pieces))];
+	}
+    } else {
+	for (my $i = 1 + int(rand(200)); $i > 0; $i--) {
+	    $text .= $pieces[int(rand(@pieces))];
+	    $text .= (" ", "\n", "")[int(rand(3))];
+	}
+    }
+    # and some end inside a comment or a string
+    $text .= ("", "", "", "(*", "\"", "\"abc\\", "(* (*")[int(rand(7))];
+    return $text;
+}
+
+sub dump_tokens {
+    my ($fast, $file) = @_;
+    my $out;
+
+    local $ENV{COOL_LEXER} = $fast ? "fast" : "";
+    open(my $pipe, "-|", $lexer, $file) or die "$lexer: $!\n";
+    { local $/; $out = <$pipe>; }
+    close($pipe);
+    die "$lexer $file: exit status $?\n" if $? != 0;
+    return defined($out) ? $out : "";
+}
+
+# Compare two outputs line by line and report the first line where
+# they differ, under the names given for each.
+sub same_lines {
+    my ($what, $name_a, $out_a, $name_b, $out_b) = @_;
+    my @a = split(/\n/, $out_a, -1);
+    my @b = split(/\n/, $out_b, -1);
+    my $width = length($name_a) > length($name_b) ? length($name_a) : length($name_b);
+
+    for (my $i = 0; $i < @a || $i < @b; $i++) {
+	my $x = $i < @a ? $a[$i] : "(end)";
+	my $y = $i < @b ? $b[$i] : "(end)";
+	next if $x eq $y;
+	print "$what differ at line ", $i + 1, "\n";
+	printf("    %-*s %s\n    %-*s %s\n", $width + 1, "$name_a:", $x,
+	       $width + 1, "$name_b:", $y);
+	return 0;
+    }
+    return 1;
+}
+
+sub check {
+    my ($file) = @_;
+
+    print "$file\n" if $verbose;
+    return same_lines("$file: token dumps", "flex", dump_tokens(0, $file),
+		      "fast", dump_tokens(1, $file));
+}
+
+# The driver.  It stands in for lextest.cc, so it defines what that
+# does; curr_lineno and verbose_flag are weak in case one of the support
+# files defines them instead.  "in-order" and "lex-files" print every
+# token of the files given and then the symbol tables, and "relex"
+# applies an edit script to one file and stops at the first edit after
+# which the relexer's tokens are not those of a new relexer.
+my $driver = <<'END';
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "cool-parse.h"
+#include "cool-lex.h"
+
+FILE *fin;
+YYSTYPE cool_yylval;
+int curr_lineno __attribute__((weak)) = 1;
+int verbose_flag __attribute__((weak));
+
+extern int cool_yylex();
+
+/*
+ * Where the driver writes.  The scanners echo the bytes no rule matches
+ * to stdout, as flex does, and do so while lexing; that goes to
+ * /dev/null so it does not land in one dump at a different place than
+ * in the other.  The first part of the test compares it.
+ */
+static FILE *out;
+
+static bool has_symbol(int token)
+{
+	return token == OBJECTID || token == TYPEID || token == INT_CONST ||
+	       token == STR_CONST;
+}
+
+static void print_text(const char *s, size_t len)
+{
+	fputc(' ', out);
+	for (size_t i = 0; i < len; i++) {
+		unsigned char c = s[i];
+		if (c < ' ' || c >= 0177 || c == '\\')
+			fprintf(out, "\\%03o", c);
+		else
+			fputc(c, out);
+	}
+}
+
+static void print_token(size_t file, int token, int line, YYSTYPE value)
+{
+	fprintf(out, "%lu %d %d", (unsigned long) file, token, line);
+	if (has_symbol(token))
+		print_text(value.symbol->get_string(), value.symbol->get_len());
+	else if (token == BOOL_CONST)
+		fprintf(out, " %d", value.boolean);
+	else if (token == ERROR)
+		print_text(value.error_msg, strlen(value.error_msg));
+	fputc('\n', out);
+}
+
+/* The entry list and indices are protected; see table_access in cool.flex. */
+template <class Elem>
+struct table_access : public StringTable<Elem> {
+	static List<Elem> *list(StringTable<Elem> &t)
+	{
+		return t.*(&table_access::tbl);
+	}
+};
+
+struct entry_access : public Entry {
+	static int get_index(Entry *e)
+	{
+		return e->*(&entry_access::index);
+	}
+};
+
+/* The entries of table, newest first, with their indices. */
+template <class Elem>
+static void print_table(const char *name, StringTable<Elem> &table)
+{
+	for (List<Elem> *l = table_access<Elem>::list(table); l != NULL; l = l->tl()) {
+		fprintf(out, "%s %d", name, entry_access::get_index(l->hd()));
+		print_text(l->hd()->get_string(), l->hd()->get_len());
+		fputc('\n', out);
+	}
+}
+
+static FILE *open_input(const char *file)
+{
+	FILE *f = fopen(file, "r");
+
+	if (f == NULL) {
+		perror(file);
+		exit(1);
+	}
+	return f;
+}
+
+static void in_order(int n, char **files)
+{
+	int token;
+
+	for (int i = 0; i < n; i++) {
+		fin = open_input(files[i]);
+		curr_lineno = 1;
+		while ((token = cool_yylex()) != 0)
+			print_token(i, token, curr_lineno, cool_yylval);
+		fclose(fin);
+	}
+}
+
+static void at_once(int n, char **files)
+{
+	std::vector<FILE *> inputs;
+	std::vector<std::vector<cool_token> > tokens;
+
+	for (int i = 0; i < n; i++)
+		inputs.push_back(open_input(files[i]));
+	lex_files(inputs, tokens);
+	for (int i = 0; i < n; i++) {
+		fclose(inputs[i]);
+		for (size_t j = 0; j < tokens[i].size(); j++)
+			print_token(i, tokens[i][j].token, tokens[i][j].line,
+				    tokens[i][j].value);
+	}
+}
+
+static bool same_token(const cool_token &a, const cool_token &b)
+{
+	if (a.token != b.token || a.line != b.line || a.offset != b.offset)
+		return false;
+	if (has_symbol(a.token))
+		return a.value.symbol == b.value.symbol;
+	if (a.token == BOOL_CONST)
+		return a.value.boolean == b.value.boolean;
+	if (a.token == ERROR)
+		return strcmp(a.value.error_msg, b.value.error_msg) == 0;
+	return true;
+}
+
+static void print_relexed(const char *which, const cool_token &t)
+{
+	fprintf(out, "    %s offset %lu: ", which, (unsigned long) t.offset);
+	print_token(0, t.token, t.line, t.value);
+}
+
+/* 0 if every edit of the script leaves the tokens a new relexer finds. */
+static int relex(size_t run_length, const char *file, const char *script)
+{
+	FILE *f = open_input(file);
+	std::string text;
+	char buf[8192];
+	size_t n;
+
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		text.append(buf, n);
+	fclose(f);
+
+	relexer r(text.data(), text.size(), run_length);
+	FILE *edits = open_input(script);
+	size_t offset, removed;
+	int k = 0;
+
+	while (fscanf(edits, "%lu %lu %8191s", &offset, &removed, buf) == 3) {
+		std::string added;
+		for (size_t i = 0; buf[0] != '-' && buf[i] != '\0'; i += 2) {
+			unsigned byte;
+			sscanf(buf + i, "%2x", &byte);
+			added += (char) byte;
+		}
+		r.edit(offset, removed, added.data(), added.size());
+		k++;
+
+		relexer fresh(r.text().data(), r.text().size(), run_length);
+		std::vector<cool_token> have = r.tokens(), want = fresh.tokens();
+		for (size_t i = 0; i < have.size() || i < want.size(); i++) {
+			if (i < have.size() && i < want.size() && same_token(have[i], want[i]))
+				continue;
+			fprintf(out, "edit %d (%lu %lu) leaves token %lu different\n", k,
+			       (unsigned long) offset, (unsigned long) removed,
+			       (unsigned long) i);
+			if (i < have.size())
+				print_relexed("relexed:", have[i]);
+			if (i < want.size())
+				print_relexed("new:    ", want[i]);
+			fclose(edits);
+			return 1;
+		}
+	}
+	fclose(edits);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	out = fdopen(dup(fileno(stdout)), "w");
+	if (out == NULL || freopen("/dev/null", "w", stdout) == NULL)
+		return 2;
+	if (argc == 5 && strcmp(argv[1], "relex") == 0)
+		return relex((size_t) atol(argv[2]), argv[3], argv[4]);
+	if (argc < 2)
+		return 2;
+	if (strcmp(argv[1], "in-order") == 0)
+		in_order(argc - 2, argv + 2);
+	else if (strcmp(argv[1], "lex-files") == 0)
+		at_once(argc - 2, argv + 2);
+	else
+		return 2;
+	print_table("id", idtable);
+	print_table("int", inttable);
+	print_table("str", stringtable);
+	return 0;
+}
+END
+
+my $dir = tempdir("lexer-diff-XXXXXX", TMPDIR => 1, CLEANUP => !$keep);
+for (my $n = $seed; $n < $seed + $count; $n++) {
+    my $file = "$dir/fuzz$n.cl";
+    open(my $out, ">", $file) or die "$file: $!\n";
+    binmode($out);
+    print $out fuzz($n);
+    close($out);
+    push(@files, $file);
+}
+
+my $failed = 0;
+foreach my $file (@files) {
+    $failed++ unless check($file);
+}
+print scalar(@files) - $failed, " of ", scalar(@files),
+    " files lexed the same", ($keep ? " (inputs in $dir)" : ""), "\n";
+exit($failed ? 1 : 0) if $no_driver;
+
+open(my $out, ">", "$dir/driver.cc") or die "$dir/driver.cc: $!\n";
+print $out $driver;
+close($out);
+system("$cxx $cxxflags $dir/driver.cc $objs -o $dir/driver -lpthread") == 0
+    or die "could not build the driver\n";
+
+# Run the driver and return its output, and its exit status.
+sub driver {
+    my (@args) = @_;
+    my $out;
+
+    open(my $pipe, "-|", "$dir/driver", @args) or die "$dir/driver: $!\n";
+    { local $/; $out = <$pipe>; }
+    close($pipe);
+    return (defined($out) ? $out : "", $?);
+}
+
+# A script of random edits to the text of file, a line "offset removed
+# added" each, with the added bytes in hex ("-" for none).  The bytes
+# added are one of the fuzzer's pieces or a few bytes of the text.
+sub edit_script {
+    my ($file, $n) = @_;
+    my ($text, $script) = ("", "");
+
+    srand($n);
+    {
+	local $/;
+	open(my $in, "<", $file) or die "$file: $!\n";
+	binmode($in);
+	$text = <$in>;
+	close($in);
+    }
+    for (my $i = 0; $i < $edits; $i++) {
+	my $at = int(rand(length($text) + 1));
+	my $cut = int(rand(1 + (length($text) - $at < 4 ? length($text) - $at : 4)));
+	my $add = "";
+	if (rand() < 0.5) {
+	    $add = $pieces[int(rand(@pieces))];
+	} elsif (length($text) > 0) {
+	    $add = substr($text, int(rand(length($text))), 1 + int(rand(8)));
+	}
+	substr($text, $at, $cut) = $add;
+	$script .= "$at $cut " . (length($add) ? unpack("H*", $add) : "-") . "\n";
+    }
+    return $script;
+}
+
+my $relex_failed = 0;
+for (my $i = 0; $i < @files; $i++) {
+    my $script = "$dir/edits";
+    open(my $out, ">", $script) or die "$script: $!\n";
+    print $out edit_script($files[$i], $seed + $i);
+    close($out);
+
+    print "$files[$i] (relexer)\n" if $verbose;
+    my ($report, $status) = driver("relex", $run_length, $files[$i], $script);
+    next if $status == 0;
+    print "$files[$i]: $report";
+    $relex_failed++;
+}
+print scalar(@files) - $relex_failed, " of ", scalar(@files),
+    " files relexed the same after $edits edits each\n";
+
+# lex_files() against lexing the files in order, with each scanner.
+my $files_failed = 0;
+foreach my $fast (0, 1) {
+    local $ENV{COOL_LEXER} = $fast ? "fast" : "";
+    my ($in_order, $a) = driver("in-order", @files);
+    my ($at_once, $b) = driver("lex-files", @files);
+
+    die "$dir/driver in-order: exit status $a\n" if $a != 0;
+    die "$dir/driver lex-files: exit status $b\n" if $b != 0;
+    $files_failed++
+	unless same_lines(($fast ? "fast" : "flex") . ": tokens and tables",
+			  "in order", $in_order, "lex_files", $at_once);
+}
+print "lex_files() and lexing in order ", ($files_failed ? "differ" : "agree"),
+    " over ", scalar(@files), " files\n";
+exit($failed || $relex_failed || $files_failed ? 1 : 0);
@@ -0,0 +1,174 @@
+/*
+ * Binary image of a typed tree, which the parse cache keeps its entries
+ * in, so that a tree is loaded without parsing any text.
+ */
+
+#ifndef AST_IMAGE_H
+#define AST_IMAGE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+#include "compact-tree.h"
+
+/*
+ * The image is internal to the parser: the phases after it are course
+ * code that reads the text dump, so that is all the parser writes to
+ * them.  All words are 32 bits in host byte order:
+ *
+ *	magic, version, symbol count, text bytes, node words
+ *	per symbol: table, length, offset of its text
+ *	the text of all symbols, each ending in a NUL, padded to a word
+ *	the node records, in preorder
+ *
+ * Symbol 0 is NULL (an expression without a type); the others are
+ * numbered as in the compact_tree the image was written from, with
+ * table AST_SYM_ID, AST_SYM_INT or AST_SYM_STR.  A node record is
+ *
+ *	kind | words << 8	words: length of this record alone
+ *	line
+ *	size			length of the record and all its subtrees
+ *	type			expressions only, a symbol
+ *	fields
+ *
+ * where the fields are those of compact_tree::fields() other than the
+ * subtrees, in order: a symbol or the value of a Boolean.  A list has
+ * one field, its length.  The records of the subtrees and of the list
+ * elements follow, in order, so the first child of a record starts
+ * right after it and each next sibling size words further on.
+ *
+ * An ast_image maps an image (or reads it, from a pipe, or takes it
+ * from memory, where the token stream left it) and walks it in place;
+ * compact_tree::load() turns it back into a tree.
+ */
+#define AST_IMAGE_MAGIC		0x5441437fu	/* "\177CAT" */
+#define AST_IMAGE_VERSION	1u
+
+enum { AST_SYM_NONE, AST_SYM_ID, AST_SYM_INT, AST_SYM_STR };
+
+class ast_image {
+public:
+	typedef uint32_t node;		/* word offset of a record */
+
+	ast_image() : words(NULL), nwords(0), map_size(0), nsyms(0), nodes(0),
+		      text(NULL) { }
+	~ast_image() { close(); }
+
+	/* Map or read all of f, which must hold one image. */
+	bool open(FILE *f) {
+		close();
+		if (!map(f) && !read(f))
+			return false;
+		return check();
+	}
+
+	/* The n bytes at bytes, which must hold one image and outlive it;
+	   they are copied only if they are not aligned to a word. */
+	bool open(const char *bytes, size_t n) {
+		close();
+		if ((uintptr_t) bytes % sizeof(uint32_t) == 0)
+			words = (const uint32_t *) bytes;
+		else {
+			buf.resize(n / 4);
+			memcpy(buf.data(), bytes, buf.size() * 4);
+			words = buf.data();
+		}
+		nwords = n / 4;
+		return check();
+	}
+
+	void close() {
+		if (map_size != 0)
+			munmap((void *) words, map_size);
+		buf.clear();
+		words = NULL;
+		nwords = map_size = 0;
+	}
+
+	node root() const { return nodes; }
+
+	compact_tree::kind kind(node n) const {
+		return (compact_tree::kind) (words[n] & 0xff);
+	}
+	int line(node n) const { return words[n + 1]; }
+	uint32_t size(node n) const { return words[n + 2]; }
+	uint32_t type(node n) const { return words[n + 3]; }
+	uint32_t field(node n, int i) const {
+		return words[n + (compact_tree::is_expression(kind(n)) ? 4 : 3) + i];
+	}
+	uint32_t list_len(node n) const { return field(n, 0); }
+	node first_child(node n) const { return n + (words[n] >> 8); }
+	node next_sibling(node n) const { return n + size(n); }
+
+	size_t symbol_count() const { return nsyms; }
+	int symbol_table(uint32_t id) const { return words[5 + 3 * id]; }
+	size_t symbol_len(uint32_t id) const { return words[5 + 3 * id + 1]; }
+	const char *symbol_text(uint32_t id) const {
+		return text + words[5 + 3 * id + 2];
+	}
+
+private:
+	const uint32_t *words;
+	size_t nwords;
+	size_t map_size;		/* 0 when read into buf */
+	std::vector<uint32_t> buf;
+	uint32_t nsyms;
+	node nodes;
+	const char *text;
+
+	ast_image(const ast_image &);
+	ast_image &operator=(const ast_image &);
+
+	/* Whether words holds an image, and where its parts start. */
+	bool check() {
+		if (nwords < 5 || words[0] != AST_IMAGE_MAGIC ||
+		    words[1] != AST_IMAGE_VERSION) {
+			close();
+			return false;
+		}
+		nsyms = words[2];
+		size_t text_words = (words[3] + 3) / 4;
+		nodes = 5 + 3 * nsyms + text_words;
+		if (nodes + words[4] > nwords || words[4] == 0) {
+			close();
+			return false;
+		}
+		text = (const char *) (words + 5 + 3 * nsyms);
+		return true;
+	}
+
+	bool map(FILE *f) {
+		struct stat st;
+
+		if (fstat(fileno(f), &st) < 0 || !S_ISREG(st.st_mode) ||
+		    st.st_size == 0 || ftell(f) != 0)
+			return false;
+		void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+				  fileno(f), 0);
+		if (base == MAP_FAILED)
+			return false;
+		words = (const uint32_t *) base;
+		nwords = st.st_size / 4;
+		map_size = st.st_size;
+		return true;
+	}
+
+	bool read(FILE *f) {
+		size_t n;
+
+		buf.resize(1 << 14);
+		while ((n = fread(&buf[nwords], 4, buf.size() - nwords, f)) > 0) {
+			nwords += n;
+			if (nwords == buf.size())
+				buf.resize(2 * buf.size());
+		}
+		words = buf.data();
+		return nwords > 0;
+	}
+};
+
+#endif
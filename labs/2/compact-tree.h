@@ -0,0 +1,236 @@
+/*
+ * A compact form of the tree the parser builds, for phases that walk
+ * big programs.
+ */
+
+#ifndef COMPACT_TREE_H
+#define COMPACT_TREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "cool-tree.h"
+
+/*
+ * The nodes of a compact_tree live in one pool per constructor, each a
+ * struct of arrays: a column of lines, one column per field and, for
+ * expressions, a column of types.  A node is named by a 32 bit ref
+ * holding its constructor in the top bits and its row in its pool
+ * below; a field holds the ref of a subtree, the id of a Symbol in the
+ * tree's own symbol table, or the value of a Boolean.  A list is a row
+ * of the LIST pool giving a run of refs in items.  A binary operator
+ * thus takes four 32 bit words (line, two operands, type) where a
+ * tree_node takes a vtable pointer, a line and three pointers.
+ *
+ * build() copies a tree of cool-tree.h nodes into the pools, through
+ * compact(), which every constructor class has, and expand() builds
+ * such a tree back from them, as the parse cache does for a program it
+ * has an image of.  Phases written against cool-tree.h, like semant,
+ * only run over the tree expand() builds: their checks are virtual
+ * members of the cool-tree.h classes.  write() and load() go to and
+ * from the binary image of ast-image.h, and dump() writes the text of
+ * dump_with_types().  walk() visits every node, as tree_walk does for a
+ * tree of cool-tree.h nodes, so that tree-walk-bench.pl can time the
+ * two forms against each other.
+ *
+ * None of these recurse: each keeps a stack of its own, so that a deep
+ * nesting of expressions costs heap rather than C stack.
+ */
+class ast_image;
+
+class compact_tree {
+public:
+	typedef uint32_t ref;
+
+	enum kind {
+		KIND_PROGRAM, KIND_CLASS_, KIND_METHOD, KIND_ATTR, KIND_FORMAL,
+		KIND_BRANCH, KIND_ASSIGN, KIND_STATIC_DISPATCH, KIND_DISPATCH,
+		KIND_COND, KIND_LOOP, KIND_TYPCASE, KIND_BLOCK, KIND_LET,
+		KIND_PLUS, KIND_SUB, KIND_MUL, KIND_DIVIDE, KIND_NEG, KIND_LT,
+		KIND_EQ, KIND_LEQ, KIND_COMP, KIND_INT_CONST, KIND_BOOL_CONST,
+		KIND_STRING_CONST, KIND_NEW_, KIND_ISVOID, KIND_NO_EXPR,
+		KIND_OBJECT, KIND_LIST, KINDS
+	};
+
+	enum { KIND_BITS = 5, MAX_FIELDS = 4 };
+
+	static kind kind_of(ref r) { return (kind) (r >> (32 - KIND_BITS)); }
+	static uint32_t row_of(ref r) { return r & ((1u << (32 - KIND_BITS)) - 1); }
+	static bool is_expression(kind k) {
+		return k >= KIND_ASSIGN && k <= KIND_OBJECT;
+	}
+	/*
+	 * The fields of each constructor, in the order of its arguments:
+	 * 'e' a subtree, 'l' a list, 'b' a Boolean, and for a Symbol the
+	 * table it comes from, 'i' idtable, 'n' inttable or 's' stringtable.
+	 * A LIST row has two fields of its own, its first item and length.
+	 */
+	static const char *fields(kind k) {
+		static const char *const f[KINDS] = {
+			"l", "iils", "ilie", "iie", "ii", "iie",
+			"ie", "eiil", "eil", "eee", "ee", "el", "l", "iiee",
+			"ee", "ee", "ee", "ee", "e", "ee", "ee", "ee", "e",
+			"n", "b", "s", "i", "e", "", "i",
+			""
+		};
+		return f[k];
+	}
+	static bool is_subtree(char field) { return field == 'e' || field == 'l'; }
+	static int arity(kind k) { return k == KIND_LIST ? 2 : strlen(fields(k)); }
+
+	ref root;
+
+	compact_tree();
+
+	ref add(kind k, int line, uint32_t f0 = 0, uint32_t f1 = 0,
+		uint32_t f2 = 0, uint32_t f3 = 0);
+	ref add_list(const ref *elems, size_t n);
+
+	int line(ref r) const { return pools[kind_of(r)].line[row_of(r)]; }
+	uint32_t field(ref r, int i) const {
+		return pools[kind_of(r)].fields[i][row_of(r)];
+	}
+	size_t list_len(ref l) const { return field(l, 1); }
+	ref list_nth(ref l, size_t n) const { return items[field(l, 0) + n]; }
+
+	/* Symbol id 0 stands for NULL, as in an expression not yet typed. */
+	uint32_t symbol_id(Symbol sym);
+	Symbol symbol(uint32_t id) const { return symbols[id]; }
+	size_t symbol_count() const { return symbols.size(); }
+
+	Symbol type(ref r) const {
+		return symbols[pools[kind_of(r)].type[row_of(r)]];
+	}
+	void set_type(ref r, Symbol type) {
+		pools[kind_of(r)].type[row_of(r)] = symbol_id(type);
+	}
+
+	size_t node_count() const;
+	size_t bytes() const;		/* held by the pools and tables */
+
+	void build(Program program);
+	Program expand();
+
+	/* Give every class the name of file, as for an image loaded for
+	   another file with the same text. */
+	void set_file(Symbol file);
+
+	void write(std::ostream &out) const;
+	void load(const ast_image &image);
+	/* With whole false, only the classes, for a program of several
+	   trees, one per file. */
+	void dump(std::ostream &out, bool whole = true) const;
+	/* The number of nodes, lists not counted; sum is a checksum of
+	   their kinds, lines, fields and types. */
+	size_t walk(uint64_t &sum) const;
+
+	/*
+	 * The field for one argument of a constructor, for compact().  A
+	 * subtree is not compacted here but put on the stack of build(),
+	 * and its field filled in when build() gets to it; until then the
+	 * field of a node holds its place on that stack.
+	 */
+	uint32_t put(Symbol sym) { return symbol_id(sym); }
+	uint32_t put(Boolean b) { return b; }
+	template <class Node> uint32_t put(Node *node) {
+		pending.push_back(deferred(node, &compact_node<Node *>));
+		return pending.size();
+	}
+	template <class Elem> ref put(list_node<Elem> *list) {
+		ref l = add_list(NULL, list->len());
+		uint32_t n = 0;
+		for (int i = list->first(); list->more(i); i = list->next(i)) {
+			pending.push_back(deferred(list->nth(i), &compact_node<Elem>));
+			pending.back().owner = l;
+			pending.back().slot = n++;
+		}
+		return l;
+	}
+
+private:
+	struct pool {
+		std::vector<uint32_t> line;
+		std::vector<uint32_t> fields[MAX_FIELDS];
+		std::vector<uint32_t> type;
+	};
+
+	/* A subtree still to compact, and the field or item it goes in. */
+	struct deferred {
+		void *node;
+		ref (*compact)(void *node, compact_tree &t);
+		ref owner;
+		uint32_t slot;
+
+		deferred(void *node, ref (*compact)(void *, compact_tree &))
+			: node(node), compact(compact), owner(0), slot(0) { }
+	};
+
+	template <class Ptr> static ref compact_node(void *node, compact_tree &t) {
+		return static_cast<Ptr>(node)->compact(t);
+	}
+
+	pool pools[KINDS];
+	std::vector<ref> items;		/* elements of all lists */
+	std::vector<Symbol> symbols;
+	std::unordered_map<Symbol, uint32_t> ids;
+	std::vector<deferred> pending;	/* during build() */
+
+	bool next_child(ref r, uint32_t &i, ref &child) const;
+	void set_child(ref r, uint32_t i, ref child);
+	void write_record(ref r, std::vector<uint32_t> &out,
+			  std::vector<uint32_t> &tables) const;
+	ref load_record(const ast_image &image, uint32_t node,
+			const std::vector<uint32_t> &ids);
+	tree_node *expand_node(ref r, std::vector<tree_node *> &values);
+};
+
+/*
+ * A walk over a tree of cool-tree.h nodes, taking the steps build()
+ * takes without compacting anything: the walk() member of each
+ * constructor class, defined from the same field lists as compact(),
+ * hands its fields to add() and put(), and subtrees wait on a stack of
+ * the walk's own.  nodes and sum come out as from compact_tree::walk()
+ * but for the fields that are Symbols.
+ */
+class tree_walk {
+public:
+	size_t nodes;
+	uint64_t sum;
+
+	tree_walk() : nodes(0), sum(0) { }
+
+	void run(Program program);
+
+	uint32_t add(compact_tree::kind k, int line, uint32_t f0 = 0,
+		     uint32_t f1 = 0, uint32_t f2 = 0, uint32_t f3 = 0) {
+		nodes++;
+		sum += k + line + f0 + f1 + f2 + f3;
+		return 0;
+	}
+	uint32_t put(Symbol sym) { return (uint32_t) (uintptr_t) sym; }
+	uint32_t put(Boolean b) { return b; }
+	template <class Node> uint32_t put(Node *node) {
+		pending.push_back(step(node, &walk_node<Node *>));
+		return 0;
+	}
+	template <class Elem> uint32_t put(list_node<Elem> *list) {
+		for (int i = list->first(); list->more(i); i = list->next(i))
+			pending.push_back(step(list->nth(i), &walk_node<Elem>));
+		return list->len();
+	}
+
+private:
+	typedef std::pair<void *, uint32_t (*)(void *, tree_walk &)> step;
+
+	template <class Ptr> static uint32_t walk_node(void *node, tree_walk &t) {
+		return static_cast<Ptr>(node)->walk(t);
+	}
+
+	std::vector<step> pending;
+};
+
+#endif
@@ -1,23 +1,22 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* A Bison parser, made by GNU Bison 2.4.1.  */
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
-   
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -28,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -42,44 +45,61 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.4.1"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
-#define YYPUSH 0
+#define YYPUSH 1
 
 /* Pull parsers.  */
 #define YYPULL 1
 
-/* Using locations.  */
-#define YYLSP_NEEDED 1
 
 /* Substitute the variable and function names.  */
 #define yyparse         cool_yyparse
+#define yypush_parse    cool_yypush_parse
+#define yypull_parse    cool_yypull_parse
+#define yypstate_new    cool_yypstate_new
+#define yypstate_clear  cool_yypstate_clear
+#define yypstate_delete cool_yypstate_delete
+#define yypstate        cool_yypstate
 #define yylex           cool_yylex
 #define yyerror         cool_yyerror
-#define yylval          cool_yylval
-#define yychar          cool_yychar
 #define yydebug         cool_yydebug
 #define yynerrs         cool_yynerrs
-#define yylloc          cool_yylloc
-
-/* Copy the first part of user declarations.  */
 
-/* Line 189 of yacc.c  */
+/* First part of user prologue.  */
 #line 6 "cool.y"
 
+  #include <spawn.h>
+  #include <sys/stat.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+  #include <algorithm>
   #include <iostream>
+  #include <atomic>
+  #include <condition_variable>
+  #include <memory>
+  #include <mutex>
+  #include <sstream>
+  #include <string>
+  #include <thread>
+  #include <vector>
   #include "cool-tree.h"
+  #include "compact-tree.h"
+  #include "ast-image.h"
+  #include "parse-cache.h"
+  #include "lazy-body.h"
+  #include "diagnostics.h"
   #include "stringtab.h"
   #include "utilities.h"
   
@@ -87,22 +107,26 @@
   
   
   /* Locations */
-  #define YYLTYPE int              /* the type of locations */
-  #define cool_yylloc curr_lineno  /* use the curr_lineno from the lexer
-  for the location of tokens */
+  #define YYLTYPE int              /* the type of locations; a token's is
+  the line token_stream_lex() read for it */
     
-    extern int node_lineno;          /* set before constructing a tree node
-    to whatever you want the line number
-    for the tree node to be */
+    /* The parser is pure: everything a parse keeps lives in the
+       parse_context passed to cool_yyparse() as ctx.  Nodes take their
+       line from the global node_lineno when they are built, which
+       parses running at the same time cannot share, so the line for the
+       nodes of a rule is kept in ctx->node_lineno and NODE() stamps it on
+       each node as it is built. */
       
       
       #define YYLLOC_DEFAULT(Current, Rhs, N)         \
       Current = Rhs[1];                             \
-      node_lineno = Current;
+      ctx->node_lineno = Current;
     
     
     #define SET_NODELOC(Current)  \
-    node_lineno = Current;
+    ctx->node_lineno = Current;
+    
+    #define NODE(node) node_at(ctx, node)
     
     /* IMPORTANT NOTE ON LINE NUMBERS
     *********************************
@@ -135,21 +159,36 @@
       @$ = @3;
       
       
-      // Observe that we call SET_NODELOC(@3); this will set the global variable
-      // node_lineno to @3. Since the constructor call "plus" uses the value of 
-      // this global, the plus node will now have the correct line number.
+      // Observe that we call SET_NODELOC(@3); this will set the line of
+      // this parse, ctx->node_lineno, to @3. Since NODE() stamps that line
+      // on the nodes it wraps, the plus node will now have the correct
+      // line number.
       SET_NODELOC(@3);
       
       // construct the result node:
-      $$ = plus(int_const($1), int_const($3));
+      $$ = NODE(plus(NODE(int_const($1)), NODE(int_const($3))));
     }
     
     */
     
     
     
-    void yyerror(char *s);        /*  defined below; called for each parse error */
-    extern int yylex();           /*  the entry point to the lexer  */
+    /* The parser's stacks start at YYINITDEPTH entries.  Compiled as C++,
+       Bison will not move them, so it stops at that depth unless given a
+       yyoverflow; grow_stacks() (below) doubles them in the context of
+       the parse as the nesting of the program needs, up to memory. */
+    #define yyoverflow(message, ss, ss_bytes, vs, vs_bytes, ls, ls_bytes, size) \
+    grow_stacks(ctx, ss, ss_bytes, vs, vs_bytes, ls, ls_bytes, size)
+    
+    /* Bison only defines these for its own stack growing, but the state
+       of a push parse (see push_parser) is allocated with them too. */
+    #define YYMALLOC malloc
+    #define YYFREE free
+    
+    /* Tokens are read by token_stream_lex() below, which understands the
+       binary token stream and hands text streams to cool_yylex(). */
+    #undef yylex
+    #define yylex token_stream_lex
     
     /************************************************************************/
     /*                DONT CHANGE ANYTHING IN THIS SECTION                  */
@@ -159,174 +198,232 @@
     int omerrs = 0;               /* number of errors in lexing and parsing */
     
 
-/* Line 189 of yacc.c  */
-#line 164 "cool.tab.c"
-
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 1
-#endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
-#endif
+#line 202 "cool.tab.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     CLASS = 258,
-     ELSE = 259,
-     FI = 260,
-     IF = 261,
-     IN = 262,
-     INHERITS = 263,
-     LET = 264,
-     LOOP = 265,
-     POOL = 266,
-     THEN = 267,
-     WHILE = 268,
-     CASE = 269,
-     ESAC = 270,
-     OF = 271,
-     DARROW = 272,
-     NEW = 273,
-     ISVOID = 274,
-     STR_CONST = 275,
-     INT_CONST = 276,
-     BOOL_CONST = 277,
-     TYPEID = 278,
-     OBJECTID = 279,
-     ASSIGN = 280,
-     NOT = 281,
-     LE = 282,
-     ERROR = 283
-   };
-#endif
-/* Tokens.  */
-#define CLASS 258
-#define ELSE 259
-#define FI 260
-#define IF 261
-#define IN 262
-#define INHERITS 263
-#define LET 264
-#define LOOP 265
-#define POOL 266
-#define THEN 267
-#define WHILE 268
-#define CASE 269
-#define ESAC 270
-#define OF 271
-#define DARROW 272
-#define NEW 273
-#define ISVOID 274
-#define STR_CONST 275
-#define INT_CONST 276
-#define BOOL_CONST 277
-#define TYPEID 278
-#define OBJECTID 279
-#define ASSIGN 280
-#define NOT 281
-#define LE 282
-#define ERROR 283
-
-
-
-
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+#include "cool.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_CLASS = 3,                      /* CLASS  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_FI = 5,                         /* FI  */
+  YYSYMBOL_IF = 6,                         /* IF  */
+  YYSYMBOL_IN = 7,                         /* IN  */
+  YYSYMBOL_INHERITS = 8,                   /* INHERITS  */
+  YYSYMBOL_LET = 9,                        /* LET  */
+  YYSYMBOL_LOOP = 10,                      /* LOOP  */
+  YYSYMBOL_POOL = 11,                      /* POOL  */
+  YYSYMBOL_THEN = 12,                      /* THEN  */
+  YYSYMBOL_WHILE = 13,                     /* WHILE  */
+  YYSYMBOL_CASE = 14,                      /* CASE  */
+  YYSYMBOL_ESAC = 15,                      /* ESAC  */
+  YYSYMBOL_OF = 16,                        /* OF  */
+  YYSYMBOL_DARROW = 17,                    /* DARROW  */
+  YYSYMBOL_NEW = 18,                       /* NEW  */
+  YYSYMBOL_ISVOID = 19,                    /* ISVOID  */
+  YYSYMBOL_STR_CONST = 20,                 /* STR_CONST  */
+  YYSYMBOL_INT_CONST = 21,                 /* INT_CONST  */
+  YYSYMBOL_BOOL_CONST = 22,                /* BOOL_CONST  */
+  YYSYMBOL_TYPEID = 23,                    /* TYPEID  */
+  YYSYMBOL_OBJECTID = 24,                  /* OBJECTID  */
+  YYSYMBOL_ASSIGN = 25,                    /* ASSIGN  */
+  YYSYMBOL_NOT = 26,                       /* NOT  */
+  YYSYMBOL_LE = 27,                        /* LE  */
+  YYSYMBOL_ERROR = 28,                     /* ERROR  */
+  YYSYMBOL_29_ = 29,                       /* '='  */
+  YYSYMBOL_30_ = 30,                       /* '+'  */
+  YYSYMBOL_31_ = 31,                       /* '-'  */
+  YYSYMBOL_32_ = 32,                       /* '*'  */
+  YYSYMBOL_33_ = 33,                       /* '/'  */
+  YYSYMBOL_34_ = 34,                       /* '.'  */
+  YYSYMBOL_35_ = 35,                       /* '@'  */
+  YYSYMBOL_36_ = 36,                       /* '~'  */
+  YYSYMBOL_37_ = 37,                       /* '<'  */
+  YYSYMBOL_38_ = 38,                       /* '{'  */
+  YYSYMBOL_39_ = 39,                       /* '}'  */
+  YYSYMBOL_40_ = 40,                       /* ';'  */
+  YYSYMBOL_41_ = 41,                       /* '('  */
+  YYSYMBOL_42_ = 42,                       /* ')'  */
+  YYSYMBOL_43_ = 43,                       /* ':'  */
+  YYSYMBOL_44_ = 44,                       /* ','  */
+  YYSYMBOL_YYACCEPT = 45,                  /* $accept  */
+  YYSYMBOL_program = 46,                   /* program  */
+  YYSYMBOL_class_list = 47,                /* class_list  */
+  YYSYMBOL_class = 48,                     /* class  */
+  YYSYMBOL_feature_list = 49,              /* feature_list  */
+  YYSYMBOL_feature = 50,                   /* feature  */
+  YYSYMBOL_formal_list = 51,               /* formal_list  */
+  YYSYMBOL_formal = 52,                    /* formal  */
+  YYSYMBOL_branch_list = 53,               /* branch_list  */
+  YYSYMBOL_branch = 54,                    /* branch  */
+  YYSYMBOL_comma_expr_list = 55,           /* comma_expr_list  */
+  YYSYMBOL_smcl_expr_list = 56,            /* smcl_expr_list  */
+  YYSYMBOL_expr = 57,                      /* expr  */
+  YYSYMBOL_let_body = 58                   /* let_body  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Line 214 of yacc.c  */
-#line 89 "cool.y"
-
-      Boolean boolean;
-      Symbol symbol;
-      Program program;
-      Class_ class_;
-      Classes classes;
-      Feature feature;
-      Features features;
-      Formal formal;
-      Formals formals;
-      Case case_;
-      Cases cases;
-      Expression expression;
-      Expressions expressions;
-      char *error_msg;
-    
-
-
-/* Line 214 of yacc.c  */
-#line 275 "cool.tab.c"
-} YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-#endif
-
-#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE
-{
-  int first_line;
-  int first_column;
-  int last_line;
-  int last_column;
-} YYLTYPE;
-# define yyltype YYLTYPE /* obsolescent; will be withdrawn */
-# define YYLTYPE_IS_DECLARED 1
-# define YYLTYPE_IS_TRIVIAL 1
-#endif
 
 
-/* Copy the second part of user declarations.  */
+/* Unqualified %code blocks.  */
+#line 251 "cool.y"
 
+      void yyerror(YYLTYPE *loc, parse_context *ctx, const char *s);
+      static int token_stream_lex(YYSTYPE *lval, YYLTYPE *lloc, parse_context *ctx);
+      
+      /* Symbols the actions need for every class or dispatch; defined below. */
+      static Symbol object_symbol();
+      static Symbol self_symbol();
+      static Symbol filename_symbol(parse_context *ctx);
+      static void class_done(parse_context *ctx, Class_ c);
+      static bool stop_parse(parse_context *ctx);
+      static parse_cache *shared_cache();
+      
+      template <class T> static T node_at(parse_context *ctx, T node);
+      
+      /* Move one of the parser's stacks, holding used bytes, into space,
+         grown to bytes. */
+      static void grow_stack(std::vector<char> &space, void *stack,
+                             size_t used, size_t bytes)
+      {
+        if (stack == space.data() && !space.empty()) {
+          space.resize(bytes);
+          return;
+        }
+        std::vector<char> grown(bytes);
+        memcpy(grown.data(), stack, used);
+        space.swap(grown);
+      }
+      
+      template <class State, class Size>
+      static void grow_stacks(parse_context *ctx, State **ss, size_t ss_bytes,
+                              YYSTYPE **vs, size_t vs_bytes,
+                              YYLTYPE **ls, size_t ls_bytes, Size *size)
+      {
+        size_t depth = 2 * *size;
+        
+        grow_stack(ctx->stacks[0], *ss, ss_bytes, depth * sizeof(State));
+        grow_stack(ctx->stacks[1], *vs, vs_bytes, depth * sizeof(YYSTYPE));
+        grow_stack(ctx->stacks[2], *ls, ls_bytes, depth * sizeof(YYLTYPE));
+        *ss = (State *) ctx->stacks[0].data();
+        *vs = (YYSTYPE *) ctx->stacks[1].data();
+        *ls = (YYLTYPE *) ctx->stacks[2].data();
+        *size = depth;
+      }
+    
 
-/* Line 264 of yacc.c  */
-#line 300 "cool.tab.c"
+#line 341 "cool.tab.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -334,85 +431,112 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
-# if YYENABLE_NLS
+# if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
 
-/* The parser invokes alloca or malloc; define the necessary symbols.  */
 
-# ifdef YYSTACK_USE_ALLOCA
-#  if YYSTACK_USE_ALLOCA
-#   ifdef __GNUC__
-#    define YYSTACK_ALLOC __builtin_alloca
-#   elif defined __BUILTIN_VA_ARG_INCR
-#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
-#   elif defined _AIX
-#    define YYSTACK_ALLOC __alloca
-#   elif defined _MSC_VER
-#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
-#    define alloca _alloca
-#   else
-#    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
-#     endif
-#    endif
-#   endif
-#  endif
-# endif
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -426,127 +550,134 @@ YYID (yyi)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
-	     && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
   YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE) + sizeof (YYLTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  7
+#define YYFINAL  8
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   275
+#define YYLAST   327
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  45
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  13
+#define YYNNTS  14
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  49
-/* YYNRULES -- Number of states.  */
-#define YYNSTATES  128
+#define YYNRULES  57
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  145
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   284
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      41,    42,    31,    29,    44,    30,    33,    32,     2,     2,
+      41,    42,    32,    30,    44,    31,    34,    33,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,    43,    40,
-      36,    37,     2,     2,    34,     2,     2,     2,     2,     2,
+      37,    29,     2,     2,    35,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,    38,     2,    39,    35,     2,     2,     2,
+       2,     2,     2,    38,     2,    39,    36,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -566,333 +697,296 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     5,     7,    10,    17,    26,    30,    31,
-      33,    36,    47,    54,    59,    60,    62,    66,    70,    72,
-      75,    82,    83,    85,    89,    92,    96,   100,   109,   116,
-     124,   130,   136,   140,   147,   151,   155,   159,   163,   166,
-     170,   174,   178,   181,   185,   187,   189,   191,   194,   197
+       0,   365,   365,   369,   372,   378,   381,   384,   391,   392,
+     394,   400,   402,   404,   406,   412,   413,   415,   420,   426,
+     428,   433,   440,   441,   443,   449,   451,   453,   458,   460,
+     462,   464,   466,   468,   470,   472,   474,   476,   478,   480,
+     482,   484,   486,   488,   490,   492,   494,   496,   498,   500,
+     502,   504,   506,   512,   514,   516,   518,   520
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      46,     0,    -1,    47,    -1,    48,    -1,    47,    48,    -1,
-       3,    23,    38,    49,    39,    40,    -1,     3,    23,     8,
-      23,    38,    49,    39,    40,    -1,     3,     1,    40,    -1,
-      -1,    50,    -1,    49,    50,    -1,    24,    41,    51,    42,
-      43,    23,    38,    57,    39,    40,    -1,    24,    43,    23,
-      25,    57,    40,    -1,    24,    43,    23,    40,    -1,    -1,
-      52,    -1,    51,    44,    52,    -1,    24,    43,    23,    -1,
-      54,    -1,    53,    54,    -1,    24,    43,    23,    17,    57,
-      40,    -1,    -1,    57,    -1,    55,    44,    57,    -1,    57,
-      40,    -1,    56,    57,    40,    -1,    24,    25,    57,    -1,
-      57,    34,    23,    33,    24,    41,    55,    42,    -1,    57,
-      33,    24,    41,    55,    42,    -1,     6,    57,    12,    57,
-       4,    57,     5,    -1,    13,    57,    10,    57,    11,    -1,
-      14,    57,    16,    53,    15,    -1,    38,    56,    39,    -1,
-       9,    24,    43,    23,     7,    57,    -1,    57,    29,    57,
-      -1,    57,    30,    57,    -1,    57,    31,    57,    -1,    57,
-      32,    57,    -1,    35,    57,    -1,    57,    36,    57,    -1,
-      57,    37,    57,    -1,    57,    27,    57,    -1,    26,    57,
-      -1,    41,    57,    42,    -1,    21,    -1,    22,    -1,    20,
-      -1,    18,    23,    -1,    19,    57,    -1,    24,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,   173,   173,   177,   180,   186,   189,   191,   198,   199,
-     201,   207,   209,   211,   217,   218,   220,   225,   231,   233,
-     238,   245,   246,   248,   254,   256,   261,   263,   265,   267,
-     269,   271,   273,   275,   277,   279,   281,   283,   285,   287,
-     289,   291,   293,   295,   297,   299,   301,   303,   305,   307
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "CLASS", "ELSE", "FI", "IF", "IN",
-  "INHERITS", "LET", "LOOP", "POOL", "THEN", "WHILE", "CASE", "ESAC", "OF",
-  "DARROW", "NEW", "ISVOID", "STR_CONST", "INT_CONST", "BOOL_CONST",
-  "TYPEID", "OBJECTID", "ASSIGN", "NOT", "LE", "ERROR", "'+'", "'-'",
-  "'*'", "'/'", "'.'", "'@'", "'~'", "'<'", "'='", "'{'", "'}'", "';'",
-  "'('", "')'", "':'", "','", "$accept", "program", "class_list", "class",
-  "feature_list", "feature", "formal_list", "formal", "branch_list",
-  "branch", "comma_expr_list", "smcl_expr_list", "expr", 0
+  "\"end of file\"", "error", "\"invalid token\"", "CLASS", "ELSE", "FI",
+  "IF", "IN", "INHERITS", "LET", "LOOP", "POOL", "THEN", "WHILE", "CASE",
+  "ESAC", "OF", "DARROW", "NEW", "ISVOID", "STR_CONST", "INT_CONST",
+  "BOOL_CONST", "TYPEID", "OBJECTID", "ASSIGN", "NOT", "LE", "ERROR",
+  "'='", "'+'", "'-'", "'*'", "'/'", "'.'", "'@'", "'~'", "'<'", "'{'",
+  "'}'", "';'", "'('", "')'", "':'", "','", "$accept", "program",
+  "class_list", "class", "feature_list", "feature", "formal_list",
+  "formal", "branch_list", "branch", "comma_expr_list", "smcl_expr_list",
+  "expr", "let_body", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   284,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,    43,
-      45,    42,    47,    46,    64,   126,    60,    61,   123,   125,
-      59,    40,    41,    58,    44
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+#define YYPACT_NINF (-112)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-9)
+
+#define yytable_value_is_error(Yyn) \
+  ((Yyn) == YYTABLE_NINF)
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
 {
-       0,    45,    46,    47,    47,    48,    48,    48,    49,    49,
-      49,    50,    50,    50,    51,    51,    51,    52,    53,    53,
-      54,    55,    55,    55,    56,    56,    57,    57,    57,    57,
-      57,    57,    57,    57,    57,    57,    57,    57,    57,    57,
-      57,    57,    57,    57,    57,    57,    57,    57,    57,    57
+      52,   -12,    25,    67,    32,  -112,  -112,    -7,  -112,  -112,
+      43,    19,    44,  -112,    38,    51,    40,    19,    70,    83,
+      71,    75,  -112,    53,    79,    18,  -112,   101,  -112,  -112,
+      84,   104,    85,    70,   130,  -112,  -112,   106,  -112,   130,
+       1,   130,   130,   107,   130,  -112,  -112,  -112,   -14,   130,
+     130,    50,   130,   202,    93,   191,    89,    91,  -112,   157,
+     211,  -112,   -18,   130,   130,   -18,   -18,   102,    99,   234,
+     220,   130,   130,   130,   130,   130,   130,   117,   122,   130,
+     130,   130,     1,   123,   130,   140,   290,    45,   202,  -112,
+    -112,   246,  -112,  -112,    -1,   281,   173,   173,   -13,   -13,
+     129,   113,    -1,   270,   128,  -112,     5,   182,   126,   -11,
+    -112,  -112,   130,  -112,   130,   149,  -112,   130,   130,   130,
+       1,  -112,   151,  -112,  -112,   202,    65,   131,   148,   202,
+      66,  -112,   159,  -112,   130,  -112,   130,     1,   130,    72,
+     202,  -112,   258,  -112,  -112
 };
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       0,     2,     1,     1,     2,     6,     8,     3,     0,     1,
-       2,    10,     6,     4,     0,     1,     3,     3,     1,     2,
-       6,     0,     1,     3,     2,     3,     3,     8,     6,     7,
-       5,     5,     3,     6,     3,     3,     3,     3,     2,     3,
-       3,     3,     2,     3,     1,     1,     1,     2,     2,     1
+       0,     0,     0,     0,     0,     3,     7,     0,     1,     4,
+       0,     0,     0,    14,     0,     0,     0,     0,    15,     0,
+       0,     0,     9,     0,     0,     0,    16,    13,     5,    10,
+       0,     0,     0,     0,     0,     6,    18,     0,    17,     0,
+       0,     0,     0,     0,     0,    49,    47,    48,    52,     0,
+       0,     0,     0,    12,     0,     0,     0,     0,    36,     0,
+       0,    50,    51,     0,    22,    45,    41,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,    28,     0,    23,    27,
+      34,     0,    25,    46,    44,    43,    37,    38,    39,    40,
+       0,     0,    42,     0,     0,    57,     0,     0,     0,     0,
+      19,    31,     0,    26,    22,     0,    11,     0,     0,     0,
+       0,    33,     0,    35,    20,    24,     0,     0,     0,    54,
+       0,    56,     0,    30,    22,    32,     0,     0,     0,     0,
+      53,    55,     0,    29,    21
 };
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
 {
-       0,     0,     0,     2,     3,     0,     0,     1,     4,     7,
-       0,     8,     0,     0,     0,     9,     8,    14,     0,     0,
-      10,     0,     0,     0,    15,     0,     5,     0,     0,     0,
-       0,     0,    13,     6,    17,     0,    16,     0,     0,     0,
-       0,     0,     0,    46,    44,    45,    49,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,    47,    48,     0,
-      42,    38,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,    12,     0,     0,     0,     0,     0,
-      26,    32,     0,    24,    43,    41,    34,    35,    36,    37,
-       0,     0,    39,    40,     0,     0,     0,     0,     0,     0,
-      18,    25,    21,     0,     0,     0,     0,    30,     0,    31,
-      19,     0,    22,     0,    11,     0,    33,     0,    28,     0,
-      21,    29,     0,    23,     0,     0,    27,    20
+    -112,  -112,  -112,   192,   178,    42,  -112,   164,  -112,    90,
+    -111,  -112,   -34,   -76
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     2,     3,     4,    14,    15,    23,    24,    99,   100,
-     111,    62,   112
+       0,     3,     4,     5,    15,    16,    25,    26,   109,   110,
+      87,    68,    88,    58
 };
 
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -32
-static const yytype_int16 yypact[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
 {
-       4,    20,    33,     4,   -32,   -25,    -6,   -32,   -32,   -32,
-      17,    29,     8,    28,    15,   -32,    29,    46,    49,    39,
-     -32,    26,    14,    34,   -32,    27,   -32,    44,    50,    43,
-      46,    76,   -32,   -32,   -32,    64,   -32,    76,    68,    76,
-      76,    80,    76,   -32,   -32,   -32,    82,    76,    76,    76,
-      76,   163,    70,   126,    66,    -7,   138,   -32,   -23,    76,
-     -23,   -23,    42,   175,   149,    76,    76,    76,    76,    76,
-      86,    90,    76,    76,   -32,    76,    76,    92,    76,    88,
-     -23,   -32,   187,   -32,   -32,    22,   230,   230,   238,   238,
-      87,   102,    22,    22,   211,    89,   132,   113,    98,   -14,
-     -32,   -32,    76,   124,   111,    76,    76,   -32,   129,   -32,
-     -32,    57,   222,   120,   -32,   100,   -23,   147,   -32,    76,
-      76,   -32,    76,   222,    62,   199,   -32,   -32
+      53,    10,    56,   126,   123,    55,   105,    59,    60,    71,
+      62,    63,   118,   108,    71,    65,    66,    69,    70,    79,
+      13,    77,    78,   139,    79,    57,    -9,    64,     6,    86,
+     119,    11,    -2,     1,    91,     2,    -9,    94,    95,    96,
+      97,    98,    99,    14,   131,   102,   103,   104,     7,   120,
+     107,    67,    13,     1,    13,     2,    39,    21,    -8,    40,
+      32,   141,    33,    41,    42,    21,    12,     8,    43,    44,
+      45,    46,    47,   136,    48,    14,    49,    14,   125,    18,
+      22,    19,    17,   128,   129,   130,    50,   111,    51,   112,
+      20,    52,    30,    71,    24,    72,    73,    74,    75,    76,
+      77,    78,   140,    79,   142,    39,    27,   133,    40,   112,
+     137,    28,    41,    42,   143,    29,   112,    43,    44,    45,
+      46,    47,    31,    48,    35,    49,    34,    36,    37,    54,
+      61,    80,   117,    82,    83,    50,    39,    51,    90,    40,
+      52,   100,    89,    41,    42,   101,   106,   115,    43,    44,
+      45,    46,    47,   135,    48,    71,    49,    72,    73,    74,
+      75,    76,    77,    78,   108,    79,    50,    84,    51,   122,
+     114,    52,   134,   127,   132,    71,   138,    72,    73,    74,
+      75,    76,    77,    78,    71,    79,    72,    73,    74,    75,
+      76,    77,    78,   121,    79,    23,     9,    38,     0,   124,
+      71,     0,     0,    81,     0,    75,    76,    77,    78,    71,
+      79,    72,    73,    74,    75,    76,    77,    78,    71,    79,
+      72,    73,    74,    75,    76,    77,    78,    85,    79,    71,
+       0,    72,    73,    74,    75,    76,    77,    78,    71,    79,
+      72,    73,    74,    75,    76,    77,    78,    71,    79,    72,
+      73,    74,    75,    76,    77,    78,     0,    79,     0,     0,
+       0,    71,    93,    72,    73,    74,    75,    76,    77,    78,
+       0,    79,     0,    71,    92,    72,    73,    74,    75,    76,
+      77,    78,     0,    79,     0,    71,   113,    72,    73,    74,
+      75,    76,    77,    78,     0,    79,     0,    71,   144,    72,
+      73,    74,    75,    76,    77,    78,     0,    79,    71,   116,
+      -9,    73,    74,    75,    76,    77,    78,    71,    79,     0,
+      73,    74,    75,    76,    77,    78,     0,    79
 };
 
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int16 yypgoto[] =
+static const yytype_int16 yycheck[] =
 {
-     -32,   -32,   -32,   170,   150,    -9,   -32,   154,   -32,    78,
-      67,   -32,   -31
+      34,     8,     1,   114,    15,    39,    82,    41,    42,    27,
+      44,    25,     7,    24,    27,    49,    50,    51,    52,    37,
+       1,    34,    35,   134,    37,    24,    27,    41,    40,    63,
+      25,    38,     0,     1,    68,     3,    37,    71,    72,    73,
+      74,    75,    76,    24,   120,    79,    80,    81,    23,    44,
+      84,     1,     1,     1,     1,     3,     6,    15,    39,     9,
+      42,   137,    44,    13,    14,    23,    23,     0,    18,    19,
+      20,    21,    22,     7,    24,    24,    26,    24,   112,    41,
+      40,    43,    38,   117,   118,   119,    36,    42,    38,    44,
+      39,    41,    39,    27,    24,    29,    30,    31,    32,    33,
+      34,    35,   136,    37,   138,     6,    23,    42,     9,    44,
+      44,    40,    13,    14,    42,    40,    44,    18,    19,    20,
+      21,    22,    43,    24,    40,    26,    25,    23,    43,    23,
+      23,    38,     4,    44,    43,    36,     6,    38,    39,     9,
+      41,    24,    40,    13,    14,    23,    23,    34,    18,    19,
+      20,    21,    22,     5,    24,    27,    26,    29,    30,    31,
+      32,    33,    34,    35,    24,    37,    36,    10,    38,    43,
+      41,    41,    41,    24,    23,    27,    17,    29,    30,    31,
+      32,    33,    34,    35,    27,    37,    29,    30,    31,    32,
+      33,    34,    35,    11,    37,    17,     4,    33,    -1,   109,
+      27,    -1,    -1,    12,    -1,    32,    33,    34,    35,    27,
+      37,    29,    30,    31,    32,    33,    34,    35,    27,    37,
+      29,    30,    31,    32,    33,    34,    35,    16,    37,    27,
+      -1,    29,    30,    31,    32,    33,    34,    35,    27,    37,
+      29,    30,    31,    32,    33,    34,    35,    27,    37,    29,
+      30,    31,    32,    33,    34,    35,    -1,    37,    -1,    -1,
+      -1,    27,    42,    29,    30,    31,    32,    33,    34,    35,
+      -1,    37,    -1,    27,    40,    29,    30,    31,    32,    33,
+      34,    35,    -1,    37,    -1,    27,    40,    29,    30,    31,
+      32,    33,    34,    35,    -1,    37,    -1,    27,    40,    29,
+      30,    31,    32,    33,    34,    35,    -1,    37,    27,    39,
+      29,    30,    31,    32,    33,    34,    35,    27,    37,    -1,
+      30,    31,    32,    33,    34,    35,    -1,    37
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
-static const yytype_int8 yytable[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-      51,   109,    10,    78,    65,    20,    53,     1,    55,    56,
-      98,    58,    20,    72,    73,     9,    60,    61,    63,    64,
-      65,     5,    66,    67,    68,    69,    70,    71,    80,    72,
-      73,    82,    11,     7,    85,    86,    87,    88,    89,    13,
-      12,    92,    93,     6,    94,    95,    16,    97,    37,    -1,
-      13,    38,    31,    13,    19,    39,    40,    28,    -1,    -1,
-      41,    42,    43,    44,    45,    27,    46,    32,    47,    17,
-      22,    18,    25,    34,   115,   116,    29,    48,    30,    26,
-      49,    81,    37,    50,    33,    38,    35,    52,   123,    39,
-      40,   125,    54,   105,    41,    42,    43,    44,    45,   118,
-      46,   119,    47,    57,   126,   121,   119,    59,    75,    77,
-      90,    48,    98,    91,    49,    96,    65,    50,    66,    67,
-      68,    69,    70,    71,   107,    72,    73,    65,   102,    66,
-      67,    68,    69,    70,    71,   103,    72,    73,    76,   106,
-      65,   108,    66,    67,    68,    69,    70,    71,   113,    72,
-      73,   114,   117,    65,    79,    66,    67,    68,    69,    70,
-      71,   120,    72,    73,   122,    65,    21,    66,    67,    68,
-      69,    70,    71,     8,    72,    73,    65,   110,    66,    67,
-      68,    69,    70,    71,    36,    72,    73,   124,     0,     0,
-      65,    84,    66,    67,    68,    69,    70,    71,     0,    72,
-      73,     0,    65,    74,    66,    67,    68,    69,    70,    71,
-       0,    72,    73,     0,    65,    83,    66,    67,    68,    69,
-      70,    71,     0,    72,    73,     0,    65,   101,    66,    67,
-      68,    69,    70,    71,     0,    72,    73,     0,    65,   127,
-      66,    67,    68,    69,    70,    71,     0,    72,    73,    65,
-     104,    66,    67,    68,    69,    70,    71,    65,    72,    73,
-       0,    68,    69,    70,    71,    65,    72,    73,     0,     0,
-       0,    70,    71,     0,    72,    73
+       0,     1,     3,    46,    47,    48,    40,    23,     0,    48,
+       8,    38,    23,     1,    24,    49,    50,    38,    41,    43,
+      39,    50,    40,    49,    24,    51,    52,    23,    40,    40,
+      39,    43,    42,    44,    25,    40,    23,    43,    52,     6,
+       9,    13,    14,    18,    19,    20,    21,    22,    24,    26,
+      36,    38,    41,    57,    23,    57,     1,    24,    58,    57,
+      57,    23,    57,    25,    41,    57,    57,     1,    56,    57,
+      57,    27,    29,    30,    31,    32,    33,    34,    35,    37,
+      38,    12,    44,    43,    10,    16,    57,    55,    57,    40,
+      39,    57,    40,    42,    57,    57,    57,    57,    57,    57,
+      24,    23,    57,    57,    57,    58,    23,    57,    24,    53,
+      54,    42,    44,    40,    41,    34,    39,     4,     7,    25,
+      44,    11,    43,    15,    54,    57,    55,    24,    57,    57,
+      57,    58,    23,    42,    41,     5,     7,    44,    17,    55,
+      57,    58,    57,    42,    40
 };
 
-static const yytype_int8 yycheck[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-      31,    15,     8,    10,    27,    14,    37,     3,    39,    40,
-      24,    42,    21,    36,    37,    40,    47,    48,    49,    50,
-      27,     1,    29,    30,    31,    32,    33,    34,    59,    36,
-      37,    62,    38,     0,    65,    66,    67,    68,    69,    24,
-      23,    72,    73,    23,    75,    76,    38,    78,     6,    27,
-      24,     9,    25,    24,    39,    13,    14,    43,    36,    37,
-      18,    19,    20,    21,    22,    39,    24,    40,    26,    41,
-      24,    43,    23,    23,   105,   106,    42,    35,    44,    40,
-      38,    39,     6,    41,    40,     9,    43,    23,   119,    13,
-      14,   122,    24,     4,    18,    19,    20,    21,    22,    42,
-      24,    44,    26,    23,    42,     5,    44,    25,    38,    43,
-      24,    35,    24,    23,    38,    23,    27,    41,    29,    30,
-      31,    32,    33,    34,    11,    36,    37,    27,    41,    29,
-      30,    31,    32,    33,    34,    33,    36,    37,    12,     7,
-      27,    43,    29,    30,    31,    32,    33,    34,    24,    36,
-      37,    40,    23,    27,    16,    29,    30,    31,    32,    33,
-      34,    41,    36,    37,    17,    27,    16,    29,    30,    31,
-      32,    33,    34,     3,    36,    37,    27,    99,    29,    30,
-      31,    32,    33,    34,    30,    36,    37,   120,    -1,    -1,
-      27,    42,    29,    30,    31,    32,    33,    34,    -1,    36,
-      37,    -1,    27,    40,    29,    30,    31,    32,    33,    34,
-      -1,    36,    37,    -1,    27,    40,    29,    30,    31,    32,
-      33,    34,    -1,    36,    37,    -1,    27,    40,    29,    30,
-      31,    32,    33,    34,    -1,    36,    37,    -1,    27,    40,
-      29,    30,    31,    32,    33,    34,    -1,    36,    37,    27,
-      39,    29,    30,    31,    32,    33,    34,    27,    36,    37,
-      -1,    31,    32,    33,    34,    27,    36,    37,    -1,    -1,
-      -1,    33,    34,    -1,    36,    37
+       0,    45,    46,    47,    47,    48,    48,    48,    49,    49,
+      49,    50,    50,    50,    50,    51,    51,    51,    52,    53,
+      53,    54,    55,    55,    55,    56,    56,    56,    57,    57,
+      57,    57,    57,    57,    57,    57,    57,    57,    57,    57,
+      57,    57,    57,    57,    57,    57,    57,    57,    57,    57,
+      57,    57,    57,    58,    58,    58,    58,    58
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     3,    46,    47,    48,     1,    23,     0,    48,    40,
-       8,    38,    23,    24,    49,    50,    38,    41,    43,    39,
-      50,    49,    24,    51,    52,    23,    40,    39,    43,    42,
-      44,    25,    40,    40,    23,    43,    52,     6,     9,    13,
-      14,    18,    19,    20,    21,    22,    24,    26,    35,    38,
-      41,    57,    23,    57,    24,    57,    57,    23,    57,    25,
-      57,    57,    56,    57,    57,    27,    29,    30,    31,    32,
-      33,    34,    36,    37,    40,    38,    12,    43,    10,    16,
-      57,    39,    57,    40,    42,    57,    57,    57,    57,    57,
-      24,    23,    57,    57,    57,    57,    23,    57,    24,    53,
-      54,    40,    41,    33,    39,     4,     7,    11,    43,    15,
-      54,    55,    57,    24,    40,    57,    57,    23,    42,    44,
-      41,     5,    17,    57,    55,    57,    42,    40
+       0,     2,     1,     1,     2,     6,     8,     2,     0,     2,
+       3,     9,     5,     3,     1,     0,     1,     3,     3,     1,
+       2,     6,     0,     1,     3,     2,     3,     2,     3,     8,
+       6,     4,     7,     5,     3,     5,     2,     3,     3,     3,
+       3,     2,     3,     3,     3,     2,     3,     1,     1,     1,
+       2,     2,     1,     7,     5,     7,     5,     3
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
 
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
+enum { YYENOMEM = -2 };
 
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-#define YYFAIL		goto yyerrlab
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (&yylloc, ctx, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
    the previous symbol: RHS[0] (always defined).  */
 
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
 #ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
-
-
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
-
-#ifndef YY_LOCATION_PRINT
-# if YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
 #endif
 
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
-
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -902,85 +996,119 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value, Location); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
-#else
-static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-    YYLTYPE const * const yylocationp;
-#endif
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
 {
-  if (!yyvaluep)
-    return;
-  YYUSE (yylocationp);
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
     {
-      default:
-	break;
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
     }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
 }
 
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, Location, ctx); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
-#else
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, parse_context *ctx)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (ctx);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep, yylocationp)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-    YYLTYPE const * const yylocationp;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, parse_context *ctx)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyoutput, *yylocationp);
-  YYFPRINTF (yyoutput, ": ");
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp);
-  YYFPRINTF (yyoutput, ")");
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, ctx);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -988,16 +1116,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep, yylocationp)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
 static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -1008,64 +1128,57 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yylsp, yyrule)
-    YYSTYPE *yyvsp;
-    YYLTYPE *yylsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, parse_context *ctx)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       , &(yylsp[(yyi + 1) - (yynrhs)])		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, yylsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule, ctx); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -1079,358 +1192,214 @@ int yydebug;
 #ifndef YYMAXDEPTH
 # define YYMAXDEPTH 10000
 #endif
+/* Parser data structure.  */
+struct yypstate
+  {
+    /* Number of syntax errors so far.  */
+    int yynerrs;
 
-
+    yy_state_fast_t yystate;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus;
 
-#if YYERROR_VERBOSE
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize;
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss;
+    yy_state_t *yyssp;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs;
+    YYSTYPE *yyvsp;
+
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls;
+    YYLTYPE *yylsp;
+    /* Whether this instance has not started parsing yet.
+     * If 2, it corresponds to a finished parsing.  */
+    int yynew;
+  };
 
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
 
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
 
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
-    {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
-
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
-
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
-
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
-
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
-    }
-}
-#endif /* YYERROR_VERBOSE */
-
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep, yylocationp)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-    YYLTYPE *yylocationp;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, parse_context *ctx)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
-
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (ctx);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
-
-  switch (yytype)
-    {
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
-/* Prevent warnings from -Wmissing-prototypes.  */
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
-
-
-/* The lookahead symbol.  */
-int yychar;
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
-
-/* Location data for the lookahead symbol.  */
-YYLTYPE yylloc;
-
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 
-/*-------------------------.
-| yyparse or yypush_parse.  |
-`-------------------------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
 int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void)
-#else
+yyparse (parse_context *ctx)
+{
+  yypstate *yyps = yypstate_new ();
+  if (!yyps)
+    {
+      static YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+      YYLTYPE yylloc = yyloc_default;
+      yyerror (&yylloc, ctx, YY_("memory exhausted"));
+      return 2;
+    }
+  int yystatus = yypull_parse (yyps, ctx);
+  yypstate_delete (yyps);
+  return yystatus;
+}
+
 int
-yyparse ()
+yypull_parse (yypstate *yyps, parse_context *ctx)
+{
+  YY_ASSERT (yyps);
+  static YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+  YYLTYPE yylloc = yyloc_default;
+  int yystatus;
+  do {
+    YYSTYPE yylval;
+    int yychar = yylex (&yylval, &yylloc, ctx);
+    yystatus = yypush_parse (yyps, yychar, &yylval, &yylloc, ctx);
+  } while (yystatus == YYPUSH_MORE);
+  return yystatus;
+}
 
-#endif
-#endif
+#define cool_yynerrs yyps->cool_yynerrs
+#define yystate yyps->yystate
+#define yyerrstatus yyps->yyerrstatus
+#define yyssa yyps->yyssa
+#define yyss yyps->yyss
+#define yyssp yyps->yyssp
+#define yyvsa yyps->yyvsa
+#define yyvs yyps->yyvs
+#define yyvsp yyps->yyvsp
+#define yylsa yyps->yylsa
+#define yyls yyps->yyls
+#define yylsp yyps->yylsp
+#define yystacksize yyps->yystacksize
+
+/* Initialize the parser data structure.  */
+static void
+yypstate_clear (yypstate *yyps)
 {
+  yynerrs = 0;
+  yystate = 0;
+  yyerrstatus = 0;
 
+  yyssp = yyss;
+  yyvsp = yyvs;
+  yylsp = yyls;
 
-    int yystate;
-    /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
+  /* Initialize the state stack, in case yypcontext_expected_tokens is
+     called before the first call to yyparse. */
+  *yyssp = 0;
+  yyps->yynew = 1;
+}
 
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
-       `yyls': related to locations.
+/* Initialize the parser data structure.  */
+yypstate *
+yypstate_new (void)
+{
+  yypstate *yyps;
+  yyps = YY_CAST (yypstate *, YYMALLOC (sizeof *yyps));
+  if (!yyps)
+    return YY_NULLPTR;
+  yystacksize = YYINITDEPTH;
+  yyss = yyssa;
+  yyvs = yyvsa;
+  yyls = yylsa;
+  yypstate_clear (yyps);
+  return yyps;
+}
 
-       Refer to the stacks thru separate pointers, to allow yyoverflow
-       to reallocate them elsewhere.  */
+void
+yypstate_delete (yypstate *yyps)
+{
+  if (yyps)
+    {
+#ifndef yyoverflow
+      /* If the stack was reallocated but the parse did not complete, then the
+         stack still needs to be freed.  */
+      if (yyss != yyssa)
+        YYSTACK_FREE (yyss);
+#endif
+      YYFREE (yyps);
+    }
+}
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
 
-    /* The location stack.  */
-    YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
+/*---------------.
+| yypush_parse.  |
+`---------------*/
+
+int
+yypush_parse (yypstate *yyps,
+              int yypushed_char, YYSTYPE const *yypushed_val, YYLTYPE *yypushed_loc, parse_context *ctx)
+{
+/* Lookahead token kind.  */
+int yychar;
+
 
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[2];
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
-    YYSIZE_T yystacksize;
+/* Location data for the lookahead symbol.  */
+static YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+YYLTYPE yylloc = yyloc_default;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1438,146 +1407,173 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yytoken = 0;
-  yyss = yyssa;
-  yyvs = yyvsa;
-  yyls = yylsa;
-  yystacksize = YYINITDEPTH;
+  switch (yyps->yynew)
+    {
+    case 0:
+      yyn = yypact[yystate];
+      goto yyread_pushed_token;
 
-  YYDPRINTF ((stderr, "Starting parse\n"));
+    case 2:
+      yypstate_clear (yyps);
+      break;
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
-  yychar = YYEMPTY; /* Cause a token to be read.  */
+    default:
+      break;
+    }
 
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-  yyssp = yyss;
-  yyvsp = yyvs;
-  yylsp = yyls;
+  YYDPRINTF ((stderr, "Starting parse\n"));
 
-#if YYLTYPE_IS_TRIVIAL
-  /* Initialize the default location before parsing starts.  */
-  yylloc.first_line   = yylloc.last_line   = 1;
-  yylloc.first_column = yylloc.last_column = 1;
-#endif
+  yychar = YYEMPTY; /* Cause a token to be read.  */
 
+  yylsp[0] = *yypushed_loc;
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-	YYLTYPE *yyls1 = yyls;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yyls1, yysize * sizeof (*yylsp),
-		    &yystacksize);
-
-	yyls = yyls1;
-	yyss = yyss1;
-	yyvs = yyvs1;
-      }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+        yyls = yyls1;
+      }
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
-	YYSTACK_RELOCATE (yyls_alloc, yyls);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
       yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
   /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      if (!yyps->yynew)
+        {
+          YYDPRINTF ((stderr, "Return for a new token:\n"));
+          yyresult = YYPUSH_MORE;
+          goto yypushreturn;
+        }
+      yyps->yynew = 0;
+yyread_pushed_token:
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yypushed_char;
+      if (yypushed_val)
+        yylval = *yypushed_val;
+      if (yypushed_loc)
+        yylloc = *yypushed_loc;
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1592,8 +1588,8 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
@@ -1605,13 +1601,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
   *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1626,14 +1623,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1642,444 +1639,422 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-  /* Default location.  */
+  /* Default location. */
   YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-
-/* Line 1455 of yacc.c  */
-#line 173 "cool.y"
-    { (yyloc) = (yylsp[(1) - (1)]); ast_root = program((yyvsp[(1) - (1)].classes)); }
+  case 2: /* program: class_list  */
+#line 365 "cool.y"
+                                { (yyloc) = (yylsp[0]); ctx->ast_root = NODE(program((yyvsp[0].classes))); }
+#line 1652 "cool.tab.c"
     break;
 
-  case 3:
-
-/* Line 1455 of yacc.c  */
-#line 178 "cool.y"
-    { (yyval.classes) = single_Classes((yyvsp[(1) - (1)].class_));
-    parse_results = (yyval.classes); }
+  case 3: /* class_list: class  */
+#line 370 "cool.y"
+    { (yyval.classes) = flat_single((yyvsp[0].class_));
+    ctx->parse_results = (yyval.classes); }
+#line 1659 "cool.tab.c"
     break;
 
-  case 4:
-
-/* Line 1455 of yacc.c  */
-#line 181 "cool.y"
-    { (yyval.classes) = append_Classes((yyvsp[(1) - (2)].classes),single_Classes((yyvsp[(2) - (2)].class_))); 
-    parse_results = (yyval.classes); }
+  case 4: /* class_list: class_list class  */
+#line 373 "cool.y"
+    { (yyval.classes) = flat_append((yyvsp[-1].classes),(yyvsp[0].class_)); 
+    ctx->parse_results = (yyval.classes); }
+#line 1666 "cool.tab.c"
     break;
 
-  case 5:
-
-/* Line 1455 of yacc.c  */
-#line 187 "cool.y"
-    { (yyval.class_) = class_((yyvsp[(2) - (6)].symbol),idtable.add_string("Object"),(yyvsp[(4) - (6)].features),
-    stringtable.add_string(curr_filename)); }
+  case 5: /* class: CLASS TYPEID '{' feature_list '}' ';'  */
+#line 379 "cool.y"
+    { (yyval.class_) = NODE(class_((yyvsp[-4].symbol),object_symbol(),(yyvsp[-2].features),filename_symbol(ctx)));
+    class_done(ctx, (yyval.class_)); }
+#line 1673 "cool.tab.c"
     break;
 
-  case 6:
-
-/* Line 1455 of yacc.c  */
-#line 190 "cool.y"
-    { (yyval.class_) = class_((yyvsp[(2) - (8)].symbol),(yyvsp[(4) - (8)].symbol),(yyvsp[(6) - (8)].features),stringtable.add_string(curr_filename)); }
+  case 6: /* class: CLASS TYPEID INHERITS TYPEID '{' feature_list '}' ';'  */
+#line 382 "cool.y"
+    { (yyval.class_) = NODE(class_((yyvsp[-6].symbol),(yyvsp[-4].symbol),(yyvsp[-2].features),filename_symbol(ctx)));
+    class_done(ctx, (yyval.class_)); }
+#line 1680 "cool.tab.c"
     break;
 
-  case 7:
-
-/* Line 1455 of yacc.c  */
-#line 192 "cool.y"
-    {}
+  case 7: /* class: error ';'  */
+#line 385 "cool.y"
+        { if (stop_parse(ctx)) YYABORT; }
+#line 1686 "cool.tab.c"
     break;
 
-  case 8:
-
-/* Line 1455 of yacc.c  */
-#line 198 "cool.y"
-    { (yyval.features) = nil_Features(); }
+  case 8: /* feature_list: %empty  */
+#line 391 "cool.y"
+    { (yyval.features) = flat_nil<Feature>(); }
+#line 1692 "cool.tab.c"
     break;
 
-  case 9:
-
-/* Line 1455 of yacc.c  */
-#line 200 "cool.y"
-    { (yyval.features) = single_Features((yyvsp[(1) - (1)].feature)); }
+  case 9: /* feature_list: feature ';'  */
+#line 393 "cool.y"
+        { (yyval.features) = flat_single((yyvsp[-1].feature)); }
+#line 1698 "cool.tab.c"
     break;
 
-  case 10:
-
-/* Line 1455 of yacc.c  */
-#line 202 "cool.y"
-    { (yyval.features) = append_Features((yyvsp[(1) - (2)].features),single_Features((yyvsp[(2) - (2)].feature))); }
+  case 10: /* feature_list: feature_list feature ';'  */
+#line 395 "cool.y"
+        { (yyval.features) = flat_append((yyvsp[-2].features),(yyvsp[-1].feature)); }
+#line 1704 "cool.tab.c"
     break;
 
-  case 11:
-
-/* Line 1455 of yacc.c  */
-#line 208 "cool.y"
-    { (yyval.feature) = method((yyvsp[(1) - (10)].symbol),(yyvsp[(3) - (10)].formals),(yyvsp[(6) - (10)].symbol),(yyvsp[(8) - (10)].expression)); }
+  case 11: /* feature: OBJECTID '(' formal_list ')' ':' TYPEID '{' expr '}'  */
+#line 401 "cool.y"
+        { (yyval.feature) = NODE(method((yyvsp[-8].symbol),(yyvsp[-6].formals),(yyvsp[-3].symbol),(yyvsp[-1].expression))); }
+#line 1710 "cool.tab.c"
     break;
 
-  case 12:
-
-/* Line 1455 of yacc.c  */
-#line 210 "cool.y"
-    { (yyval.feature) = attr((yyvsp[(1) - (6)].symbol),(yyvsp[(3) - (6)].symbol),(yyvsp[(5) - (6)].expression)); }
+  case 12: /* feature: OBJECTID ':' TYPEID ASSIGN expr  */
+#line 403 "cool.y"
+        { (yyval.feature) = NODE(attr((yyvsp[-4].symbol),(yyvsp[-2].symbol),(yyvsp[0].expression))); }
+#line 1716 "cool.tab.c"
     break;
 
-  case 13:
-
-/* Line 1455 of yacc.c  */
-#line 212 "cool.y"
-    { (yyval.feature) = attr((yyvsp[(1) - (4)].symbol),(yyvsp[(3) - (4)].symbol),no_expr()); }
+  case 13: /* feature: OBJECTID ':' TYPEID  */
+#line 405 "cool.y"
+        { (yyval.feature) = NODE(attr((yyvsp[-2].symbol),(yyvsp[0].symbol),NODE(no_expr()))); }
+#line 1722 "cool.tab.c"
     break;
 
-  case 14:
-
-/* Line 1455 of yacc.c  */
-#line 217 "cool.y"
-    { (yyval.formals) = nil_Formals(); }
+  case 14: /* feature: error  */
+#line 407 "cool.y"
+        { if (stop_parse(ctx)) YYABORT; }
+#line 1728 "cool.tab.c"
     break;
 
-  case 15:
-
-/* Line 1455 of yacc.c  */
-#line 219 "cool.y"
-    { (yyval.formals) = single_Formals((yyvsp[(1) - (1)].formal)); }
+  case 15: /* formal_list: %empty  */
+#line 412 "cool.y"
+        { (yyval.formals) = flat_nil<Formal>(); }
+#line 1734 "cool.tab.c"
     break;
 
-  case 16:
-
-/* Line 1455 of yacc.c  */
-#line 221 "cool.y"
-    { (yyval.formals) = append_Formals((yyvsp[(1) - (3)].formals), single_Formals((yyvsp[(3) - (3)].formal))); }
+  case 16: /* formal_list: formal  */
+#line 414 "cool.y"
+        { (yyval.formals) = flat_single((yyvsp[0].formal)); }
+#line 1740 "cool.tab.c"
     break;
 
-  case 17:
-
-/* Line 1455 of yacc.c  */
-#line 226 "cool.y"
-    { (yyval.formal) = formal((yyvsp[(1) - (3)].symbol), (yyvsp[(3) - (3)].symbol)); }
+  case 17: /* formal_list: formal_list ',' formal  */
+#line 416 "cool.y"
+        { (yyval.formals) = flat_append((yyvsp[-2].formals), (yyvsp[0].formal)); }
+#line 1746 "cool.tab.c"
     break;
 
-  case 18:
-
-/* Line 1455 of yacc.c  */
-#line 232 "cool.y"
-    { (yyval.cases) = single_Cases((yyvsp[(1) - (1)].case_)); }
+  case 18: /* formal: OBJECTID ':' TYPEID  */
+#line 421 "cool.y"
+        { (yyval.formal) = NODE(formal((yyvsp[-2].symbol), (yyvsp[0].symbol))); }
+#line 1752 "cool.tab.c"
     break;
 
-  case 19:
-
-/* Line 1455 of yacc.c  */
-#line 234 "cool.y"
-    { (yyval.cases) = append_Cases((yyvsp[(1) - (2)].cases), single_Cases((yyvsp[(2) - (2)].case_))); }
+  case 19: /* branch_list: branch  */
+#line 427 "cool.y"
+        { (yyval.cases) = flat_single((yyvsp[0].case_)); }
+#line 1758 "cool.tab.c"
     break;
 
-  case 20:
-
-/* Line 1455 of yacc.c  */
-#line 239 "cool.y"
-    { (yyval.case_) = branch((yyvsp[(1) - (6)].symbol),(yyvsp[(3) - (6)].symbol),(yyvsp[(5) - (6)].expression)); }
+  case 20: /* branch_list: branch_list branch  */
+#line 429 "cool.y"
+        { (yyval.cases) = flat_append((yyvsp[-1].cases), (yyvsp[0].case_)); }
+#line 1764 "cool.tab.c"
     break;
 
-  case 21:
-
-/* Line 1455 of yacc.c  */
-#line 245 "cool.y"
-    { (yyval.expressions) = nil_Expressions(); }
+  case 21: /* branch: OBJECTID ':' TYPEID DARROW expr ';'  */
+#line 434 "cool.y"
+        { (yyval.case_) = NODE(branch((yyvsp[-5].symbol),(yyvsp[-3].symbol),(yyvsp[-1].expression))); }
+#line 1770 "cool.tab.c"
     break;
 
-  case 22:
-
-/* Line 1455 of yacc.c  */
-#line 247 "cool.y"
-    { (yyval.expressions) = single_Expressions((yyvsp[(1) - (1)].expression)); }
+  case 22: /* comma_expr_list: %empty  */
+#line 440 "cool.y"
+        { (yyval.expressions) = flat_nil<Expression>(); }
+#line 1776 "cool.tab.c"
     break;
 
-  case 23:
-
-/* Line 1455 of yacc.c  */
-#line 249 "cool.y"
-    { (yyval.expressions) = append_Expressions((yyvsp[(1) - (3)].expressions),single_Expressions((yyvsp[(3) - (3)].expression))); }
+  case 23: /* comma_expr_list: expr  */
+#line 442 "cool.y"
+        { (yyval.expressions) = flat_single((yyvsp[0].expression)); }
+#line 1782 "cool.tab.c"
     break;
 
-  case 24:
-
-/* Line 1455 of yacc.c  */
-#line 255 "cool.y"
-    { (yyval.expressions) = single_Expressions((yyvsp[(1) - (2)].expression)); }
+  case 24: /* comma_expr_list: comma_expr_list ',' expr  */
+#line 444 "cool.y"
+        { (yyval.expressions) = flat_append((yyvsp[-2].expressions),(yyvsp[0].expression)); }
+#line 1788 "cool.tab.c"
     break;
 
-  case 25:
-
-/* Line 1455 of yacc.c  */
-#line 257 "cool.y"
-    { (yyval.expressions) = append_Expressions((yyvsp[(1) - (3)].expressions),single_Expressions((yyvsp[(2) - (3)].expression))); }
+  case 25: /* smcl_expr_list: expr ';'  */
+#line 450 "cool.y"
+        { (yyval.expressions) = flat_single((yyvsp[-1].expression)); }
+#line 1794 "cool.tab.c"
     break;
 
-  case 26:
-
-/* Line 1455 of yacc.c  */
-#line 262 "cool.y"
-    { (yyval.expression) = assign((yyvsp[(1) - (3)].symbol),(yyvsp[(3) - (3)].expression)); }
+  case 26: /* smcl_expr_list: smcl_expr_list expr ';'  */
+#line 452 "cool.y"
+        { (yyval.expressions) = flat_append((yyvsp[-2].expressions),(yyvsp[-1].expression)); }
+#line 1800 "cool.tab.c"
     break;
 
-  case 27:
-
-/* Line 1455 of yacc.c  */
-#line 264 "cool.y"
-    { (yyval.expression) = static_dispatch((yyvsp[(1) - (8)].expression),(yyvsp[(3) - (8)].symbol),(yyvsp[(5) - (8)].symbol),(yyvsp[(7) - (8)].expressions)); }
+  case 27: /* smcl_expr_list: error ';'  */
+#line 454 "cool.y"
+        { if (stop_parse(ctx)) YYABORT; (yyval.expressions) = flat_nil<Expression>(); }
+#line 1806 "cool.tab.c"
     break;
 
-  case 28:
-
-/* Line 1455 of yacc.c  */
-#line 266 "cool.y"
-    { (yyval.expression) = dispatch((yyvsp[(1) - (6)].expression),(yyvsp[(3) - (6)].symbol),(yyvsp[(5) - (6)].expressions)); }
+  case 28: /* expr: OBJECTID ASSIGN expr  */
+#line 459 "cool.y"
+        { (yyval.expression) = NODE(assign((yyvsp[-2].symbol),(yyvsp[0].expression))); }
+#line 1812 "cool.tab.c"
     break;
 
-  case 29:
-
-/* Line 1455 of yacc.c  */
-#line 268 "cool.y"
-    { (yyval.expression) = cond((yyvsp[(2) - (7)].expression),(yyvsp[(4) - (7)].expression),(yyvsp[(6) - (7)].expression)); }
+  case 29: /* expr: expr '@' TYPEID '.' OBJECTID '(' comma_expr_list ')'  */
+#line 461 "cool.y"
+        { (yyval.expression) = NODE(static_dispatch((yyvsp[-7].expression),(yyvsp[-5].symbol),(yyvsp[-3].symbol),(yyvsp[-1].expressions))); }
+#line 1818 "cool.tab.c"
     break;
 
-  case 30:
-
-/* Line 1455 of yacc.c  */
-#line 270 "cool.y"
-    { (yyval.expression) = loop((yyvsp[(2) - (5)].expression),(yyvsp[(4) - (5)].expression)); }
+  case 30: /* expr: expr '.' OBJECTID '(' comma_expr_list ')'  */
+#line 463 "cool.y"
+        { (yyval.expression) = NODE(dispatch((yyvsp[-5].expression),(yyvsp[-3].symbol),(yyvsp[-1].expressions))); }
+#line 1824 "cool.tab.c"
     break;
 
-  case 31:
-
-/* Line 1455 of yacc.c  */
-#line 272 "cool.y"
-    { (yyval.expression) = typcase((yyvsp[(2) - (5)].expression),(yyvsp[(4) - (5)].cases)); }
+  case 31: /* expr: OBJECTID '(' comma_expr_list ')'  */
+#line 465 "cool.y"
+        { (yyval.expression) = NODE(dispatch(NODE(object(self_symbol())),(yyvsp[-3].symbol),(yyvsp[-1].expressions))); }
+#line 1830 "cool.tab.c"
     break;
 
-  case 32:
-
-/* Line 1455 of yacc.c  */
-#line 274 "cool.y"
-    { (yyval.expression) = block((yyvsp[(2) - (3)].expressions)); }
+  case 32: /* expr: IF expr THEN expr ELSE expr FI  */
+#line 467 "cool.y"
+        { (yyval.expression) = NODE(cond((yyvsp[-5].expression),(yyvsp[-3].expression),(yyvsp[-1].expression))); }
+#line 1836 "cool.tab.c"
     break;
 
-  case 33:
-
-/* Line 1455 of yacc.c  */
-#line 276 "cool.y"
-    {}
+  case 33: /* expr: WHILE expr LOOP expr POOL  */
+#line 469 "cool.y"
+        { (yyval.expression) = NODE(loop((yyvsp[-3].expression),(yyvsp[-1].expression))); }
+#line 1842 "cool.tab.c"
     break;
 
-  case 34:
-
-/* Line 1455 of yacc.c  */
-#line 278 "cool.y"
-    { (yyval.expression) = plus((yyvsp[(1) - (3)].expression),(yyvsp[(3) - (3)].expression)); }
+  case 34: /* expr: '{' smcl_expr_list '}'  */
+#line 471 "cool.y"
+        { (yyval.expression) = NODE(block((yyvsp[-1].expressions))); }
+#line 1848 "cool.tab.c"
     break;
 
-  case 35:
-
-/* Line 1455 of yacc.c  */
-#line 280 "cool.y"
-    { (yyval.expression) = sub((yyvsp[(1) - (3)].expression),(yyvsp[(3) - (3)].expression)); }
+  case 35: /* expr: CASE expr OF branch_list ESAC  */
+#line 473 "cool.y"
+        { (yyval.expression) = NODE(typcase((yyvsp[-3].expression),(yyvsp[-1].cases))); }
+#line 1854 "cool.tab.c"
     break;
 
-  case 36:
-
-/* Line 1455 of yacc.c  */
-#line 282 "cool.y"
-    { (yyval.expression) = mul((yyvsp[(1) - (3)].expression),(yyvsp[(3) - (3)].expression)); }
+  case 36: /* expr: LET let_body  */
+#line 475 "cool.y"
+        { (yyval.expression) = (yyvsp[0].expression); }
+#line 1860 "cool.tab.c"
     break;
 
-  case 37:
-
-/* Line 1455 of yacc.c  */
-#line 284 "cool.y"
-    { (yyval.expression) = divide((yyvsp[(1) - (3)].expression),(yyvsp[(3) - (3)].expression)); }
+  case 37: /* expr: expr '+' expr  */
+#line 477 "cool.y"
+        { (yyval.expression) = NODE(plus((yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1866 "cool.tab.c"
     break;
 
-  case 38:
-
-/* Line 1455 of yacc.c  */
-#line 286 "cool.y"
-    { (yyval.expression) = neg((yyvsp[(2) - (2)].expression)); }
+  case 38: /* expr: expr '-' expr  */
+#line 479 "cool.y"
+        { (yyval.expression) = NODE(sub((yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1872 "cool.tab.c"
     break;
 
-  case 39:
-
-/* Line 1455 of yacc.c  */
-#line 288 "cool.y"
-    { (yyval.expression) = lt((yyvsp[(1) - (3)].expression),(yyvsp[(3) - (3)].expression)); }
+  case 39: /* expr: expr '*' expr  */
+#line 481 "cool.y"
+        { (yyval.expression) = NODE(mul((yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1878 "cool.tab.c"
     break;
 
-  case 40:
-
-/* Line 1455 of yacc.c  */
-#line 290 "cool.y"
-    { (yyval.expression) = eq((yyvsp[(1) - (3)].expression),(yyvsp[(3) - (3)].expression)); }
+  case 40: /* expr: expr '/' expr  */
+#line 483 "cool.y"
+        { (yyval.expression) = NODE(divide((yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1884 "cool.tab.c"
     break;
 
-  case 41:
-
-/* Line 1455 of yacc.c  */
-#line 292 "cool.y"
-    { (yyval.expression) = leq((yyvsp[(1) - (3)].expression),(yyvsp[(3) - (3)].expression)); }
+  case 41: /* expr: '~' expr  */
+#line 485 "cool.y"
+        { (yyval.expression) = NODE(neg((yyvsp[0].expression))); }
+#line 1890 "cool.tab.c"
     break;
 
-  case 42:
+  case 42: /* expr: expr '<' expr  */
+#line 487 "cool.y"
+        { (yyval.expression) = NODE(lt((yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1896 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 294 "cool.y"
-    { (yyval.expression) = comp((yyvsp[(2) - (2)].expression)); }
+  case 43: /* expr: expr '=' expr  */
+#line 489 "cool.y"
+        { (yyval.expression) = NODE(eq((yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1902 "cool.tab.c"
     break;
 
-  case 43:
+  case 44: /* expr: expr LE expr  */
+#line 491 "cool.y"
+        { (yyval.expression) = NODE(leq((yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1908 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 296 "cool.y"
-    { (yyval.expression) = (yyvsp[(2) - (3)].expression); }
+  case 45: /* expr: NOT expr  */
+#line 493 "cool.y"
+        { (yyval.expression) = NODE(comp((yyvsp[0].expression))); }
+#line 1914 "cool.tab.c"
     break;
 
-  case 44:
+  case 46: /* expr: '(' expr ')'  */
+#line 495 "cool.y"
+        { (yyval.expression) = (yyvsp[-1].expression); }
+#line 1920 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 298 "cool.y"
-    { (yyval.expression) = int_const((yyvsp[(1) - (1)].symbol)); }
+  case 47: /* expr: INT_CONST  */
+#line 497 "cool.y"
+        { (yyval.expression) = NODE(int_const((yyvsp[0].symbol))); }
+#line 1926 "cool.tab.c"
     break;
 
-  case 45:
+  case 48: /* expr: BOOL_CONST  */
+#line 499 "cool.y"
+        { (yyval.expression) = NODE(bool_const((yyvsp[0].boolean))); }
+#line 1932 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 300 "cool.y"
-    { (yyval.expression) = bool_const((yyvsp[(1) - (1)].boolean)); }
+  case 49: /* expr: STR_CONST  */
+#line 501 "cool.y"
+        { (yyval.expression) = NODE(string_const((yyvsp[0].symbol))); }
+#line 1938 "cool.tab.c"
     break;
 
-  case 46:
+  case 50: /* expr: NEW TYPEID  */
+#line 503 "cool.y"
+        { (yyval.expression) = NODE(new_((yyvsp[0].symbol))); }
+#line 1944 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 302 "cool.y"
-    { (yyval.expression) = string_const((yyvsp[(1) - (1)].symbol)); }
+  case 51: /* expr: ISVOID expr  */
+#line 505 "cool.y"
+        { (yyval.expression) = NODE(isvoid((yyvsp[0].expression))); }
+#line 1950 "cool.tab.c"
     break;
 
-  case 47:
+  case 52: /* expr: OBJECTID  */
+#line 507 "cool.y"
+        { (yyval.expression) = NODE(object((yyvsp[0].symbol))); }
+#line 1956 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 304 "cool.y"
-    { (yyval.expression) = new_((yyvsp[(2) - (2)].symbol)); }
+  case 53: /* let_body: OBJECTID ':' TYPEID ASSIGN expr IN expr  */
+#line 513 "cool.y"
+        { (yyval.expression) = NODE(let((yyvsp[-6].symbol),(yyvsp[-4].symbol),(yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1962 "cool.tab.c"
     break;
 
-  case 48:
+  case 54: /* let_body: OBJECTID ':' TYPEID IN expr  */
+#line 515 "cool.y"
+        { (yyval.expression) = NODE(let((yyvsp[-4].symbol),(yyvsp[-2].symbol),NODE(no_expr()),(yyvsp[0].expression))); }
+#line 1968 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 306 "cool.y"
-    { (yyval.expression) = isvoid((yyvsp[(2) - (2)].expression)); }
+  case 55: /* let_body: OBJECTID ':' TYPEID ASSIGN expr ',' let_body  */
+#line 517 "cool.y"
+        { (yyval.expression) = NODE(let((yyvsp[-6].symbol),(yyvsp[-4].symbol),(yyvsp[-2].expression),(yyvsp[0].expression))); }
+#line 1974 "cool.tab.c"
     break;
 
-  case 49:
+  case 56: /* let_body: OBJECTID ':' TYPEID ',' let_body  */
+#line 519 "cool.y"
+        { (yyval.expression) = NODE(let((yyvsp[-4].symbol),(yyvsp[-2].symbol),NODE(no_expr()),(yyvsp[0].expression))); }
+#line 1980 "cool.tab.c"
+    break;
 
-/* Line 1455 of yacc.c  */
-#line 308 "cool.y"
-    { (yyval.expression) = object((yyvsp[(1) - (1)].symbol)); }
+  case 57: /* let_body: error ',' let_body  */
+#line 521 "cool.y"
+        { if (stop_parse(ctx)) YYABORT; }
+#line 1986 "cool.tab.c"
     break;
 
 
+#line 1990 "cool.tab.c"
 
-/* Line 1455 of yacc.c  */
-#line 1993 "cool.tab.c"
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (YY_("syntax error"));
-#else
-      {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (yymsg);
-	  }
-	else
-	  {
-	    yyerror (YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
-      }
-#endif
+      yyerror (&yylloc, ctx, YY_("syntax error"));
     }
 
-  yyerror_range[0] = yylloc;
-
+  yyerror_range[1] = yylloc;
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval, &yylloc);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, &yylloc, ctx);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -2091,15 +2066,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  yyerror_range[0] = yylsp[1-yylen];
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2112,44 +2085,45 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
-      yyerror_range[0] = *yylsp;
+      yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
-  yyerror_range[1] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, (yyerror_range - 1), 2);
-  *++yylsp = yyloc;
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2160,70 +2134,2680 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined(yyoverflow) || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (&yylloc, ctx, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval, &yylloc);
-  /* Do not reclaim the symbols of the rule which action triggered
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, &yylloc, ctx);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, ctx);
       YYPOPSTACK (1);
     }
-#ifndef yyoverflow
-  if (yyss != yyssa)
-    YYSTACK_FREE (yyss);
-#endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
+  yyps->yynew = 2;
+  goto yypushreturn;
 
 
+/*-------------------------.
+| yypushreturn -- return.  |
+`-------------------------*/
+yypushreturn:
 
-/* Line 1675 of yacc.c  */
-#line 313 "cool.y"
+  return yyresult;
+}
+#undef cool_yynerrs
+#undef yystate
+#undef yyerrstatus
+#undef yyssa
+#undef yyss
+#undef yyssp
+#undef yyvsa
+#undef yyvs
+#undef yyvsp
+#undef yylsa
+#undef yyls
+#undef yylsp
+#undef yystacksize
+#line 526 "cool.y"
 
     
-    /* This function is called automatically when Bison detects a parse error. */
-    void yyerror(char *s)
+    /* The string tables, and cool_token_to_string() when reporting
+       errors, are shared by all parses. */
+    static std::mutex symbols_lock;
+    
+    /* What print_cool_token() shows for token. */
+    static std::string token_text(int token, const YYSTYPE &value)
     {
-      extern int curr_lineno;
+      std::ostringstream text;
       
-      cerr << "\"" << curr_filename << "\", line " << curr_lineno << ": " \
-      << s << " at or near ";
-      print_cool_token(yychar);
-      cerr << endl;
-      omerrs++;
+      text << cool_token_to_string(token);
+      switch (token) {
+        case STR_CONST:
+          text << " = \"";
+          print_escaped_string(text, value.symbol->get_string());
+          text << "\"";
+          break;
+        case INT_CONST:
+        case TYPEID:
+        case OBJECTID:
+          text << " = " << value.symbol;
+          break;
+        case BOOL_CONST:
+          text << (value.boolean ? " = true" : " = false");
+          break;
+        case ERROR:
+          text << " = \"" << value.error_msg << "\"";
+          break;
+      }
+      return text.str();
+    }
+    
+    /* This function is called automatically when Bison detects a parse
+       error, with loc at the line of the offending token.  The error
+       goes to ctx->diag (see diagnostics.h). */
+    void yyerror(YYLTYPE *loc, parse_context *ctx, const char *s)
+    {
+      ctx->errors++;
+      if (ctx->diag == nullptr)
+        return;
       
-      if(omerrs>50) {fprintf(stdout, "More than 50 errors\n"); exit(1);}
+      diagnostic d;
+      d.file = ctx->filename;
+      d.line = *loc;
+      d.message = s;
+      {
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        d.token = token_text(ctx->last_token, ctx->last_value);
+      }
+      ctx->diag->report(d);
+    }
+    
+    /* For the error rules: whether to give up rather than recover.  A
+       parse without diagnostics only needs to know it has errors. */
+    static bool stop_parse(parse_context *ctx)
+    {
+      return ctx->diag == nullptr || (size_t) ctx->errors > ctx->diag->limit;
+    }
+    
+    parse_context::parse_context(FILE *tokens)
+      : tokens(tokens), stream(), filename(curr_filename), filename_sym(NULL),
+        lineno(1), last_token(0), node_lineno(1), errors(0),
+        lazy_bodies(false), ast_root(NULL), parse_results(NULL), replay()
+    {
     }
     
+    /* A node built by an action gets the line of the rule being reduced
+       (see NODE() at the top of the file). */
+    struct line_access : tree_node {
+      static int tree_node::*member() { return &line_access::line_number; }
+    };
     
-
+    template <class T> static T node_at(int line, T node)
+    {
+      node->*line_access::member() = line;
+      return node;
+    }
+    
+    template <class T> static T node_at(parse_context *ctx, T node)
+    {
+      return node_at(ctx->node_lineno, node);
+    }
+    
+    /*
+     * Token input.  The lexer writes a binary token stream instead of the
+     * textual dump when run with COOL_TOKEN_FORMAT=binary (the format is
+     * described next to write_token_stream() in cool.flex).  A stream is
+     * recognised by the magic word right after the "#name" line and read
+     * here a block at a time, straight into the arrays of ctx->stream;
+     * anything else is left to cool_yylex() from tokens-lex.cc, which
+     * reads token_file through globals of its own, so only binary streams
+     * can be parsed several at a time.
+     */
+    #define TOKEN_STREAM_MAGIC    0x4b54437fu
+    #define TOKEN_STREAM_VERSION  2u
+    #define TOKEN_STREAM_KEYED    4u      /* with a parse cache key */
+    #define TOKEN_STREAM_CACHED   8u      /* the cache's tree in place of blocks */
+    
+    enum { SYM_ID, SYM_INT, SYM_STR, SYM_ERROR };
+    
+    extern FILE *token_file;
+    extern int cool_yylex();
+    extern int curr_lineno;
+    extern int verbose_flag;
+    
+    /* The lexer of tokens-lex.cc hands its values over in cool_yylval,
+       which a pure parser does not define for it. */
+    YYSTYPE cool_yylval;
+    
+    /* fatal_error() takes a char *, which a string literal is not. */
+    static void stream_error(const char *msg)
+    {
+      std::string text(msg);
+      fatal_error(&text[0]);
+    }
+    
+    /* The cache of COOL_PARSE_CACHE (see parse-cache.h), or NULL. */
+    static parse_cache *shared_cache()
+    {
+      static const char *dir = getenv("COOL_PARSE_CACHE");
+      static parse_cache *cache =
+        dir != NULL && *dir != '\0' ? new parse_cache(dir) : NULL;
+      
+      return cache;
+    }
+    
+    /* Where a stream is read from: ctx->tokens, or for push_parser a
+       buffer already known to hold all that is read from it. */
+    struct file_source {
+      FILE *file;
+      
+      void read(void *to, size_t n)
+      {
+        if (fread(to, 1, n, file) != n)
+          stream_error("truncated binary token stream");
+      }
+    };
+    
+    struct buffer_source {
+      const char *bytes;
+      
+      void read(void *to, size_t n)
+      {
+        memcpy(to, bytes, n);
+        bytes += n;
+      }
+    };
+    
+    template <class Source> static unsigned get_word(Source &in)
+    {
+      unsigned w;
+      
+      in.read(&w, sizeof(w));
+      return w;
+    }
+    
+    template <class Source>
+    static void get_words(Source &in, std::vector<int> &words, size_t n)
+    {
+      words.resize(n);
+      in.read(words.data(), n * sizeof(int));
+    }
+    
+    /* Read the next block: its new symbols, then its tokens. */
+    template <class Source> static void read_block(parse_context *ctx, Source &in)
+    {
+      token_stream &stream = ctx->stream;
+      unsigned nsyms = get_word(in);
+      std::string text;
+      for (unsigned i = 0; i < nsyms; i++) {
+        unsigned kind = get_word(in);
+        text.resize(get_word(in));
+        in.read(&text[0], text.length());
+        
+        YYSTYPE v;
+        char *s = (char *) text.c_str();
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        switch (kind) {
+          case SYM_ID:  v.symbol = idtable.add_string(s); break;
+          case SYM_INT: v.symbol = inttable.add_string(s); break;
+          case SYM_STR: v.symbol = stringtable.add_string(s); break;
+          default:      v.error_msg = strdup(s); break;
+        }
+        stream.symbols.push_back(v);
+      }
+      
+      stream.count = get_word(in);
+      stream.next = 0;
+      stream.done = stream.count == 0;
+      get_words(in, stream.token, stream.count);
+      get_words(in, stream.line, stream.count);
+      get_words(in, stream.value, stream.count);
+    }
+    
+    /* The text of a "#name" line, after the '#'. */
+    static void set_name(parse_context *ctx, const std::string &line)
+    {
+      size_t open = line.find('"'), close = line.rfind('"');
+      if (line.compare(0, 4, "name") == 0 && open != close)
+      {
+        ctx->filename = strdup(line.substr(open + 1, close - open - 1).c_str());
+        ctx->filename_sym = NULL;
+      }
+    }
+    
+    /* Read the header of a new stream. */
+    template <class Source> static void start_stream(parse_context *ctx, Source &in)
+    {
+      token_stream &stream = ctx->stream;
+      unsigned magic = get_word(in);
+      unsigned version = get_word(in);
+      
+      stream.keyed = stream.cached = false;
+      if (magic == TOKEN_STREAM_MAGIC &&
+          (version == TOKEN_STREAM_KEYED || version == TOKEN_STREAM_CACHED)) {
+        for (int i = 0; i < 4; i++)
+          stream.key[i] = get_word(in);
+        stream.keyed = true;
+      } else if (magic != TOKEN_STREAM_MAGIC || version != TOKEN_STREAM_VERSION)
+        stream_error("bad binary token stream header");
+      stream.symbols.clear();
+      stream.done = false;
+      stream.count = stream.next = 0;
+      
+      /* A file the lexer found in the cache has no blocks to read, and
+         only cached_parse() knows what to do with its tree. */
+      if (version == TOKEN_STREAM_CACHED) {
+        if (shared_cache() == NULL)
+          stream_error("cached tree in the token stream, but no COOL_PARSE_CACHE");
+        size_t path = get_word(in);
+        stream.entry.resize(get_word(in));
+        stream.lexer.resize(path);
+        in.read(&stream.lexer[0], path);
+        char pad[3];
+        in.read(pad, -path & 3);
+        in.read(stream.entry.data(), stream.entry.size());
+        stream.cached = stream.done = true;
+      }
+    }
+    
+    static unsigned word_at(const char *bytes, size_t at)
+    {
+      unsigned w;
+      
+      memcpy(&w, bytes + at, sizeof(w));
+      return w;
+    }
+    
+    /* The length of the header bytes starts with, or 0 if fewer than n. */
+    static size_t header_size(const char *bytes, size_t n)
+    {
+      unsigned version;
+      
+      if (n < 2 * sizeof(unsigned))
+        return 0;
+      memcpy(&version, bytes + sizeof(unsigned), sizeof(version));
+      size_t size = (version == TOKEN_STREAM_KEYED ? 6 :
+                     version == TOKEN_STREAM_CACHED ? 8 : 2) * sizeof(unsigned);
+      if (version == TOKEN_STREAM_CACHED && size <= n) {
+        /* with the lexer's path and the entry, the whole stream */
+        unsigned path = word_at(bytes, 6 * sizeof(unsigned));
+        unsigned entry = word_at(bytes, 7 * sizeof(unsigned));
+        size += (path + 3) / 4 * 4 + entry;
+      }
+      return size <= n ? size : 0;
+    }
+    
+    /* Consume the "#name" line the lexer puts before each file and see
+       whether a binary stream follows it.  Returns false at EOF. */
+    static bool start_file(parse_context *ctx)
+    {
+      int c = getc(ctx->tokens);
+      
+      if (c == '#') {
+        std::string line;
+        while ((c = getc(ctx->tokens)) != EOF && c != '\n')
+          line += (char) c;
+        set_name(ctx, line);
+        c = getc(ctx->tokens);
+      }
+      if (c == EOF)
+        return false;
+      ungetc(c, ctx->tokens);
+      
+      ctx->stream.binary = (unsigned char) c == (TOKEN_STREAM_MAGIC & 0xff);
+      if (ctx->stream.binary) {
+        file_source in = { ctx->tokens };
+        start_stream(ctx, in);
+      }
+      return true;
+    }
+    
+    /* The value of the token stream.next - 1 of the current block. */
+    static int stream_token(parse_context *ctx, YYSTYPE *lval)
+    {
+      token_stream &stream = ctx->stream;
+      size_t i = stream.next - 1;
+      int token = stream.token[i];
+      
+      ctx->lineno = stream.line[i];
+      switch (token) {
+        case TYPEID:
+        case OBJECTID:
+        case INT_CONST:
+        case STR_CONST:
+        case ERROR:
+          *lval = stream.symbols[stream.value[i]];
+          break;
+        case BOOL_CONST:
+          lval->boolean = stream.value[i];
+          break;
+      }
+      return token;
+    }
+    
+    static int next_token(parse_context *ctx, YYSTYPE *lval)
+    {
+      token_stream &stream = ctx->stream;
+      token_buffer &replay = ctx->replay;
+      
+      if (replay.next < replay.tokens.size()) {
+        const buffered_token &t = replay.tokens[replay.next++];
+        *lval = t.value;
+        ctx->lineno = t.line;
+        return t.token;
+      }
+      if (!stream.started) {
+        stream.started = true;
+        if (!start_file(ctx))
+          return 0;
+      }
+      
+      while (stream.binary && stream.next == stream.count) {
+        file_source in = { ctx->tokens };
+        if (!stream.done)
+          read_block(ctx, in);
+        else if (!start_file(ctx))
+          return 0;
+      }
+      if (!stream.binary) {
+        /* tokens-lex interns, perhaps while pieces are parsed */
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        int token = cool_yylex();
+        *lval = cool_yylval;
+        ctx->lineno = curr_lineno;
+        return token;
+      }
+      
+      stream.next++;
+      return stream_token(ctx, lval);
+    }
+    
+    static int token_stream_lex(YYSTYPE *lval, YYLTYPE *lloc, parse_context *ctx)
+    {
+      ctx->last_token = next_token(ctx, lval);
+      ctx->last_value = *lval;
+      *lloc = ctx->lineno;
+      return ctx->last_token;
+    }
+    
+    /* add_string walks the table's list, so these are looked up once
+       rather than once per class or dispatch. */
+    static Symbol intern_id(const char *s)
+    {
+      std::lock_guard<std::mutex> hold(symbols_lock);
+      return idtable.add_string((char *) s);
+    }
+    
+    static Symbol object_symbol()
+    {
+      static Symbol sym = intern_id("Object");
+      return sym;
+    }
+    
+    static Symbol self_symbol()
+    {
+      static Symbol sym = intern_id("self");
+      return sym;
+    }
+    
+    /* start_file() clears ctx->filename_sym whenever the name changes. */
+    static Symbol filename_symbol(parse_context *ctx)
+    {
+      if (ctx->filename_sym == NULL) {
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        ctx->filename_sym = stringtable.add_string(ctx->filename);
+      }
+      return ctx->filename_sym;
+    }
+    
+    /* Each class is handed to ctx->on_class as soon as it is reduced, for
+       as long as the program has no errors, so that a caller can start
+       on the first classes of a long program while the rest of it is
+       still being read (see push_parser, and cool_yyparse(), which
+       dumps them there for COOL_PARSER=stream). */
+    static void class_done(parse_context *ctx, Class_ c)
+    {
+      if (ctx->on_class && ctx->errors == 0)
+        ctx->on_class(c);
+    }
+    
+    /* For descent_parser::splice() and cached_parse(), as line_access is
+       for node_at(), and for the outline of a program (see
+       print_outline()). */
+    struct class_access : class__class {
+      static Features class__class::*member() { return &class_access::features; }
+      static Symbol class__class::*file() { return &class_access::filename; }
+      static Symbol class__class::*class_name() { return &class_access::name; }
+      static Symbol class__class::*parent_name() { return &class_access::parent; }
+    };
+    
+    /* For lazy_body, which parses its tokens as the body of a method or
+       the initializer of an attribute, and for the outline. */
+    struct method_access : method_class {
+      static Expression method_class::*body() { return &method_access::expr; }
+      static Symbol method_class::*method_name() { return &method_access::name; }
+      static Formals method_class::*formal_list() { return &method_access::formals; }
+      static Symbol method_class::*result() { return &method_access::return_type; }
+    };
+    
+    struct attr_access : attr_class {
+      static Expression attr_class::*body() { return &attr_access::init; }
+      static Symbol attr_class::*attr_name() { return &attr_access::name; }
+      static Symbol attr_class::*type() { return &attr_access::type_decl; }
+    };
+    
+    struct formal_access : formal_class {
+      static Symbol formal_class::*formal_name() { return &formal_access::name; }
+      static Symbol formal_class::*type() { return &formal_access::type_decl; }
+    };
+    
+    /*
+     * A hand written parser for the grammar above, used instead of the
+     * LALR tables with COOL_PARSER=descent, and for the signatures of a
+     * program when its bodies are left lazy and the bodies once they are
+     * asked for.  parser-diff.pl checks that it builds the same trees as
+     * the tables do.  Expressions are parsed by precedence climbing over the levels of
+     * the %left/%right/%nonassoc declarations, taking the same shift or
+     * reduce decision the tables take: an operator continues the operand
+     * of a rule of level R when its own level is higher, or equal and
+     * %right; at an equal %nonassoc level it is an error.  A rule without
+     * a level (the body of a let) takes every operator, as the default
+     * shift does.  Each node gets the line of the first token of its
+     * rule, as NODE() gives it, and lists are built with the same flat_
+     * helpers.
+     *
+     * The parser only recognises programs without syntax errors.  At the
+     * first token that cannot continue the program it gives up, and the
+     * LALR parser parses the tokens in ctx->replay again, then the rest
+     * of the input, so that errors are reported and recovered from
+     * exactly as before.  The tables recover from an error inside a
+     * feature the same way whichever classes and features came before
+     * it (the error rules of feature and class are reached through the
+     * same states), so the buffer only keeps the header of the current
+     * class and the tokens of its current feature.
+     *
+     * Recursion follows the nesting of the program.  Past MAX_DEPTH
+     * expressions one inside the other the parser gives up as well, and
+     * once the LALR parser, whose stacks are on the heap, has parsed the
+     * rest of the program, splice() puts the classes and features that
+     * were done in front of what it built.
+     *
+     * With ctx->lazy_bodies the expressions of features are skipped and
+     * left to lazy_body (see lazy-body.h), which parses them with
+     * parse_body() when asked.  An error in them is not seen then, so a
+     * parse only gives up on the signatures around them.
+     */
+    class descent_parser {
+    private:
+      struct give_up { };
+      
+      enum { LEFT, RIGHT, NONASSOC };
+      enum { MAX_DEPTH = 10000 };
+      
+      parse_context *ctx;
+      token_buffer &buf;
+      int first_line;                 /* of the program */
+      flat_list<Class_> *classes;     /* those parsed so far */
+      flat_list<Feature> *features;   /* of the class being parsed, in its body */
+      int depth;                      /* of the expressions being parsed */
+      
+      struct nested {
+        int &depth;
+        
+        nested(int &depth) : depth(depth)
+        {
+          if (++depth > MAX_DEPTH)
+            throw give_up();
+        }
+        ~nested() { depth--; }
+      };
+      
+      const buffered_token &next()
+      {
+        if (buf.next == buf.tokens.size()) {
+          buffered_token t;
+          t.token = next_token(ctx, &t.value);
+          t.line = ctx->lineno;
+          buf.tokens.push_back(t);
+        }
+        return buf.tokens[buf.next];
+      }
+      
+      int peek() { return next().token; }
+      
+      /* Drop the tokens read since from, the next one excepted. */
+      void forget(size_t from)
+      {
+        buf.tokens.erase(buf.tokens.begin() + from,
+                         buf.tokens.begin() + buf.next);
+        buf.next = from;
+      }
+      int line() { return next().line; }
+      
+      void expect(int token)
+      {
+        if (peek() != token)
+          throw give_up();
+        buf.next++;
+      }
+      
+      /* The value of the next token, which must be token. */
+      YYSTYPE take(int token)
+      {
+        expect(token);
+        return buf.tokens[buf.next - 1].value;
+      }
+      
+      /* The level of an operator that follows an operand, 0 for none. */
+      static int level(int token, int &assoc)
+      {
+        switch (token) {
+          case '=':            assoc = NONASSOC; return 1;
+          case '+': case '-':  assoc = LEFT;     return 3;
+          case '*': case '/':  assoc = LEFT;     return 4;
+          case '.': case '@':  assoc = LEFT;     return 5;
+          case '<': case LE:   assoc = NONASSOC; return 9;
+          default:             return 0;
+        }
+      }
+      
+      /* Levels of the rules that end in an operand. */
+      enum { ANY = 0, ASSIGN_LEVEL = 2, NEG_LEVEL = 6, ISVOID_LEVEL = 7,
+             NOT_LEVEL = 8 };
+      
+      Class_ parse_class()
+      {
+        int at = line();
+        expect(CLASS);
+        Symbol name = take(TYPEID).symbol;
+        Symbol parent = object_symbol();
+        if (peek() == INHERITS) {
+          buf.next++;
+          parent = take(TYPEID).symbol;
+        }
+        expect('{');
+        size_t header = buf.next;
+        features = flat_nil<Feature>();
+        for (forget(header); peek() != '}'; forget(header)) {
+          features = flat_append(features, parse_feature());
+          expect(';');
+        }
+        buf.next++;
+        expect(';');
+        Features body = features;
+        features = NULL;
+        return node_at(at, class_(name, parent, body, filename_symbol(ctx)));
+      }
+      
+      Feature parse_feature()
+      {
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        
+        if (peek() == '(') {
+          buf.next++;
+          flat_list<Formal> *formals = flat_nil<Formal>();
+          if (peek() != ')') {
+            if (peek() == ',')        /* formal_list may start empty */
+              buf.next++;
+            formals = flat_append(formals, parse_formal());
+            while (peek() == ',') {
+              buf.next++;
+              formals = flat_append(formals, parse_formal());
+            }
+          }
+          expect(')');
+          expect(':');
+          Symbol type = take(TYPEID).symbol;
+          expect('{');
+          Expression body = ctx->lazy_bodies ? skip_body('}') : parse_expr(ANY);
+          expect('}');
+          return node_at(at, method(name, formals, type, body));
+        }
+        
+        expect(':');
+        Symbol type = take(TYPEID).symbol;
+        if (peek() != ASSIGN)
+          return node_at(at, attr(name, type, node_at(at, no_expr())));
+        buf.next++;
+        Expression init = ctx->lazy_bodies ? skip_body(';') : parse_expr(ANY);
+        return node_at(at, attr(name, type, init));
+      }
+      
+      /* A lazy_body for the tokens up to end, outside any brackets. */
+      Expression skip_body(int end)
+      {
+        size_t from = buf.next;
+        int nesting = 0;
+        
+        for (int token; (token = peek()) != end || nesting > 0; buf.next++)
+          switch (token) {
+            case '{': case '(': case CASE:
+              nesting++;
+              break;
+            case '}': case ')': case ESAC:
+              if (--nesting < 0)
+                throw give_up();
+              break;
+            case 0:
+              throw give_up();
+          }
+        int at = buf.tokens[from].line;
+        return node_at(at, new lazy_body(&buf.tokens[from], buf.next + 1 - from,
+                                         ctx->filename, ctx->diag));
+      }
+      
+      Formal parse_formal()
+      {
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        expect(':');
+        return node_at(at, formal(name, take(TYPEID).symbol));
+      }
+      
+      /* '(' comma_expr_list ')' */
+      Expressions parse_actuals()
+      {
+        flat_list<Expression> *actuals = flat_nil<Expression>();
+        
+        expect('(');
+        if (peek() != ')') {
+          if (peek() == ',')          /* comma_expr_list may start empty */
+            buf.next++;
+          actuals = flat_append(actuals, parse_expr(ANY));
+          while (peek() == ',') {
+            buf.next++;
+            actuals = flat_append(actuals, parse_expr(ANY));
+          }
+        }
+        expect(')');
+        return actuals;
+      }
+      
+      Case parse_branch()
+      {
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        expect(':');
+        Symbol type = take(TYPEID).symbol;
+        expect(DARROW);
+        Expression expr = parse_expr(ANY);
+        expect(';');
+        return node_at(at, branch(name, type, expr));
+      }
+      
+      Expression parse_let_body()
+      {
+        nested in(depth);
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        expect(':');
+        Symbol type = take(TYPEID).symbol;
+        Expression init = node_at(at, no_expr());
+        if (peek() == ASSIGN) {
+          buf.next++;
+          init = parse_expr(ANY);
+        }
+        if (peek() == IN) {
+          buf.next++;
+          return node_at(at, let(name, type, init, parse_expr(ANY)));
+        }
+        expect(',');
+        return node_at(at, let(name, type, init, parse_let_body()));
+      }
+      
+      /* An expression that is the operand of a rule of level rule. */
+      Expression parse_expr(int rule)
+      {
+        nested in(depth);
+        int at = line();
+        Expression e = parse_operand();
+        int assoc;
+        
+        for (int op; (op = level(peek(), assoc)) != 0; ) {
+          if (op < rule || (op == rule && assoc == LEFT))
+            break;
+          if (op == rule && assoc == NONASSOC)
+            throw give_up();
+          
+          int token = buf.tokens[buf.next++].token;
+          if (token == '.') {
+            Symbol name = take(OBJECTID).symbol;
+            e = node_at(at, dispatch(e, name, parse_actuals()));
+            continue;
+          }
+          if (token == '@') {
+            Symbol type = take(TYPEID).symbol;
+            expect('.');
+            Symbol name = take(OBJECTID).symbol;
+            e = node_at(at, static_dispatch(e, type, name, parse_actuals()));
+            continue;
+          }
+          
+          Expression rhs = parse_expr(op);
+          switch (token) {
+            case '+': e = plus(e, rhs);   break;
+            case '-': e = sub(e, rhs);    break;
+            case '*': e = mul(e, rhs);    break;
+            case '/': e = divide(e, rhs); break;
+            case '<': e = lt(e, rhs);     break;
+            case LE:  e = leq(e, rhs);    break;
+            case '=': e = eq(e, rhs);     break;
+          }
+          node_at(at, e);
+        }
+        return e;
+      }
+      
+      Expression parse_operand()
+      {
+        const buffered_token &t = next();
+        int at = t.line;
+        YYSTYPE value = t.value;
+        Expression e;
+        
+        switch (t.token) {
+          case OBJECTID:
+            buf.next++;
+            if (peek() == ASSIGN) {
+              buf.next++;
+              return node_at(at, assign(value.symbol, parse_expr(ASSIGN_LEVEL)));
+            }
+            if (peek() == '(') {
+              Expressions actuals = parse_actuals();
+              return node_at(at, dispatch(node_at(at, object(self_symbol())),
+                                          value.symbol, actuals));
+            }
+            return node_at(at, object(value.symbol));
+          case INT_CONST:
+            buf.next++;
+            return node_at(at, int_const(value.symbol));
+          case BOOL_CONST:
+            buf.next++;
+            return node_at(at, bool_const(value.boolean));
+          case STR_CONST:
+            buf.next++;
+            return node_at(at, string_const(value.symbol));
+          case NEW:
+            buf.next++;
+            return node_at(at, new_(take(TYPEID).symbol));
+          case '~':
+            buf.next++;
+            return node_at(at, neg(parse_expr(NEG_LEVEL)));
+          case ISVOID:
+            buf.next++;
+            return node_at(at, isvoid(parse_expr(ISVOID_LEVEL)));
+          case NOT:
+            buf.next++;
+            return node_at(at, comp(parse_expr(NOT_LEVEL)));
+          case '(':
+            buf.next++;
+            e = parse_expr(ANY);
+            expect(')');
+            return e;
+          case IF: {
+            buf.next++;
+            Expression pred = parse_expr(ANY);
+            expect(THEN);
+            Expression then_exp = parse_expr(ANY);
+            expect(ELSE);
+            Expression else_exp = parse_expr(ANY);
+            expect(FI);
+            return node_at(at, cond(pred, then_exp, else_exp));
+          }
+          case WHILE: {
+            buf.next++;
+            Expression pred = parse_expr(ANY);
+            expect(LOOP);
+            Expression body = parse_expr(ANY);
+            expect(POOL);
+            return node_at(at, loop(pred, body));
+          }
+          case '{': {
+            buf.next++;
+            flat_list<Expression> *body = flat_nil<Expression>();
+            do {
+              body = flat_append(body, parse_expr(ANY));
+              expect(';');
+            } while (peek() != '}');
+            buf.next++;
+            return node_at(at, block(body));
+          }
+          case CASE: {
+            buf.next++;
+            Expression expr = parse_expr(ANY);
+            expect(OF);
+            flat_list<Case> *cases = flat_nil<Case>();
+            do
+              cases = flat_append(cases, parse_branch());
+            while (peek() != ESAC);
+            buf.next++;
+            return node_at(at, typcase(expr, cases));
+          }
+          case LET:
+            buf.next++;
+            return parse_let_body();
+          default:
+            throw give_up();
+        }
+      }
+      
+    public:
+      descent_parser(parse_context *ctx)
+        : ctx(ctx), buf(ctx->replay), first_line(0), classes(NULL),
+          features(NULL), depth(0) { }
+      
+      /* program: false at a syntax error, or too deep a nesting */
+      bool parse()
+      {
+        try {
+          first_line = line();
+          classes = flat_nil<Class_>();
+          do {
+            forget(0);
+            Class_ c = parse_class();
+            classes = flat_append(classes, c);
+            ctx->parse_results = classes;
+            class_done(ctx, c);
+          } while (peek() != 0);
+          ctx->ast_root = node_at(first_line, program(classes));
+          return true;
+        } catch (give_up &) {
+          return false;
+        }
+      }
+      
+      /* The tokens of a lazy_body, up to the '}' or ';' after them: false
+         if they are not an expression, or too deeply nested. */
+      bool parse_body(Expression &body)
+      {
+        try {
+          body = parse_expr(ANY);
+          return buf.next + 2 == buf.tokens.size();
+        } catch (give_up &) {
+          return false;
+        }
+      }
+      
+      /* After parse() gave up inside a class: put the features done
+         before that in front of those the LALR parser gave c, the first
+         class it reduced, which it went on with from there. */
+      void complete(Class_ c)
+      {
+        if (features == NULL)
+          return;
+        Features &tail = static_cast<class__class *>(c)->*class_access::member();
+        for (int j = tail->first(); tail->more(j); j = tail->next(j))
+          features = flat_append(features, tail->nth(j));
+        tail = features;
+        features = NULL;
+      }
+      
+      /* After parse() gave up, and the LALR parser went on from the class
+         or feature it was in without errors: the whole program. */
+      void splice()
+      {
+        Classes rest = ctx->parse_results;
+        int i = rest->first();
+        
+        if (rest->more(i))
+          complete(rest->nth(i));
+        for (; rest->more(i); i = rest->next(i))
+          classes = flat_append(classes, rest->nth(i));
+        ctx->parse_results = classes;
+        ctx->ast_root = node_at(first_line, program(classes));
+      }
+    };
+    
+    /* The classes the LALR parser reduces go to ctx->on_class once the
+       first of them has been completed, so that none is seen short of
+       the features the hand written parser did. */
+    static int descent_parse(parse_context *ctx)
+    {
+      descent_parser parser(ctx);
+      
+      if (parser.parse()) {
+        ctx->replay = token_buffer();
+        return 0;
+      }
+      ctx->replay.next = 0;
+      ctx->ast_root = NULL;
+      ctx->parse_results = NULL;
+      std::function<void(Class_)> on_class = ctx->on_class;
+      if (on_class)
+        ctx->on_class = [&](Class_ c) {
+          parser.complete(c);
+          on_class(c);
+        };
+      int result = cool_yyparse(ctx);
+      ctx->on_class = on_class;
+      if (result == 0 && ctx->errors == 0)
+        parser.splice();
+      return result;
+    }
+    
+    /*
+     * lazy_body (see lazy-body.h).  Its tokens are copied into the arena of
+     * the tree it is part of, so that they go with it.
+     */
+    lazy_body::lazy_body(const buffered_token *from, size_t count, char *filename,
+                         const std::shared_ptr<diagnostics> &diag)
+      : count(count), filename(filename), diag(diag.get()),
+        arena(&node_arena::current()), expr(NULL), error_count(0)
+    {
+      size_t bytes = (count + 1) * sizeof(buffered_token);
+      
+      arena->keep(diag);      
+      tokens = (buffered_token *) arena->alloc_bytes(bytes, PHYLUM_EXPRESSION);
+      memcpy(tokens, from, count * sizeof(buffered_token));
+      tokens[count] = tokens[count - 1];
+      tokens[count].token = 0;
+    }
+    
+    Expression lazy_body::body()
+    {
+      if (expr == NULL) {
+        node_arena::scope in(arena);
+        expr = parse_tokens();
+      }
+      return expr;
+    }
+    
+    /* With the hand written parser, or, when it gives up, with the tables
+       and a class around the tokens, as the body of a method or attribute
+       as they were found in, so that errors are reported as in that. */
+    Expression lazy_body::parse_tokens()
+    {
+      parse_context part(NULL);
+      const buffered_token &end = tokens[count - 1];
+      Expression e;
+      
+      part.filename = filename;
+      if (diag != NULL)               /* which the parse does not own */
+        part.diag = std::shared_ptr<diagnostics>(diag, [](diagnostics *) { });
+      part.replay.tokens.assign(tokens, tokens + count + 1);
+      part.replay.next = 0;
+      descent_parser parser(&part);
+      if (parser.parse_body(e))
+        return e;
+      
+      YYSTYPE object, self, none = YYSTYPE();
+      object.symbol = object_symbol();
+      self.symbol = self_symbol();
+      std::vector<buffered_token> &wrapped = part.replay.tokens;
+      auto add = [&](int token, int line) {
+        buffered_token t = { token, line, none };
+        if (token == TYPEID)
+          t.value = object;
+        else if (token == OBJECTID)
+          t.value = self;
+        wrapped.push_back(t);
+      };
+      
+      bool method = end.token == '}';
+      const int method_head[] = { CLASS, TYPEID, '{', OBJECTID, '(', ')', ':',
+                                  TYPEID, '{' };
+      const int attr_head[] = { CLASS, TYPEID, '{', OBJECTID, ':', TYPEID, ASSIGN };
+      const int *head = method ? method_head : attr_head;
+      size_t head_size = method ? 9 : 7;
+      int at = tokens[0].line;
+      
+      wrapped.clear();
+      for (size_t i = 0; i < head_size; i++)
+        add(head[i], at);
+      wrapped.insert(wrapped.end(), tokens, tokens + count);
+      if (method)
+        add(';', end.line);
+      add('}', end.line);
+      add(';', end.line);
+      add(0, end.line);
+      part.replay.next = 0;
+      
+      if (cool_yyparse(&part) == 0 && part.errors == 0) {
+        Classes classes = part.parse_results;
+        class__class *c = static_cast<class__class *>(classes->nth(0));
+        Feature f = (c->*class_access::member())->nth(0);
+        if (method)
+          return static_cast<method_class *>(f)->*method_access::body();
+        return static_cast<attr_class *>(f)->*attr_access::body();
+      }
+      error_count = std::max(part.errors, 1);
+      return node_at(at, no_expr());
+    }
+    
+    /*
+     * push_parser.  What is pushed is what ctx->tokens would hold: for
+     * each file a "#name" line and a binary token stream.  A block is
+     * decoded once all of it has come and its tokens pushed into the
+     * tables straight away, so that a class is reduced, and given to
+     * ctx->on_class, as soon as the block with its last token is in.  If
+     * the header of the first stream has been read from ctx->tokens
+     * already, as stream_parse() does, the bytes pushed start at its
+     * first block.  A file sent as its tree from the parse cache has no
+     * tokens to push and is passed over.
+     */
+    push_parser::push_parser(parse_context *ctx)
+      : state(ctx->stream.started && !ctx->stream.done ? BLOCKS : NAME), ctx(ctx),
+        parser(cool_yypstate_new()), status(YYPUSH_MORE)
+    {
+    }
+    
+    push_parser::~push_parser()
+    {
+      cool_yypstate_delete(parser);
+    }
+    
+    bool push_parser::push(const char *bytes, size_t n)
+    {
+      if (status != YYPUSH_MORE)
+        return false;
+      if (input.empty()) {
+        size_t used = decode(bytes, n);
+        input.assign(bytes + used, bytes + n);
+      } else {
+        input.insert(input.end(), bytes, bytes + n);
+        input.erase(input.begin(), input.begin() + decode(input.data(), input.size()));
+      }
+      return status == YYPUSH_MORE;
+    }
+    
+    /* Returns what cool_yyparse() would have. */
+    int push_parser::finish()
+    {
+      if (status == YYPUSH_MORE) {
+        if (state == BLOCKS || (state == HEADER && !input.empty()))
+          stream_error("truncated binary token stream");
+        YYSTYPE none = YYSTYPE();
+        push_token(0, &none);
+      }
+      return status;
+    }
+    
+    /* The length of the block bytes starts with, or 0 if fewer than n. */
+    static size_t block_size(const char *bytes, size_t n)
+    {
+      const size_t word = sizeof(unsigned);
+      size_t at = word;
+      
+      if (n < at)
+        return 0;
+      for (unsigned nsyms = word_at(bytes, 0); nsyms > 0; nsyms--) {
+        if (at + 2 * word > n)
+          return 0;
+        at += 2 * word + word_at(bytes, at + word);
+      }
+      if (at + word > n)
+        return 0;
+      at += word + 3 * word * (size_t) word_at(bytes, at);
+      return at <= n ? at : 0;
+    }
+    
+    /* Decode and push what can be of bytes; returns how much that was. */
+    size_t push_parser::decode(const char *bytes, size_t n)
+    {
+      token_stream &stream = ctx->stream;
+      size_t at = 0;
+      
+      while (status == YYPUSH_MORE && at < n) {
+        const char *p = bytes + at;
+        
+        if (state == NAME) {
+          if (*p == '#') {
+            const char *end = (const char *) memchr(p, '\n', n - at);
+            if (end == NULL)
+              break;
+            set_name(ctx, std::string(p + 1, end));
+            at += end + 1 - p;
+          }
+          state = HEADER;
+        } else if (state == HEADER) {
+          if ((unsigned char) *p != (TOKEN_STREAM_MAGIC & 0xff))
+            stream_error("push_parser: not a binary token stream");
+          size_t size = header_size(p, n - at);
+          if (size == 0)
+            break;
+          buffer_source in = { p };
+          start_stream(ctx, in);
+          stream.binary = true;
+          at += size;
+          state = stream.cached ? NAME : BLOCKS;
+        } else {
+          size_t size = block_size(p, n - at);
+          if (size == 0)
+            break;
+          buffer_source in = { p };
+          read_block(ctx, in);
+          at += size;
+          if (stream.done)
+            state = NAME;
+          while (stream.next < stream.count && status == YYPUSH_MORE) {
+            YYSTYPE value;
+            stream.next++;
+            int token = stream_token(ctx, &value);
+            push_token(token, &value);
+          }
+        }
+      }
+      return at;
+    }
+    
+    /* As token_stream_lex() does for the pull parser. */
+    void push_parser::push_token(int token, YYSTYPE *value)
+    {
+      YYLTYPE line = ctx->lineno;
+      
+      ctx->last_token = token;
+      ctx->last_value = *value;
+      status = cool_yypush_parse(parser, token, value, &line, ctx);
+    }
+    
+    /* COOL_PARSER=stream: read a binary token stream with read(), as
+       much as the lexer has written each time, and push it. */
+    static int stream_parse(parse_context *ctx)
+    {
+      /* Unbuffered, ctx->tokens has read no further than start_file()
+         asked, and read() goes on from there. */
+      if (setvbuf(ctx->tokens, NULL, _IONBF, 0) != 0)
+        return cool_yyparse(ctx);
+      ctx->stream.started = true;
+      if (!start_file(ctx) || !ctx->stream.binary)
+        return cool_yyparse(ctx);
+      
+      push_parser parser(ctx);
+      std::vector<char> chunk(1 << 16);
+      ssize_t n;
+      while ((n = read(fileno(ctx->tokens), chunk.data(), chunk.size())) > 0)
+        if (!parser.push(chunk.data(), n))
+          break;
+      return parser.finish();
+    }
+    
+    static size_t parse_threads()
+    {
+      const char *threads = getenv("COOL_PARSE_THREADS");
+      
+      if (threads != NULL && atoi(threads) > 0)
+        return atoi(threads);
+      return std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    /* A piece of a program read by parallel_parse(): whole classes, the
+       file each of its tokens came from, and what parsing it alone gave. */
+    struct program_piece {
+      std::vector<buffered_token> tokens;
+      std::vector<std::pair<size_t, char *> > files;  /* first token, name */
+      int end_line;                   /* of its last token, or of the input */
+      parse_context part;
+      std::shared_ptr<node_arena> arena;
+      int status;
+      
+      program_piece() : end_line(0), part(NULL), status(0) { }
+    };
+    
+    /* Parse the tokens of pieces [first, last) as a whole program, each
+       token under the name of the file it came from, as the tables would
+       have read them from ctx->tokens. */
+    static int push_pieces(parse_context *ctx, program_piece *const *first,
+                           program_piece *const *last)
+    {
+      cool_yypstate *parser = cool_yypstate_new();
+      int status = YYPUSH_MORE;
+      
+      for (program_piece *const *p = first; p < last && status == YYPUSH_MORE; p++) {
+        const program_piece &piece = **p;
+        size_t file = 0;
+        for (size_t i = 0; i < piece.tokens.size() && status == YYPUSH_MORE; i++) {
+          if (file < piece.files.size() && piece.files[file].first == i) {
+            ctx->filename = piece.files[file++].second;
+            ctx->filename_sym = NULL;
+          }
+          buffered_token t = piece.tokens[i];
+          ctx->lineno = t.line;
+          ctx->last_token = t.token;
+          ctx->last_value = t.value;
+          status = cool_yypush_parse(parser, t.token, &t.value, &t.line, ctx);
+        }
+      }
+      if (status == YYPUSH_MORE) {
+        YYSTYPE none = YYSTYPE();
+        YYLTYPE line = first < last ? last[-1]->end_line : ctx->lineno;
+        ctx->lineno = line;
+        ctx->last_token = 0;
+        ctx->last_value = none;
+        status = cool_yypush_parse(parser, 0, &none, &line, ctx);
+      }
+      cool_yypstate_delete(parser);
+      return status;
+    }
+    
+    /*
+     * COOL_PARSER=parallel: read the program, cut it into pieces of whole
+     * classes at CLASS tokens outside any braces, and parse the pieces on
+     * parse_threads() threads as they are read, each on its own as a
+     * program, with no errors reported and into an arena of its own.  If
+     * none has errors, the program is all of them, which is what parsing
+     * it in one go gives: each piece is a class_list.  Otherwise the
+     * pieces before the first with errors are the start of the program,
+     * and the rest is parsed again in one go from there, so that its
+     * errors, and the recovery from them, come out as they would have;
+     * the tables are in the same state at the start of a class whatever
+     * classes came before.
+     */
+    static int parallel_parse(parse_context *ctx)
+    {
+      size_t threads = parse_threads();
+      if (threads == 1)
+        return cool_yyparse(ctx);
+      
+      /* A piece starts at a class and is at least size tokens long, for
+         about 4 pieces a thread; a binary stream takes 12 bytes a token,
+         a text one more. */
+      struct stat file;
+      size_t size = 4096;
+      if (fstat(fileno(ctx->tokens), &file) == 0 && S_ISREG(file.st_mode))
+        size = std::max<size_t>(file.st_size / 12 / (4 * threads), size);
+      
+      std::vector<std::unique_ptr<program_piece> > pieces;
+      std::mutex lock;                /* over pieces, next and read_all */
+      std::condition_variable ready;
+      size_t next = 0;
+      bool read_all = false;
+      auto work = [&]() {
+        for (;;) {
+          program_piece *piece;
+          {
+            std::unique_lock<std::mutex> hold(lock);
+            ready.wait(hold, [&]() { return next < pieces.size() || read_all; });
+            if (next == pieces.size())
+              return;
+            piece = pieces[next++].get();
+          }
+          piece->arena = std::make_shared<node_arena>();
+          node_arena::scope in(piece->arena.get());
+          piece->status = push_pieces(&piece->part, &piece, &piece + 1);
+        }
+      };
+      std::vector<std::thread> pool;
+      for (size_t t = 1; t < threads; t++)
+        pool.push_back(std::thread(work));
+      
+      /* Read on this thread, handing each piece over once it is cut. */
+      std::unique_ptr<program_piece> piece(new program_piece);
+      int nesting = 0;
+      for (;;) {
+        buffered_token t;
+        t.token = next_token(ctx, &t.value);
+        t.line = ctx->lineno;
+        if (t.token == 0)
+          break;
+        if (t.token == '{')
+          nesting++;
+        else if (t.token == '}')
+          nesting--;
+        else if (t.token == CLASS && nesting == 0 && piece->tokens.size() >= size) {
+          piece->end_line = piece->tokens.back().line;
+          std::lock_guard<std::mutex> hold(lock);
+          pieces.push_back(std::move(piece));
+          piece.reset(new program_piece);
+          ready.notify_one();
+        }
+        if (piece->files.empty() || piece->files.back().second != ctx->filename)
+          piece->files.push_back(std::make_pair(piece->tokens.size(), ctx->filename));
+        piece->tokens.push_back(t);
+      }
+      piece->end_line = ctx->lineno;
+      {
+        std::lock_guard<std::mutex> hold(lock);
+        pieces.push_back(std::move(piece));
+        read_all = true;
+      }
+      ready.notify_all();
+      work();
+      for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+      
+      flat_list<Class_> *classes = flat_nil<Class_>();
+      size_t done = 0;
+      for (; done < pieces.size() && pieces[done]->status == 0 &&
+             pieces[done]->part.errors == 0; done++) {
+        node_arena::current().adopt(*pieces[done]->arena);
+        Classes got = pieces[done]->part.parse_results;
+        for (int j = got->first(); got->more(j); j = got->next(j)) {
+          classes = flat_append(classes, got->nth(j));
+          class_done(ctx, got->nth(j));
+        }
+      }
+      if (done < pieces.size()) {
+        std::vector<program_piece *> rest;
+        for (size_t i = done; i < pieces.size(); i++)
+          rest.push_back(pieces[i].get());
+        int result = push_pieces(ctx, rest.data(), rest.data() + rest.size());
+        
+        Classes after = ctx->parse_results;
+        if (done > 0 && after != NULL) {
+          for (int j = after->first(); after->more(j); j = after->next(j))
+            classes = flat_append(classes, after->nth(j));
+          ctx->parse_results = classes;
+          ctx->ast_root = node_at(pieces[0]->part.ast_root->get_line_number(),
+                                  program(classes));
+        }
+        return result;
+      }
+      
+      ctx->filename = pieces.back()->files.back().second;
+      ctx->filename_sym = NULL;
+      ctx->parse_results = classes;
+      ctx->ast_root = node_at(pieces[0]->part.ast_root->get_line_number(), program(classes));
+      return 0;
+    }
+    
+    /* The stream of one file: its blocks, or the cache's entry for it,
+       which the lexer sent instead; end is where the stream ends in the
+       input of split_files(). */
+    struct file_tokens {
+      char *name;
+      bool keyed;
+      uint32_t key[4];
+      bool cached;
+      std::string lexer;
+      const char *bytes;
+      size_t size;
+      size_t end;
+    };
+    
+    /* Split input, the rest of ctx->tokens after start_file(), into the
+       streams of its files; false if it is not all binary streams. */
+    static bool split_files(parse_context *ctx, const std::vector<char> &input,
+                            std::vector<file_tokens> &files)
+    {
+      const char *bytes = input.data();
+      size_t n = input.size(), at = 0;
+      parse_context next(NULL);       /* for the headers after the first */
+      const parse_context *header = ctx;
+      
+      next.filename = ctx->filename;
+      for (;;) {
+        const token_stream &stream = header->stream;
+        file_tokens f = { header->filename, stream.keyed, { 0 }, stream.cached,
+                          stream.lexer, bytes + at, 0, 0 };
+        memcpy(f.key, stream.key, sizeof(f.key));
+        if (f.cached) {
+          /* The entry ends the header, read already; the first file's
+             went into ctx->stream. */
+          f.size = stream.entry.size();
+          f.bytes = header == ctx ? stream.entry.data() : bytes + at - f.size;
+        } else {
+          /* The blocks, up to the empty one, the only block of 2 words. */
+          size_t size;
+          do {
+            size = block_size(bytes + at, n - at);
+            if (size == 0)
+              return false;
+            at += size;
+          } while (size != 2 * sizeof(unsigned));
+          f.size = bytes + at - f.bytes;
+        }
+        f.end = at;
+        files.push_back(f);
+        if (at == n)
+          return true;
+        
+        if (bytes[at] == '#') {
+          const char *end = (const char *) memchr(bytes + at, '\n', n - at);
+          if (end == NULL)
+            return false;
+          set_name(&next, std::string(bytes + at + 1, end));
+          at = end + 1 - bytes;
+        }
+        size_t size = header_size(bytes + at, n - at);
+        if (size == 0)
+          return false;
+        buffer_source in = { bytes + at };
+        start_stream(&next, in);
+        at += size;
+        header = &next;
+      }
+    }
+    
+    /* Set ctx to read the blocks of f. */
+    static void begin_file(parse_context *ctx, const file_tokens &f)
+    {
+      token_stream &stream = ctx->stream;
+      
+      ctx->filename = f.name;
+      ctx->filename_sym = NULL;
+      stream.started = stream.binary = true;
+      stream.keyed = f.keyed;
+      stream.cached = false;
+      stream.symbols.clear();
+      stream.done = false;
+      stream.count = stream.next = 0;
+    }
+    
+    extern char **environ;
+    
+    /*
+     * Have the lexer that sent the entry of f, which this parser cannot
+     * use, lex its file again without the cache, and leave what it writes,
+     * a "#name" line and a token stream, in tokens; false if it could not
+     * be run.
+     */
+    static bool lex_again(const file_tokens &f, std::vector<char> &tokens)
+    {
+      std::vector<char *> env;
+      std::string format = "COOL_TOKEN_FORMAT=binary";
+      char *argv[] = { (char *) f.lexer.c_str(), f.name, NULL };
+      posix_spawn_file_actions_t actions;
+      int out[2], status;
+      pid_t pid;
+      
+      for (char **e = environ; *e != NULL; e++)
+        if (strncmp(*e, "COOL_PARSE_CACHE=", 17) != 0 &&
+            strncmp(*e, "COOL_TOKEN_FORMAT=", 18) != 0)
+          env.push_back(*e);
+      env.push_back(&format[0]);
+      env.push_back(NULL);
+      if (pipe(out) != 0)
+        return false;
+      posix_spawn_file_actions_init(&actions);
+      posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+      posix_spawn_file_actions_addclose(&actions, out[0]);
+      posix_spawn_file_actions_addclose(&actions, out[1]);
+      int failed = posix_spawn(&pid, argv[0], &actions, NULL, argv, env.data());
+      posix_spawn_file_actions_destroy(&actions);
+      close(out[1]);
+      
+      char chunk[1 << 16];
+      ssize_t got;
+      tokens.clear();
+      while (!failed && (got = read(out[0], chunk, sizeof(chunk))) > 0)
+        tokens.insert(tokens.end(), chunk, chunk + got);
+      close(out[0]);
+      return !failed && waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+        WEXITSTATUS(status) == 0 && !tokens.empty();
+    }
+    
+    /* Parse the n bytes of tokens at bytes into part: the blocks of a
+       file after begin_file(), or, with part->stream.started false, a
+       "#name" line and a whole stream.  A lazy parse reads them through
+       a FILE, as descent_parse() does. */
+    static int parse_file(parse_context *part, const char *bytes, size_t n)
+    {
+      if (part->lazy_bodies) {
+        FILE *in = fmemopen((void *) bytes, n, "r");
+        if (in == NULL)
+          stream_error("cannot read a token stream from memory");
+        part->tokens = in;
+        int result = descent_parse(part);
+        fclose(in);
+        part->tokens = NULL;
+        return result;
+      }
+      push_parser parser(part);
+      parser.push(bytes, n);
+      return parser.finish();
+    }
+    
+    /*
+     * COOL_PARSE_CACHE=dir (see parse-cache.h): load each file of a
+     * binary token stream the lexer sent the cache's entry for, and parse
+     * each other file on its own, storing its tree if it has a key.  An
+     * entry another build of the parser stored is a miss, and its file is
+     * lexed again.  A file with errors is not stored; it is parsed again
+     * with the files after it, as without the cache, so that its errors
+     * and the recovery from them are the same, the files after it that
+     * came from the cache being lexed again for their tokens.  The files
+     * before it cannot make a difference, each having ended a class, and
+     * their classes go in front of those of the rest.  A lazy parse is
+     * not stored, and reports the errors of each file as it goes.  A text
+     * stream is parsed as usual.
+     *
+     * With ctx->trees set, as cool_yyparse() does, the tree of each file
+     * is left there as a compact_tree instead of in ast_root, so that one
+     * loaded from the cache is dumped as it was loaded, and not expanded.
+     */
+    static int cached_parse(parse_context *ctx, parse_cache &cache)
+    {
+      ctx->stream.started = true;
+      if (!start_file(ctx) || !ctx->stream.binary)
+        return ctx->lazy_bodies ? descent_parse(ctx) : cool_yyparse(ctx);
+      
+      std::vector<char> input;
+      std::vector<file_tokens> files;
+      char chunk[1 << 16];
+      size_t got;
+      while ((got = fread(chunk, 1, sizeof(chunk), ctx->tokens)) > 0)
+        input.insert(input.end(), chunk, chunk + got);
+      
+      flat_list<Class_> *classes = flat_nil<Class_>();
+      int first_line = 0;
+      std::vector<char> again;        /* the tokens of a file lexed again */
+      size_t failed = split_files(ctx, input, files) ? files.size() : 0;
+      for (size_t i = 0; i < failed; i++) {
+        const file_tokens &f = files[i];
+        parse_context part(NULL);
+        compact_tree tree;
+        Program file;
+        
+        begin_file(&part, f);
+        part.lazy_bodies = ctx->lazy_bodies;
+        if (f.cached && cache.load(f.bytes, f.size, tree)) {
+          Symbol name = filename_symbol(&part);
+          if (ctx->trees != nullptr) {
+            tree.set_file(name);
+            ctx->trees->push_back(std::move(tree));
+            continue;
+          }
+          file = tree.expand();
+          Classes got = static_cast<program_class *>(file)->get_classes();
+          for (int j = got->first(); got->more(j); j = got->next(j)) {
+            static_cast<class__class *>(got->nth(j))->*class_access::file() = name;
+            class_done(ctx, got->nth(j));
+          }
+        } else {
+          const char *from = f.bytes;
+          size_t n = f.size;
+          if (f.cached) {
+            if (!lex_again(f, again))
+              stream_error("cannot run the lexer again for an old parse cache entry");
+            from = again.data();
+            n = again.size();
+            part.stream.started = false;
+          }
+          part.on_class = ctx->on_class;
+          if (part.lazy_bodies) {
+            part.diag = ctx->diag;
+            parse_file(&part, from, n);
+            ctx->errors += part.errors;
+            if (part.ast_root == NULL)
+              continue;
+          } else if (parse_file(&part, from, n) != 0 || part.errors != 0) {
+            failed = i;
+            break;
+          }
+          again.clear();
+          file = part.ast_root;
+          if ((f.keyed || ctx->trees != nullptr) && !part.lazy_bodies)
+            tree.build(file);
+          if (f.keyed && !part.lazy_bodies)
+            cache.store(f.key, tree);
+          if (ctx->trees != nullptr) {
+            ctx->trees->push_back(std::move(tree));
+            continue;
+          }
+        }
+        if (i == 0)
+          first_line = file->get_line_number();
+        Classes got = static_cast<program_class *>(file)->get_classes();
+        for (int j = got->first(); got->more(j); j = got->next(j))
+          classes = flat_append(classes, got->nth(j));
+      }
+      
+      if (failed < files.size() || files.empty()) {
+        /* The classes before the error have been handed over already. */
+        std::function<void(Class_)> on_class = ctx->on_class;
+        if (ctx->trees != nullptr) {
+          for (size_t i = 0; i < ctx->trees->size(); i++) {
+            Program file = (*ctx->trees)[i].expand();
+            Classes got = static_cast<program_class *>(file)->get_classes();
+            if (i == 0)
+              first_line = file->get_line_number();
+            for (int j = got->first(); got->more(j); j = got->next(j))
+              classes = flat_append(classes, got->nth(j));
+          }
+          ctx->trees->clear();
+        }
+        ctx->on_class = nullptr;
+        if (!files.empty()) {
+          begin_file(ctx, files[failed]);
+          ctx->stream.started = !files[failed].cached;
+        }
+        push_parser parser(ctx);
+        if (files.empty())
+          parser.push(input.data(), input.size());
+        for (size_t i = failed; i < files.size(); i++) {
+          const file_tokens &f = files[i];
+          if (f.cached) {
+            if (i > failed && !lex_again(f, again))
+              stream_error("cannot run the lexer again for a parse cache entry");
+            parser.push(again.data(), again.size());
+          } else if (i == failed)
+            parser.push(f.bytes, f.size);
+          else
+            parser.push(input.data() + files[i - 1].end, f.end - files[i - 1].end);
+        }
+        int result = parser.finish();
+        ctx->on_class = on_class;
+        
+        Classes rest = ctx->parse_results;
+        if (failed > 0 && rest != NULL) {
+          for (int j = rest->first(); rest->more(j); j = rest->next(j))
+            classes = flat_append(classes, rest->nth(j));
+          ctx->parse_results = classes;
+          ctx->ast_root = node_at(first_line, program(classes));
+        }
+        return result;
+      }
+      ctx->filename = files.back().name;
+      ctx->filename_sym = NULL;
+      if (ctx->trees == nullptr) {
+        ctx->parse_results = classes;
+        ctx->ast_root = node_at(first_line, program(classes));
+      }
+      return 0;
+    }
+    
+    /* With -v, how the cache did. */
+    static void print_cache_stats()
+    {
+      parse_cache *cache = shared_cache();
+      
+      if (verbose_flag && cache != NULL)
+        cerr << "parse cache: " << cache->hits << " hits, "
+             << cache->misses << " misses\n";
+    }
+    
+    /* Whether COOL_PARSER names backend. */
+    static bool parser_backend(const char *backend)
+    {
+      static const char *chosen = getenv("COOL_PARSER");
+      
+      return chosen != NULL && strcmp(chosen, backend) == 0;
+    }
+    
+    static int parse(parse_context *ctx)
+    {
+      if (shared_cache() != NULL)
+        return cached_parse(ctx, *shared_cache());
+      if (ctx->lazy_bodies)
+        return descent_parse(ctx);
+      if (parser_backend("descent"))
+        return descent_parse(ctx);
+      if (parser_backend("stream"))
+        return stream_parse(ctx);
+      if (parser_backend("parallel"))
+        return parallel_parse(ctx);
+      return cool_yyparse(ctx);
+    }
+    
+    /* COOL_AST_FORMAT=outline: parse with lazy bodies and print the
+       signatures of the program instead of its tree (see print_outline()). */
+    static bool outline_ast()
+    {
+      const char *format = getenv("COOL_AST_FORMAT");
+      
+      return format != NULL && strcmp(format, "outline") == 0;
+    }
+    
+    /*
+     * The outline of a program, for class hierarchies, method tables and
+     * editors: a line for each class, with its parent, and one for each of
+     * its features, with the types of a method's formals and result or
+     * the type of an attribute, each headed by file and line as errors
+     * are.  Only signatures are looked at, so the bodies of a lazy parse
+     * are never parsed, and errors in them are not found.
+     */
+    static void print_outline(Program tree, ostream &out)
+    {
+      Classes classes = static_cast<program_class *>(tree)->get_classes();
+      
+      for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+        class__class *c = static_cast<class__class *>(classes->nth(i));
+        Symbol file = c->*class_access::file();
+        Features features = c->*class_access::member();
+        
+        out << "\"" << file << "\", line " << c->get_line_number() << ": class "
+            << c->*class_access::class_name() << " inherits "
+            << c->*class_access::parent_name() << "\n";
+        for (int j = features->first(); features->more(j); j = features->next(j)) {
+          Feature f = features->nth(j);
+          out << "\"" << file << "\", line " << f->get_line_number() << ":   ";
+          if (method_class *m = dynamic_cast<method_class *>(f)) {
+            Formals formals = m->*method_access::formal_list();
+            out << "method " << m->*method_access::method_name() << "(";
+            for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
+              formal_class *x = static_cast<formal_class *>(formals->nth(k));
+              out << (k == formals->first() ? "" : ", ")
+                  << x->*formal_access::formal_name() << " : "
+                  << x->*formal_access::type();
+            }
+            out << ") : " << m->*method_access::result() << "\n";
+          } else {
+            attr_class *a = static_cast<attr_class *>(f);
+            out << "attr " << a->*attr_access::attr_name() << " : "
+                << a->*attr_access::type() << "\n";
+          }
+        }
+      }
+    }
+    
+    /*
+     * The text dump of each class, made as soon as the class is reduced
+     * (see class_done()) when COOL_PARSER=stream reads the tokens from a
+     * pipe, so that the dump of the first classes is done while the rest
+     * is still being read.  Other parses dump the program once it is
+     * done, straight to the driver's stream.  It is kept in a temporary file until the parse is over,
+     * since a program with errors is not dumped at all.
+     */
+    class dumped_classes {
+    public:
+      int count;
+      
+      dumped_classes() : count(0), text(tmpfile()) { }
+      ~dumped_classes()
+      {
+        if (text != NULL)
+          fclose(text);
+      }
+      
+      void add(Class_ c)
+      {
+        compact_tree compact;
+        std::ostringstream out;
+        
+        if (text == NULL)
+          return;
+        compact.build(program(flat_single(c)));
+        compact.dump(out);
+        /* all but the "#line" and "_program" of the program */
+        const std::string &dump = out.str();
+        size_t from = dump.find('\n', dump.find('\n') + 1) + 1;
+        fwrite(dump.data() + from, 1, dump.size() - from, text);
+        count++;
+      }
+      
+      /* Whether every dump made it into the file. */
+      bool kept()
+      {
+        return text != NULL && fflush(text) == 0 && !ferror(text);
+      }
+      
+      void copy(std::ostream &out)
+      {
+        char chunk[1 << 16];
+        size_t got;
+        
+        rewind(text);
+        while ((got = fread(chunk, 1, sizeof(chunk), text)) > 0)
+          out.write(chunk, got);
+      }
+      
+    private:
+      FILE *text;
+      
+      dumped_classes(const dumped_classes &);
+      dumped_classes &operator=(const dumped_classes &);
+    };
+    
+    /* What ast_root becomes, so that the dump_with_types() of the driver
+       goes through a compact_tree, which needs no C stack for deep trees,
+       and writes the outline with COOL_AST_FORMAT=outline.  The classes
+       already dumped as they were reduced are not dumped again.  Made
+       from the trees cached_parse() left, one per file, it dumps those,
+       and only builds the program from them if asked for anything else. */
+    class compact_program : public Program_class {
+    private:
+      Program tree;
+      std::shared_ptr<std::vector<compact_tree> > files;
+      std::shared_ptr<dumped_classes> dumped;
+      
+      Program whole()
+      {
+        if (tree == NULL) {
+          flat_list<Class_> *classes = flat_nil<Class_>();
+          for (size_t i = 0; i < files->size(); i++) {
+            Program file = (*files)[i].expand();
+            Classes got = static_cast<program_class *>(file)->get_classes();
+            for (int j = got->first(); got->more(j); j = got->next(j))
+              classes = flat_append(classes, got->nth(j));
+          }
+          tree = node_at((*files)[0].line((*files)[0].root), program(classes));
+        }
+        return tree;
+      }
+      
+    public:
+      compact_program(Program tree, std::shared_ptr<dumped_classes> dumped = nullptr)
+        : tree(tree), dumped(dumped) { }
+      compact_program(std::shared_ptr<std::vector<compact_tree> > files)
+        : tree(NULL), files(files) { }
+      Program copy_Program() { return new compact_program(whole()->copy_Program()); }
+      void dump(ostream& stream, int n) { whole()->dump(stream, n); }
+      void dump_with_types(ostream& stream, int)
+      {
+        if (outline_ast()) {
+          print_outline(whole(), stream);
+          return;
+        }
+        if (tree == NULL) {
+          const compact_tree &first = (*files)[0];
+          stream << "#" << first.line(first.root) << "\n_program\n";
+          for (size_t i = 0; i < files->size(); i++)
+            (*files)[i].dump(stream, false);
+          return;
+        }
+        Classes classes = static_cast<program_class *>(tree)->get_classes();
+        if (dumped != nullptr && dumped->count == classes->len() && dumped->kept()) {
+          stream << "#" << tree->get_line_number() << "\n_program\n";
+          dumped->copy(stream);
+          stream.flush();
+          return;
+        }
+        compact_tree compact;
+        compact.build(tree);
+        compact.dump(stream);
+      }
+      uint32_t compact(compact_tree &t) { return whole()->compact(t); }
+      uint32_t walk(tree_walk &t) { return whole()->walk(t); }
+    };
+    
+    /*
+     * The compiler's entry point: parse token_file, leaving the results in
+     * the globals at the top of the file as before.
+     */
+    /* COOL_ERROR_LIMIT: how many syntax errors a parse may have before it
+       stops, 50 by default. */
+    static size_t error_limit()
+    {
+      const char *limit = getenv("COOL_ERROR_LIMIT");
+      
+      if (limit != NULL && atoi(limit) > 0)
+        return atoi(limit);
+      return 50;
+    }
+    
+    int cool_yyparse()
+    {
+      parse_context ctx(token_file);
+      std::shared_ptr<dumped_classes> dumped;
+      ctx.diag = std::make_shared<diagnostics>(error_limit(), &cerr);
+      ctx.lazy_bodies = outline_ast();
+      struct stat st;
+      if (!ctx.lazy_bodies && parser_backend("stream") &&
+          fstat(fileno(token_file), &st) == 0 && S_ISFIFO(st.st_mode)) {
+        dumped = std::make_shared<dumped_classes>();
+        ctx.on_class = [dumped](Class_ c) { dumped->add(c); };
+      }
+      if (!ctx.lazy_bodies)
+        ctx.trees = std::make_shared<std::vector<compact_tree> >();
+      int result = parse(&ctx);
+      
+      if ((size_t) ctx.errors > ctx.diag->limit)
+        fprintf(stdout, "More than %zu errors\n", ctx.diag->limit);
+      ast_root = ctx.ast_root;
+      parse_results = ctx.parse_results;
+      omerrs += ctx.errors;
+      curr_filename = ctx.filename;
+      print_cache_stats();
+      if (ast_root != NULL)
+        ast_root = new compact_program(ast_root, dumped);
+      else if (result == 0 && ctx.errors == 0 && ctx.trees != nullptr &&
+               !ctx.trees->empty())
+        ast_root = new compact_program(ctx.trees);  /* parse_results stays NULL */
+      if (getenv("COOL_MEM_STATS") != NULL && ast_root != NULL) {
+        compact_tree compact;
+        compact.build(ast_root);
+        node_arena::current().print_stats(cerr);
+        cerr << "compact tree: " << compact.node_count() << " nodes, "
+             << compact.bytes() << " bytes\n";
+      }
+      return result;
+    }
+    
+    /*
+     * Parse several binary token streams at once, one per file, on up to
+     * parse_threads() threads.  results[i] is the context the stream in
+     * files[i] was parsed with, holding its tree, and its errors in a
+     * diagnostics of its own that writes them nowhere; each tree is
+     * allocated from the context's own arena and freed with it.  With
+     * lazy_bodies, the expressions of features are left to be parsed when
+     * asked for (see lazy-body.h).
+     */
+    void parse_token_files(const std::vector<FILE *> &files,
+                           std::vector<parse_context> &results,
+                           bool lazy_bodies)
+    {
+      std::atomic<size_t> next(0);
+      std::vector<std::thread> pool;
+      size_t threads = parse_threads();
+      
+      results.clear();
+      for (size_t i = 0; i < files.size(); i++) {
+        results.push_back(parse_context(files[i]));
+        results.back().arena = std::make_shared<node_arena>();
+        results.back().lazy_bodies = lazy_bodies;
+        results.back().diag = std::make_shared<diagnostics>(error_limit());
+      }
+      
+      auto work = [&]() {
+        for (size_t i; (i = next++) < files.size(); ) {
+          node_arena::scope in(results[i].arena.get());
+          parse(&results[i]);
+        }
+      };
+      for (size_t t = 1; t < std::min(threads, files.size()); t++)
+        pool.push_back(std::thread(work));
+      work();
+      for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+      print_cache_stats();
+    }
+    
+    /*
+     * compact_tree (see compact-tree.h).
+     */
+    compact_tree::compact_tree() : root(0)
+    {
+      symbols.push_back(NULL);
+    }
+    
+    compact_tree::ref compact_tree::add(kind k, int line, uint32_t f0,
+                                        uint32_t f1, uint32_t f2, uint32_t f3)
+    {
+      pool &p = pools[k];
+      uint32_t values[MAX_FIELDS] = { f0, f1, f2, f3 };
+      uint32_t row = p.line.size();
+      
+      if (row > row_of(~0u)) {
+        cerr << "compact_tree: too many nodes\n";
+        abort();
+      }
+      ref r = ((ref) k << (32 - KIND_BITS)) | row;
+      const char *f = fields(k);
+      p.line.push_back(line);
+      for (int i = 0; i < arity(k); i++) {
+        /* A subtree from put() goes here once build() has compacted it. */
+        if (k != KIND_LIST && f[i] == 'e' && values[i] != 0) {
+          pending[values[i] - 1].owner = r;
+          pending[values[i] - 1].slot = i;
+          values[i] = 0;
+        }
+        p.fields[i].push_back(values[i]);
+      }
+      if (is_expression(k))
+        p.type.push_back(0);
+      return r;
+    }
+    
+    /* With elems NULL the items are left 0, for set_child() to fill in. */
+    compact_tree::ref compact_tree::add_list(const ref *elems, size_t n)
+    {
+      ref list = add(KIND_LIST, 0, items.size(), n);
+      if (elems != NULL)
+        items.insert(items.end(), elems, elems + n);
+      else
+        items.resize(items.size() + n);
+      return list;
+    }
+    
+    uint32_t compact_tree::symbol_id(Symbol sym)
+    {
+      if (sym == NULL)
+        return 0;
+      std::pair<std::unordered_map<Symbol, uint32_t>::iterator, bool> in =
+        ids.insert(std::make_pair(sym, (uint32_t) symbols.size()));
+      if (in.second)
+        symbols.push_back(sym);
+      return in.first->second;
+    }
+    
+    size_t compact_tree::node_count() const
+    {
+      size_t n = 0;
+      for (int k = 0; k < KIND_LIST; k++)
+        n += pools[k].line.size();
+      return n;
+    }
+    
+    size_t compact_tree::bytes() const
+    {
+      size_t n = items.capacity() * sizeof(ref)
+        + symbols.capacity() * sizeof(Symbol)
+        + ids.size() * (sizeof(Symbol) + sizeof(uint32_t) + sizeof(void *))
+        + ids.bucket_count() * sizeof(void *);
+      for (int k = 0; k < KINDS; k++) {
+        n += (pools[k].line.capacity() + pools[k].type.capacity())
+          * sizeof(uint32_t);
+        for (int i = 0; i < MAX_FIELDS; i++)
+          n += pools[k].fields[i].capacity() * sizeof(uint32_t);
+      }
+      return n;
+    }
+    
+    /* Walking the subtrees of a node: next_child() gives the one from the
+       field (or list item) i on, if any, and steps i past it. */
+    bool compact_tree::next_child(ref r, uint32_t &i, ref &child) const
+    {
+      kind k = kind_of(r);
+      
+      if (k == KIND_LIST) {
+        if (i >= list_len(r))
+          return false;
+        child = list_nth(r, i++);
+        return true;
+      }
+      for (const char *f = fields(k); f[i] != '\0'; i++)
+        if (is_subtree(f[i])) {
+          child = field(r, i++);
+          return true;
+        }
+      return false;
+    }
+    
+    void compact_tree::set_child(ref r, uint32_t i, ref child)
+    {
+      if (kind_of(r) == KIND_LIST)
+        items[field(r, 0) + i] = child;
+      else
+        pools[kind_of(r)].fields[i][row_of(r)] = child;
+    }
+    
+    void compact_tree::build(Program program)
+    {
+      pending.clear();
+      root = program->compact(*this);
+      while (!pending.empty()) {
+        deferred d = pending.back();
+        pending.pop_back();
+        set_child(d.owner, d.slot, d.compact(d.node, *this));
+      }
+      
+      /* The tree is complete: give back what the columns grew past. */
+      pending.shrink_to_fit();
+      items.shrink_to_fit();
+      symbols.shrink_to_fit();
+      for (int k = 0; k < KINDS; k++) {
+        pools[k].line.shrink_to_fit();
+        pools[k].type.shrink_to_fit();
+        for (int i = 0; i < MAX_FIELDS; i++)
+          pools[k].fields[i].shrink_to_fit();
+      }
+    }
+    
+    /* The constructor classes, with their fields in the order of their
+       constructors' arguments, each given to t.put(): NODE for those of
+       the phyla above Expression, EXPRESSION for expressions. */
+    #define CONSTRUCTORS(NODE, EXPRESSION)                                   \
+      NODE(program, PROGRAM, t.put(classes))                                 \
+      NODE(class_, CLASS_, t.put(name), t.put(parent), t.put(features),      \
+           t.put(filename))                                                  \
+      NODE(method, METHOD, t.put(name), t.put(formals), t.put(return_type),  \
+           t.put(expr))                                                      \
+      NODE(attr, ATTR, t.put(name), t.put(type_decl), t.put(init))           \
+      NODE(formal, FORMAL, t.put(name), t.put(type_decl))                    \
+      NODE(branch, BRANCH, t.put(name), t.put(type_decl), t.put(expr))       \
+      EXPRESSION(assign, ASSIGN, t.put(name), t.put(expr))                   \
+      EXPRESSION(static_dispatch, STATIC_DISPATCH, t.put(expr),              \
+                 t.put(type_name), t.put(name), t.put(actual))               \
+      EXPRESSION(dispatch, DISPATCH, t.put(expr), t.put(name),               \
+                 t.put(actual))                                              \
+      EXPRESSION(cond, COND, t.put(pred), t.put(then_exp),                   \
+                 t.put(else_exp))                                            \
+      EXPRESSION(loop, LOOP, t.put(pred), t.put(body))                       \
+      EXPRESSION(typcase, TYPCASE, t.put(expr), t.put(cases))                \
+      EXPRESSION(block, BLOCK, t.put(body))                                  \
+      EXPRESSION(let, LET, t.put(identifier), t.put(type_decl),              \
+                 t.put(init), t.put(body))                                   \
+      EXPRESSION(plus, PLUS, t.put(e1), t.put(e2))                           \
+      EXPRESSION(sub, SUB, t.put(e1), t.put(e2))                             \
+      EXPRESSION(mul, MUL, t.put(e1), t.put(e2))                             \
+      EXPRESSION(divide, DIVIDE, t.put(e1), t.put(e2))                       \
+      EXPRESSION(neg, NEG, t.put(e1))                                        \
+      EXPRESSION(lt, LT, t.put(e1), t.put(e2))                               \
+      EXPRESSION(eq, EQ, t.put(e1), t.put(e2))                               \
+      EXPRESSION(leq, LEQ, t.put(e1), t.put(e2))                             \
+      EXPRESSION(comp, COMP, t.put(e1))                                      \
+      EXPRESSION(int_const, INT_CONST, t.put(token))                         \
+      EXPRESSION(bool_const, BOOL_CONST, t.put(val))                         \
+      EXPRESSION(string_const, STRING_CONST, t.put(token))                   \
+      EXPRESSION(new_, NEW_, t.put(type_name))                               \
+      EXPRESSION(isvoid, ISVOID, t.put(e1))                                  \
+      EXPRESSION(no_expr, NO_EXPR, 0)                                        \
+      EXPRESSION(object, OBJECT, t.put(name))
+    
+    /* Each constructor class adds itself, after its subtrees. */
+    #define COMPACT(cls, kind, ...)                                     \
+    uint32_t cls##_class::compact(compact_tree &t)                      \
+    {                                                                   \
+      return t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__); \
+    }
+    
+    #define COMPACT_EXPRESSION(cls, kind, ...)                          \
+    uint32_t cls##_class::compact(compact_tree &t)                      \
+    {                                                                   \
+      compact_tree::ref r =                                             \
+        t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__);     \
+      t.set_type(r, type);                                              \
+      return r;                                                         \
+    }
+    
+    CONSTRUCTORS(COMPACT, COMPACT_EXPRESSION)
+    
+    /* And for tree_walk, visits itself and leaves its subtrees to it. */
+    #define WALK(cls, kind, ...)                                        \
+    uint32_t cls##_class::walk(tree_walk &t)                            \
+    {                                                                   \
+      return t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__); \
+    }
+    
+    #define WALK_EXPRESSION(cls, kind, ...)                             \
+    uint32_t cls##_class::walk(tree_walk &t)                            \
+    {                                                                   \
+      return t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__) + \
+             t.put(type);                                               \
+    }
+    
+    CONSTRUCTORS(WALK, WALK_EXPRESSION)
+    
+    void tree_walk::run(Program program)
+    {
+      program->walk(*this);
+      while (!pending.empty()) {
+        step s = pending.back();
+        pending.pop_back();
+        s.second(s.first, *this);
+      }
+    }
+    
+    size_t compact_tree::walk(uint64_t &sum) const
+    {
+      std::vector<ref> stack(1, root);
+      size_t n = 0;
+      
+      sum = 0;
+      while (!stack.empty()) {
+        ref r = stack.back();
+        kind k = kind_of(r);
+        const char *f = fields(k);
+        
+        stack.pop_back();
+        n++;
+        sum += k + line(r);
+        for (int i = 0; f[i] != '\0'; i++) {
+          uint32_t v = field(r, i);
+          sum += v;
+          if (f[i] == 'e')
+            stack.push_back(v);
+          else if (f[i] == 'l')
+            for (size_t j = 0; j < list_len(v); j++)
+              stack.push_back(list_nth(v, j));
+        }
+        if (is_expression(k))
+          sum += pools[k].type[row_of(r)];
+      }
+      return n;
+    }
+    
+    /*
+     * Build the nodes back, each with the line of its row.  A node is
+     * built once its subtrees have been, from the top of values, where
+     * the subtrees of each field (the items of a list one by one) were
+     * left in order.
+     */
+    template <class Elem> static list_node<Elem> *expand_list(tree_node **elems,
+                                                              size_t n)
+    {
+      flat_list<Elem> *l = flat_nil<Elem>();
+      for (size_t i = 0; i < n; i++)
+        l = flat_append(l, static_cast<Elem>(elems[i]));
+      return l;
+    }
+    
+    Program compact_tree::expand()
+    {
+      struct frame { ref r; uint32_t next; };
+      std::vector<frame> stack;
+      std::vector<tree_node *> values;
+      frame top = { root, 0 };
+      
+      stack.push_back(top);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        ref child;
+        if (next_child(f.r, f.next, child)) {
+          frame c = { child, 0 };
+          stack.push_back(c);
+          continue;
+        }
+        ref r = f.r;
+        stack.pop_back();
+        if (kind_of(r) != KIND_LIST)
+          values.push_back(expand_node(r, values));
+      }
+      return static_cast<Program>(values.back());
+    }
+    
+    #define SYM(i)    symbol(field(r, i))
+    #define EXPR(i)   static_cast<Expression>(values[at[i]])
+    #define LIST(Elem, i) expand_list<Elem>(&values[at[i]], list_len(field(r, i)))
+    
+    /* Build the node of r, taking its subtrees off values. */
+    tree_node *compact_tree::expand_node(ref r, std::vector<tree_node *> &values)
+    {
+      kind k = kind_of(r);
+      const char *f = fields(k);
+      size_t at[MAX_FIELDS];
+      size_t n = 0;
+      
+      for (int i = 0; f[i] != '\0'; i++)
+        n += f[i] == 'e' ? 1 : f[i] == 'l' ? list_len(field(r, i)) : 0;
+      for (int i = 0, next = values.size() - n; f[i] != '\0'; i++) {
+        at[i] = next;
+        next += f[i] == 'e' ? 1 : f[i] == 'l' ? list_len(field(r, i)) : 0;
+      }
+      
+      tree_node *node = NULL;
+      Expression e = NULL;
+      switch (k) {
+        case KIND_PROGRAM:
+          node = program(LIST(Class_, 0));
+          break;
+        case KIND_CLASS_:
+          node = class_(SYM(0), SYM(1), LIST(Feature, 2), SYM(3));
+          break;
+        case KIND_METHOD:
+          node = method(SYM(0), LIST(Formal, 1), SYM(2), EXPR(3));
+          break;
+        case KIND_ATTR:
+          node = attr(SYM(0), SYM(1), EXPR(2));
+          break;
+        case KIND_FORMAL:
+          node = formal(SYM(0), SYM(1));
+          break;
+        case KIND_BRANCH:
+          node = branch(SYM(0), SYM(1), EXPR(2));
+          break;
+        case KIND_ASSIGN:
+          e = assign(SYM(0), EXPR(1));
+          break;
+        case KIND_STATIC_DISPATCH:
+          e = static_dispatch(EXPR(0), SYM(1), SYM(2), LIST(Expression, 3));
+          break;
+        case KIND_DISPATCH:
+          e = dispatch(EXPR(0), SYM(1), LIST(Expression, 2));
+          break;
+        case KIND_COND:
+          e = cond(EXPR(0), EXPR(1), EXPR(2));
+          break;
+        case KIND_LOOP:
+          e = loop(EXPR(0), EXPR(1));
+          break;
+        case KIND_TYPCASE:
+          e = typcase(EXPR(0), LIST(Case, 1));
+          break;
+        case KIND_BLOCK:
+          e = block(LIST(Expression, 0));
+          break;
+        case KIND_LET:
+          e = let(SYM(0), SYM(1), EXPR(2), EXPR(3));
+          break;
+        case KIND_PLUS:
+          e = plus(EXPR(0), EXPR(1));
+          break;
+        case KIND_SUB:
+          e = sub(EXPR(0), EXPR(1));
+          break;
+        case KIND_MUL:
+          e = mul(EXPR(0), EXPR(1));
+          break;
+        case KIND_DIVIDE:
+          e = divide(EXPR(0), EXPR(1));
+          break;
+        case KIND_NEG:
+          e = neg(EXPR(0));
+          break;
+        case KIND_LT:
+          e = lt(EXPR(0), EXPR(1));
+          break;
+        case KIND_EQ:
+          e = eq(EXPR(0), EXPR(1));
+          break;
+        case KIND_LEQ:
+          e = leq(EXPR(0), EXPR(1));
+          break;
+        case KIND_COMP:
+          e = comp(EXPR(0));
+          break;
+        case KIND_INT_CONST:
+          e = int_const(SYM(0));
+          break;
+        case KIND_BOOL_CONST:
+          e = bool_const(field(r, 0) != 0);
+          break;
+        case KIND_STRING_CONST:
+          e = string_const(SYM(0));
+          break;
+        case KIND_NEW_:
+          e = new_(SYM(0));
+          break;
+        case KIND_ISVOID:
+          e = isvoid(EXPR(0));
+          break;
+        case KIND_NO_EXPR:
+          e = no_expr();
+          break;
+        case KIND_OBJECT:
+          e = object(SYM(0));
+          break;
+        default:
+          assert(0);
+      }
+      values.resize(values.size() - n);
+      if (e != NULL) {
+        e->set_type(type(r));
+        node = e;
+      }
+      return node_at(line(r), node);
+    }
+    
+    #undef SYM
+    #undef EXPR
+    #undef LIST
+    
+    void compact_tree::write(std::ostream &out) const
+    {
+      std::vector<uint32_t> records;
+      std::vector<uint32_t> tables(symbols.size(), AST_SYM_NONE);
+      std::vector<uint32_t> header;
+      std::string text;
+      
+      struct frame { ref r; size_t at; uint32_t next; };
+      std::vector<frame> stack;
+      frame first = { root, 0, 0 };
+      
+      write_record(root, records, tables);
+      stack.push_back(first);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        ref child;
+        if (next_child(f.r, f.next, child)) {
+          frame c = { child, records.size(), 0 };
+          write_record(child, records, tables);
+          stack.push_back(c);
+        } else {
+          records[f.at + 2] = records.size() - f.at;
+          stack.pop_back();
+        }
+      }
+      for (size_t id = 0; id < symbols.size(); id++) {
+        header.push_back(tables[id]);
+        header.push_back(id == 0 ? 0 : symbols[id]->get_len());
+        header.push_back(text.size());
+        if (id != 0)
+          text.append(symbols[id]->get_string(), symbols[id]->get_len());
+        text.push_back('\0');
+      }
+      
+      uint32_t top[5] = { AST_IMAGE_MAGIC, AST_IMAGE_VERSION,
+                          (uint32_t) symbols.size(), (uint32_t) text.size(),
+                          (uint32_t) records.size() };
+      text.resize((text.size() + 3) / 4 * 4, '\0');
+      out.write((const char *) top, sizeof(top));
+      out.write((const char *) header.data(), header.size() * 4);
+      out.write(text.data(), text.size());
+      out.write((const char *) records.data(), records.size() * 4);
+      out.flush();
+    }
+    
+    /* Append the record of r to out, noting in tables which table each
+       of its symbols goes back to.  write() fills in its size. */
+    void compact_tree::write_record(ref r, std::vector<uint32_t> &out,
+                                    std::vector<uint32_t> &tables) const
+    {
+      kind k = kind_of(r);
+      const char *f = fields(k);
+      size_t at = out.size();
+      
+      out.push_back(k);
+      out.push_back(line(r));
+      out.push_back(0);
+      if (is_expression(k)) {
+        uint32_t t = pools[k].type[row_of(r)];
+        if (t != 0)
+          tables[t] = AST_SYM_ID;
+        out.push_back(t);
+      }
+      if (k == KIND_LIST)
+        out.push_back(list_len(r));
+      for (int i = 0; f[i] != '\0'; i++) {
+        if (is_subtree(f[i]))
+          continue;
+        uint32_t v = field(r, i);
+        if (f[i] != 'b' && v != 0)
+          tables[v] = f[i] == 'n' ? AST_SYM_INT :
+                      f[i] == 's' ? AST_SYM_STR : AST_SYM_ID;
+        out.push_back(v);
+      }
+      out[at] |= (out.size() - at) << 8;
+    }
+    
+    void compact_tree::set_file(Symbol file)
+    {
+      std::vector<uint32_t> &names = pools[KIND_CLASS_].fields[3];
+      std::fill(names.begin(), names.end(), symbol_id(file));
+    }
+    
+    /* Replace this tree with the one in image, interning its symbols. */
+    void compact_tree::load(const ast_image &image)
+    {
+      std::vector<uint32_t> ids(image.symbol_count(), 0);
+      struct frame { uint32_t child; ref r; uint32_t next; };
+      std::vector<frame> stack;
+      
+      *this = compact_tree();
+      for (uint32_t id = 1; id < image.symbol_count(); id++) {
+        char *s = (char *) image.symbol_text(id);
+        int len = image.symbol_len(id);
+        Symbol sym;
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        switch (image.symbol_table(id)) {
+          case AST_SYM_INT: sym = inttable.add_string(s, len); break;
+          case AST_SYM_STR: sym = stringtable.add_string(s, len); break;
+          default:          sym = idtable.add_string(s, len); break;
+        }
+        ids[id] = symbol_id(sym);
+      }
+      
+      /* Each record is added before its subtrees, which are set in it as
+         they are added in turn. */
+      root = load_record(image, image.root(), ids);
+      frame top = { image.first_child(image.root()), root, 0 };
+      stack.push_back(top);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        ref child;
+        if (!next_child(f.r, f.next, child)) {
+          stack.pop_back();
+          continue;
+        }
+        uint32_t node = f.child;
+        f.child = image.next_sibling(node);
+        child = load_record(image, node, ids);
+        set_child(f.r, f.next - 1, child);
+        frame c = { image.first_child(node), child, 0 };
+        stack.push_back(c);
+      }
+    }
+    
+    /* Add the record at node, with its subtrees left 0. */
+    compact_tree::ref compact_tree::load_record(const ast_image &image,
+                                                uint32_t node,
+                                                const std::vector<uint32_t> &ids)
+    {
+      kind k = image.kind(node);
+      
+      if (k == KIND_LIST)
+        return add_list(NULL, image.list_len(node));
+      
+      const char *f = fields(k);
+      uint32_t values[MAX_FIELDS] = { 0, 0, 0, 0 };
+      for (int i = 0, scalar = 0; f[i] != '\0'; i++) {
+        if (!is_subtree(f[i])) {
+          uint32_t v = image.field(node, scalar++);
+          values[i] = f[i] == 'b' ? v : ids[v];
+        }
+      }
+      ref r = add(k, image.line(node), values[0], values[1], values[2], values[3]);
+      if (is_expression(k))
+        pools[k].type[row_of(r)] = ids[image.type(node)];
+      return r;
+    }
+    
+    /* What dump_with_types() prints for each constructor. */
+    static const char *const dump_tags[compact_tree::KIND_LIST] = {
+      "_program", "_class", "_method", "_attr", "_formal", "_branch",
+      "_assign", "_static_dispatch", "_dispatch", "_cond", "_loop",
+      "_typcase", "_block", "_let", "_plus", "_sub", "_mul", "_divide",
+      "_neg", "_lt", "_eq", "_leq", "_comp", "_int", "_bool", "_string",
+      "_new", "_isvoid", "_no_expr", "_object"
+    };
+    
+    /* The text of dump(), gathered a chunk at a time and written out
+       with one call, rather than an ostream << for every word. */
+    class dump_text {
+    public:
+      dump_text(std::ostream &out) : out(out) { }
+      ~dump_text() { flush(); }
+      
+      dump_text &operator<<(const char *s) { text += s; return more(); }
+      dump_text &operator<<(Symbol sym) { return *this << sym->get_string(); }
+      dump_text &operator<<(int n) { text += std::to_string(n); return more(); }
+      dump_text &escaped(Symbol sym)
+      {
+        escape.str("");
+        print_escaped_string(escape, sym->get_string());
+        text += escape.str();
+        return more();
+      }
+      void flush()
+      {
+        out.write(text.data(), text.size());
+        text.clear();
+        out.flush();
+      }
+      
+    private:
+      std::ostream &out;
+      std::string text;
+      std::ostringstream escape;
+      
+      dump_text &more()
+      {
+        if (text.size() >= 1 << 16) {
+          out.write(text.data(), text.size());
+          text.clear();
+        }
+        return *this;
+      }
+    };
+    
+    /*
+     * Write the text dump_with_types() writes for the tree.  The fields of
+     * a node are printed in order, each scalar as it comes and each subtree
+     * or list pushed on the stack, except that a class prints its filename
+     * ahead of its features.  The features of a class and the actuals of a
+     * dispatch are printed between parentheses.
+     */
+    void compact_tree::dump(std::ostream &stream, bool whole) const
+    {
+      struct frame { ref r; int n; uint32_t next; bool parens; };
+      std::vector<frame> stack;
+      frame top = { root, 0, 0, false };
+      dump_text out(stream);
+      
+      if (whole)
+        out << "#" << line(root) << "\n" << dump_tags[KIND_PROGRAM] << "\n";
+      stack.push_back(top);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        kind k = kind_of(f.r);
+        int n = f.n;
+        
+        if (k == KIND_LIST) {
+          if (f.next < list_len(f.r)) {
+            frame c = { list_nth(f.r, f.next++), n, 0, false };
+            out << pad(n) << "#" << line(c.r) << "\n"
+                << pad(n) << dump_tags[kind_of(c.r)] << "\n";
+            stack.push_back(c);
+          } else {
+            if (f.parens)
+              out << pad(n) << ")\n";
+            stack.pop_back();
+          }
+          continue;
+        }
+        
+        const char *fs = fields(k);
+        uint32_t i = f.next;
+        for (; fs[i] != '\0' && !is_subtree(fs[i]); i++) {
+          uint32_t v = field(f.r, i);
+          if (k == KIND_CLASS_ && i == 3)
+            continue;
+          if (fs[i] == 'b')
+            out << pad(n + 2) << (v ? "1" : "0") << "\n";
+          else if (fs[i] == 's') {
+            out << pad(n + 2) << "\"";
+            out.escaped(symbol(v)) << "\"\n";
+          } else
+            out << pad(n + 2) << symbol(v) << "\n";
+        }
+        if (fs[i] == '\0') {
+          if (is_expression(k)) {
+            if (type(f.r) != NULL)
+              out << pad(n) << ": " << type(f.r) << "\n";
+            else
+              out << pad(n) << ": _no_type\n";
+          }
+          stack.pop_back();
+          continue;
+        }
+        
+        f.next = i + 1;
+        frame c = { field(f.r, i), n + 2, 0, false };
+        if (fs[i] == 'l') {
+          c.parens = k == KIND_CLASS_ || k == KIND_DISPATCH ||
+                     k == KIND_STATIC_DISPATCH;
+          if (k == KIND_CLASS_) {
+            out << pad(n + 2) << "\"";
+            out.escaped(symbol(field(f.r, 3))) << "\"\n";
+          }
+          if (c.parens)
+            out << pad(n + 2) << "(\n";
+        } else
+          out << pad(c.n) << "#" << line(c.r) << "\n"
+              << pad(c.n) << dump_tags[kind_of(c.r)] << "\n";
+        stack.push_back(c);
+      }
+    }
@@ -5,6 +5,12 @@
 #define COOL_TREE_HANDCODE_H
 
 #include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <vector>
 #include "tree.h"
 #include "cool.h"
 #include "stringtab.h"
@@ -20,6 +26,203 @@ void dump_Symbol(ostream& stream, int padding, Symbol b);
 void assert_Symbol(Symbol b);
 Symbol copy_Symbol(Symbol b);
 
+class compact_tree;		/* see compact-tree.h */
+class tree_walk;
+
+/*
+ * Tree nodes are never freed one at a time, so every phylum allocates
+ * them (through the operator new of NODE_ALLOC below, which the
+ * constructors in cool-tree.cc pick up) from a node_arena: chunks that
+ * grow as they fill, released together when the arena goes away.  Each
+ * thread allocates from the arena installed with node_arena::scope, or
+ * else from one of its own that lasts until the thread exits, so one
+ * compilation can give its tree an arena and drop the whole tree at
+ * once.  COOL_AST_ALLOC=malloc sends every node to operator new
+ * instead, for comparison; the byte counts per phylum are kept either
+ * way and printed by print_stats().  Nodes have no destructors, so what
+ * a node points to outside the arena is kept alive with keep().
+ */
+enum node_phylum {
+	PHYLUM_PROGRAM, PHYLUM_CLASS, PHYLUM_FEATURE, PHYLUM_FORMAL,
+	PHYLUM_EXPRESSION, PHYLUM_CASE, PHYLUM_LIST, PHYLUMS
+};
+
+class node_arena {
+private:
+	enum { FIRST_CHUNK = 64 << 10, MAX_CHUNK = 4 << 20 };
+
+	char *next;			/* free space in the current chunk */
+	char *end;
+	char *chunks;			/* each starts with the previous one */
+	size_t chunk_size;
+	size_t reserved;		/* bytes in all chunks */
+	size_t nodes[PHYLUMS];
+	size_t bytes[PHYLUMS];
+	std::vector<std::shared_ptr<void> > kept;
+
+	node_arena(const node_arena &);
+	node_arena &operator=(const node_arena &);
+
+	static bool use_malloc() {
+		static const char *mode = getenv("COOL_AST_ALLOC");
+		static bool malloc_only = mode != NULL && strcmp(mode, "malloc") == 0;
+		return malloc_only;
+	}
+
+	static node_arena *&installed() {
+		static thread_local node_arena *arena = NULL;
+		return arena;
+	}
+
+	/* Chunks start with the link to the next one, padded so that what
+	   follows is aligned. */
+	void *grow(size_t size) {
+		const size_t header = sizeof(max_align_t);
+		if (size + header > chunk_size && chunks != NULL) {
+			/* Too big for a chunk: it gets one of its own, linked
+			   behind the current one, which keeps its free space. */
+			char *chunk = (char *) malloc(size + header);
+			if (chunk == NULL)
+				abort();
+			*(char **) chunk = *(char **) chunks;
+			*(char **) chunks = chunk;
+			reserved += size + header;
+			return chunk + header;
+		}
+		size_t n = chunk_size;
+		while (n < size + header)
+			n *= 2;
+		char *chunk = (char *) malloc(n);
+		if (chunk == NULL)
+			abort();
+		*(char **) chunk = chunks;
+		chunks = chunk;
+		reserved += n;
+		if (chunk_size < MAX_CHUNK)
+			chunk_size *= 2;
+		next = chunk + header;
+		end = chunk + n;
+		char *p = next;
+		next += size;
+		return p;
+	}
+
+public:
+	node_arena() : next(NULL), end(NULL), chunks(NULL),
+		       chunk_size(FIRST_CHUNK), reserved(0) {
+		memset(nodes, 0, sizeof(nodes));
+		memset(bytes, 0, sizeof(bytes));
+	}
+	~node_arena() { release(); }
+
+	/* Storage for something other than a node, such as a list's array. */
+	void *alloc_bytes(size_t size, node_phylum phylum) {
+		size = (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+		bytes[phylum] += size;
+		if (use_malloc())
+			return ::operator new(size);
+		if ((size_t) (end - next) < size)
+			return grow(size);
+		char *p = next;
+		next += size;
+		return p;
+	}
+
+	void *alloc(size_t size, node_phylum phylum) {
+		nodes[phylum]++;
+		return alloc_bytes(size, phylum);
+	}
+
+	/* Free every node allocated from this arena at once. */
+	void release() {
+		while (chunks != NULL) {
+			char *prev = *(char **) chunks;
+			free(chunks);
+			chunks = prev;
+		}
+		next = end = NULL;
+		reserved = 0;
+		chunk_size = FIRST_CHUNK;
+		kept.clear();
+	}
+
+	/* Hold on to p for as long as the nodes. */
+	void keep(const std::shared_ptr<void> &p) {
+		if (p != nullptr && (kept.empty() || kept.back() != p))
+			kept.push_back(p);
+	}
+
+	/* Take over the nodes of other, which is left empty, so that they
+	   are released with this arena's. */
+	void adopt(node_arena &other) {
+		if (other.chunks != NULL) {
+			char *last = other.chunks;
+			while (*(char **) last != NULL)
+				last = *(char **) last;
+			*(char **) last = chunks;
+			chunks = other.chunks;
+		}
+		for (int i = 0; i < PHYLUMS; i++) {
+			nodes[i] += other.nodes[i];
+			bytes[i] += other.bytes[i];
+			other.nodes[i] = other.bytes[i] = 0;
+		}
+		reserved += other.reserved;
+		kept.insert(kept.end(), other.kept.begin(), other.kept.end());
+		other.kept.clear();
+		other.chunks = other.next = other.end = NULL;
+		other.reserved = 0;
+	}
+
+	/* Bytes of nodes and lists, over all phyla. */
+	size_t used() const {
+		size_t total = 0;
+
+		for (int i = 0; i < PHYLUMS; i++)
+			total += bytes[i];
+		return total;
+	}
+
+	void print_stats(ostream& stream) const {
+		static const char *names[PHYLUMS] = {
+			"Program", "Class_", "Feature", "Formal",
+			"Expression", "Case", "lists"
+		};
+		size_t total_nodes = 0, total_bytes = 0;
+
+		stream << "tree memory (" << (use_malloc() ? "malloc" : "arena") << "):\n";
+		for (int i = 0; i < PHYLUMS; i++) {
+			stream << "  " << names[i] << ": " << nodes[i] << " nodes, "
+			       << bytes[i] << " bytes\n";
+			total_nodes += nodes[i];
+			total_bytes += bytes[i];
+		}
+		stream << "  total: " << total_nodes << " nodes, " << total_bytes
+		       << " bytes, " << reserved << " bytes in arena chunks\n";
+	}
+
+	/* The arena this thread allocates nodes from. */
+	static node_arena &current() {
+		static thread_local node_arena own;
+		node_arena *arena = installed();
+		return arena != NULL ? *arena : own;
+	}
+
+	/* Allocate this thread's nodes from arena while in scope. */
+	class scope {
+	private:
+		node_arena *saved;
+	public:
+		scope(node_arena *arena) : saved(installed()) { installed() = arena; }
+		~scope() { installed() = saved; }
+	};
+};
+
+#define NODE_ALLOC(phylum)                                          \
+static void *operator new(size_t size)                              \
+	{ return node_arena::current().alloc(size, phylum); }      \
+static void operator delete(void *) { }
+
 class Program_class;
 typedef Program_class *Program;
 class Class__class;
@@ -44,63 +247,168 @@ typedef Expressions_class *Expressions;
 typedef list_node<Case> Cases_class;
 typedef Cases_class *Cases;
 
+/*
+ * The lists the parser builds.  append_Classes() and friends chain
+ * append_nodes, whose len() and nth() walk the chain, so going through
+ * a long list that way takes time quadratic in its length.  A flat_list
+ * keeps its elements in one array instead, taken like the nodes from the
+ * current node_arena and doubled when full; it is a list_node, so
+ * whatever walks lists with first()/more()/next()/nth() is unchanged and
+ * now takes constant time per element.
+ */
+template <class Elem> class flat_list : public list_node<Elem> {
+private:
+	Elem *elems;
+	int count;
+	int capacity;
+
+public:
+	flat_list() : elems(NULL), count(0), capacity(0) { }
+
+	NODE_ALLOC(PHYLUM_LIST)
+
+	list_node<Elem> *copy_list() {
+		flat_list<Elem> *l = new flat_list<Elem>();
+		for (int i = 0; i < count; i++)
+			l->push(static_cast<Elem>(elems[i]->copy()));
+		return l;
+	}
+	int len() { return count; }
+	Elem nth_length(int n, int &len) {
+		len = count;
+		return n < count ? elems[n] : NULL;
+	}
+	void dump(ostream& stream, int n) {
+		if (count == 0) {
+			stream << pad(n) << "(nil)\n";
+			return;
+		}
+		stream << pad(n) << "list\n";
+		for (int i = 0; i < count; i++)
+			elems[i]->dump(stream, n + 2);
+		stream << pad(n) << "(end_of_list)\n";
+	}
+
+	void push(Elem e) {
+		if (count == capacity) {
+			capacity = capacity == 0 ? 4 : capacity * 2;
+			Elem *grown = (Elem *) node_arena::current().alloc_bytes(
+				capacity * sizeof(Elem), PHYLUM_LIST);
+			if (count > 0)
+				memcpy(grown, elems, count * sizeof(Elem));
+			elems = grown;
+		}
+		elems[count++] = e;
+	}
+};
+
+/* An empty list, a list of one element, and l with e added at the end. */
+template <class Elem> inline flat_list<Elem> *flat_nil()
+{
+	return new flat_list<Elem>();
+}
+
+template <class Elem> inline flat_list<Elem> *flat_single(Elem e)
+{
+	flat_list<Elem> *l = new flat_list<Elem>();
+	l->push(e);
+	return l;
+}
+
+template <class Elem> inline flat_list<Elem> *flat_append(flat_list<Elem> *l, Elem e)
+{
+	l->push(e);
+	return l;
+}
+
 #define Program_EXTRAS                          \
-virtual void dump_with_types(ostream&, int) = 0; 
+NODE_ALLOC(PHYLUM_PROGRAM)                      \
+virtual void dump_with_types(ostream&, int) = 0; \
+virtual uint32_t compact(compact_tree&) = 0;    \
+virtual uint32_t walk(tree_walk&) = 0;
 
 
 
 #define program_EXTRAS                          \
-void dump_with_types(ostream&, int);            
+Classes get_classes() { return classes; }       \
+void dump_with_types(ostream&, int);            \
+uint32_t compact(compact_tree&);                \
+uint32_t walk(tree_walk&);
 
 #define Class__EXTRAS                   \
+NODE_ALLOC(PHYLUM_CLASS)                \
 virtual Symbol get_filename() = 0;      \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual void dump_with_types(ostream&,int) = 0; \
+virtual uint32_t compact(compact_tree&) = 0; \
+virtual uint32_t walk(tree_walk&) = 0;
 
 
 #define class__EXTRAS                                 \
 Symbol get_filename() { return filename; }             \
-void dump_with_types(ostream&,int);                    
+void dump_with_types(ostream&,int);                   \
+uint32_t compact(compact_tree&);                      \
+uint32_t walk(tree_walk&);
 
 
 #define Feature_EXTRAS                                        \
-virtual void dump_with_types(ostream&,int) = 0; 
+NODE_ALLOC(PHYLUM_FEATURE)                                    \
+virtual void dump_with_types(ostream&,int) = 0;               \
+virtual uint32_t compact(compact_tree&) = 0;                  \
+virtual uint32_t walk(tree_walk&) = 0;
 
 
 #define Feature_SHARED_EXTRAS                                       \
-void dump_with_types(ostream&,int);    
+void dump_with_types(ostream&,int);                                 \
+uint32_t compact(compact_tree&);                                    \
+uint32_t walk(tree_walk&);
 
 
 
 
 
 #define Formal_EXTRAS                              \
-virtual void dump_with_types(ostream&,int) = 0;
+NODE_ALLOC(PHYLUM_FORMAL)                          \
+virtual void dump_with_types(ostream&,int) = 0;    \
+virtual uint32_t compact(compact_tree&) = 0;       \
+virtual uint32_t walk(tree_walk&) = 0;
 
 
 #define formal_EXTRAS                           \
-void dump_with_types(ostream&,int);
+void dump_with_types(ostream&,int);             \
+uint32_t compact(compact_tree&);                \
+uint32_t walk(tree_walk&);
 
 
 #define Case_EXTRAS                             \
-virtual void dump_with_types(ostream& ,int) = 0;
+NODE_ALLOC(PHYLUM_CASE)                         \
+virtual void dump_with_types(ostream& ,int) = 0; \
+virtual uint32_t compact(compact_tree&) = 0;    \
+virtual uint32_t walk(tree_walk&) = 0;
 
 
 #define branch_EXTRAS                                   \
-void dump_with_types(ostream& ,int);
+void dump_with_types(ostream& ,int);                    \
+uint32_t compact(compact_tree&);                        \
+uint32_t walk(tree_walk&);
 
 
 #define Expression_EXTRAS                    \
+NODE_ALLOC(PHYLUM_EXPRESSION)                \
 Symbol type;                                 \
 Symbol get_type() { return type; }           \
 Expression set_type(Symbol s) { type = s; return this; } \
 virtual void dump_with_types(ostream&,int) = 0;  \
+virtual uint32_t compact(compact_tree&) = 0; \
+virtual uint32_t walk(tree_walk&) = 0;       \
 void dump_type(ostream&, int);               \
 Expression_class() { type = (Symbol) NULL; }
 
 
 
 #define Expression_SHARED_EXTRAS           \
-void dump_with_types(ostream&,int); 
+void dump_with_types(ostream&,int);        \
+uint32_t compact(compact_tree&);           \
+uint32_t walk(tree_walk&);
 
 
 #endif
@@ -1,23 +1,22 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* A Bison parser, made by GNU Bison 2.4.1.  */
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
-   
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -28,46 +27,85 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_COOL_YY_COOL_TAB_H_INCLUDED
+# define YY_COOL_YY_COOL_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 1
+#endif
+#if YYDEBUG
+extern int cool_yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 149 "cool.y"
 
-/* Tokens.  */
+      #include <stdio.h>
+      #include <stdint.h>
+      #include <functional>
+      #include <memory>
+      #include <string>
+      #include <vector>
+      #ifndef YYLTYPE
+      #define YYLTYPE int
+      #endif
+      struct parse_context;
+      class diagnostics;
+      class compact_tree;
+    
+
+#line 65 "cool.tab.h"
+
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     CLASS = 258,
-     ELSE = 259,
-     FI = 260,
-     IF = 261,
-     IN = 262,
-     INHERITS = 263,
-     LET = 264,
-     LOOP = 265,
-     POOL = 266,
-     THEN = 267,
-     WHILE = 268,
-     CASE = 269,
-     ESAC = 270,
-     OF = 271,
-     DARROW = 272,
-     NEW = 273,
-     ISVOID = 274,
-     STR_CONST = 275,
-     INT_CONST = 276,
-     BOOL_CONST = 277,
-     TYPEID = 278,
-     OBJECTID = 279,
-     ASSIGN = 280,
-     NOT = 281,
-     LE = 282,
-     ERROR = 283
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 284,                 /* "invalid token"  */
+    CLASS = 258,                   /* CLASS  */
+    ELSE = 259,                    /* ELSE  */
+    FI = 260,                      /* FI  */
+    IF = 261,                      /* IF  */
+    IN = 262,                      /* IN  */
+    INHERITS = 263,                /* INHERITS  */
+    LET = 264,                     /* LET  */
+    LOOP = 265,                    /* LOOP  */
+    POOL = 266,                    /* POOL  */
+    THEN = 267,                    /* THEN  */
+    WHILE = 268,                   /* WHILE  */
+    CASE = 269,                    /* CASE  */
+    ESAC = 270,                    /* ESAC  */
+    OF = 271,                      /* OF  */
+    DARROW = 272,                  /* DARROW  */
+    NEW = 273,                     /* NEW  */
+    ISVOID = 274,                  /* ISVOID  */
+    STR_CONST = 275,               /* STR_CONST  */
+    INT_CONST = 276,               /* INT_CONST  */
+    BOOL_CONST = 277,              /* BOOL_CONST  */
+    TYPEID = 278,                  /* TYPEID  */
+    OBJECTID = 279,                /* OBJECTID  */
+    ASSIGN = 280,                  /* ASSIGN  */
+    NOT = 281,                     /* NOT  */
+    LE = 282,                      /* LE  */
+    ERROR = 283                    /* ERROR  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 284
 #define CLASS 258
 #define ELSE 259
 #define FI 260
@@ -95,55 +133,155 @@
 #define LE 282
 #define ERROR 283
 
-
-
-
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+union YYSTYPE
 {
-
-/* Line 1676 of yacc.c  */
-#line 89 "cool.y"
+#line 126 "cool.y"
 
       Boolean boolean;
       Symbol symbol;
       Program program;
       Class_ class_;
-      Classes classes;
+      flat_list<Class_> *classes;
       Feature feature;
-      Features features;
+      flat_list<Feature> *features;
       Formal formal;
-      Formals formals;
+      flat_list<Formal> *formals;
       Case case_;
-      Cases cases;
+      flat_list<Case> *cases;
       Expression expression;
-      Expressions expressions;
+      flat_list<Expression> *expressions;
       char *error_msg;
     
 
+#line 159 "cool.tab.h"
 
-/* Line 1676 of yacc.c  */
-#line 127 "cool.tab.h"
-} YYSTYPE;
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
-extern YYSTYPE cool_yylval;
-
+/* Location type.  */
 #if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE
+typedef struct YYLTYPE YYLTYPE;
+struct YYLTYPE
 {
   int first_line;
   int first_column;
   int last_line;
   int last_column;
-} YYLTYPE;
-# define yyltype YYLTYPE /* obsolescent; will be withdrawn */
+};
 # define YYLTYPE_IS_DECLARED 1
 # define YYLTYPE_IS_TRIVIAL 1
 #endif
 
-extern YYLTYPE cool_yylloc;
 
+
+
+#ifndef YYPUSH_MORE_DEFINED
+# define YYPUSH_MORE_DEFINED
+enum { YYPUSH_MORE = 4 };
+#endif
+
+typedef struct cool_yypstate cool_yypstate;
+
+
+int cool_yyparse (parse_context *ctx);
+int cool_yypush_parse (cool_yypstate *ps,
+                  int pushed_char, YYSTYPE const *pushed_val, YYLTYPE *pushed_loc, parse_context *ctx);
+int cool_yypull_parse (cool_yypstate *ps, parse_context *ctx);
+cool_yypstate *cool_yypstate_new (void);
+void cool_yypstate_delete (cool_yypstate *ps);
+
+/* "%code provides" blocks.  */
+#line 166 "cool.y"
+
+      struct token_stream {
+        bool started;
+        bool binary;                    /* reading blocks, not text */
+        bool done;                      /* the empty block has been read */
+        bool keyed;                     /* has a key in the parse cache */
+        uint32_t key[4];
+        bool cached;                    /* the tree, not the tokens, came */
+        std::string lexer;              /* and the lexer that sent it */
+        std::vector<char> entry;        /* that tree, if read from a FILE */
+        std::vector<YYSTYPE> symbols;   /* by symbol index */
+        std::vector<int> token;         /* the current block */
+        std::vector<int> line;
+        std::vector<int> value;
+        size_t count;
+        size_t next;
+      };
+      
+      /* The tokens the hand written parser has read, which the LALR
+         parser reads again from next on (see descent_parse()). */
+      struct buffered_token {
+        int token;
+        int line;
+        YYSTYPE value;
+      };
+      
+      struct token_buffer {
+        std::vector<buffered_token> tokens;
+        size_t next;
+      };
+      
+      struct parse_context {
+        FILE *tokens;                   /* where the tokens come from */
+        token_stream stream;
+        char *filename;                 /* of the file being parsed */
+        Symbol filename_sym;            /* filename in stringtable */
+        int lineno;                     /* line of the last token read */
+        int last_token;                 /* the parser's lookahead */
+        YYSTYPE last_value;             /* and its value */
+        int node_lineno;                /* line of the nodes being built */
+        int errors;                     /* lexing and parsing errors */
+        std::shared_ptr<diagnostics> diag;      /* gets the errors, if set */
+        bool lazy_bodies;               /* see lazy-body.h */
+        Program ast_root;
+        Classes parse_results;
+        std::shared_ptr<node_arena> arena;      /* holds the tree, if set */
+        token_buffer replay;
+        std::vector<char> stacks[3];    /* the parser's, past YYINITDEPTH */
+        std::function<void(Class_)> on_class;   /* see class_done() */
+        std::shared_ptr<std::vector<compact_tree> > trees;  /* see cached_parse() */
+        
+        parse_context(FILE *tokens);
+      };
+      
+      /* A parse fed its binary token stream by the caller, a chunk at a
+         time as it arrives, instead of reading it from ctx->tokens. */
+      class push_parser {
+      public:
+        push_parser(parse_context *ctx);
+        ~push_parser();
+        
+        bool push(const char *bytes, size_t n); /* false once the parse is over */
+        int finish();                           /* at the end of the input */
+        
+      private:
+        enum { NAME, HEADER, BLOCKS } state;
+        parse_context *ctx;
+        struct cool_yypstate *parser;
+        int status;                     /* of the last token pushed */
+        std::vector<char> input;        /* not yet decoded */
+        
+        size_t decode(const char *bytes, size_t n);
+        void push_token(int token, YYSTYPE *value);
+        
+        push_parser(const push_parser &);
+        push_parser &operator=(const push_parser &);
+      };
+      
+      extern YYSTYPE cool_yylval;
+      int cool_yyparse();
+      void parse_token_files(const std::vector<FILE *> &files,
+                             std::vector<parse_context> &results,
+                             bool lazy_bodies = false);
+    
+
+#line 286 "cool.tab.h"
+
+#endif /* !YY_COOL_YY_COOL_TAB_H_INCLUDED  */
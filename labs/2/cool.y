@@ -4,8 +4,26 @@
 *
 */
 %{
+  #include <spawn.h>
+  #include <sys/stat.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+  #include <algorithm>
   #include <iostream>
+  #include <atomic>
+  #include <condition_variable>
+  #include <memory>
+  #include <mutex>
+  #include <sstream>
+  #include <string>
+  #include <thread>
+  #include <vector>
   #include "cool-tree.h"
+  #include "compact-tree.h"
+  #include "ast-image.h"
+  #include "parse-cache.h"
+  #include "lazy-body.h"
+  #include "diagnostics.h"
   #include "stringtab.h"
   #include "utilities.h"
   
@@ -13,22 +31,26 @@
   
   
   /* Locations */
-  #define YYLTYPE int              /* the type of locations */
-  #define cool_yylloc curr_lineno  /* use the curr_lineno from the lexer
-  for the location of tokens */
+  #define YYLTYPE int              /* the type of locations; a token's is
+  the line token_stream_lex() read for it */
     
-    extern int node_lineno;          /* set before constructing a tree node
-    to whatever you want the line number
-    for the tree node to be */
+    /* The parser is pure: everything a parse keeps lives in the
+       parse_context passed to cool_yyparse() as ctx.  Nodes take their
+       line from the global node_lineno when they are built, which
+       parses running at the same time cannot share, so the line for the
+       nodes of a rule is kept in ctx->node_lineno and NODE() stamps it on
+       each node as it is built. */
       
       
       #define YYLLOC_DEFAULT(Current, Rhs, N)         \
       Current = Rhs[1];                             \
-      node_lineno = Current;
+      ctx->node_lineno = Current;
     
     
     #define SET_NODELOC(Current)  \
-    node_lineno = Current;
+    ctx->node_lineno = Current;
+    
+    #define NODE(node) node_at(ctx, node)
     
     /* IMPORTANT NOTE ON LINE NUMBERS
     *********************************
@@ -61,21 +83,36 @@
       @$ = @3;
       
       
-      // Observe that we call SET_NODELOC(@3); this will set the global variable
-      // node_lineno to @3. Since the constructor call "plus" uses the value of 
-      // this global, the plus node will now have the correct line number.
+      // Observe that we call SET_NODELOC(@3); this will set the line of
+      // this parse, ctx->node_lineno, to @3. Since NODE() stamps that line
+      // on the nodes it wraps, the plus node will now have the correct
+      // line number.
       SET_NODELOC(@3);
       
       // construct the result node:
-      $$ = plus(int_const($1), int_const($3));
+      $$ = NODE(plus(NODE(int_const($1)), NODE(int_const($3))));
     }
     
     */
     
     
     
-    void yyerror(char *s);        /*  defined below; called for each parse error */
-    extern int yylex();           /*  the entry point to the lexer  */
+    /* The parser's stacks start at YYINITDEPTH entries.  Compiled as C++,
+       Bison will not move them, so it stops at that depth unless given a
+       yyoverflow; grow_stacks() (below) doubles them in the context of
+       the parse as the nesting of the program needs, up to memory. */
+    #define yyoverflow(message, ss, ss_bytes, vs, vs_bytes, ls, ls_bytes, size) \
+    grow_stacks(ctx, ss, ss_bytes, vs, vs_bytes, ls, ls_bytes, size)
+    
+    /* Bison only defines these for its own stack growing, but the state
+       of a push parse (see push_parser) is allocated with them too. */
+    #define YYMALLOC malloc
+    #define YYFREE free
+    
+    /* Tokens are read by token_stream_lex() below, which understands the
+       binary token stream and hands text streams to cool_yylex(). */
+    #undef yylex
+    #define yylex token_stream_lex
     
     /************************************************************************/
     /*                DONT CHANGE ANYTHING IN THIS SECTION                  */
@@ -91,18 +128,171 @@
       Symbol symbol;
       Program program;
       Class_ class_;
-      Classes classes;
+      flat_list<Class_> *classes;
       Feature feature;
-      Features features;
+      flat_list<Feature> *features;
       Formal formal;
-      Formals formals;
+      flat_list<Formal> *formals;
       Case case_;
-      Cases cases;
+      flat_list<Case> *cases;
       Expression expression;
-      Expressions expressions;
+      flat_list<Expression> *expressions;
       char *error_msg;
     }
     
+    %define api.pure full
+    %define api.push-pull both
+    %locations
+    %parse-param {parse_context *ctx}
+    %lex-param {parse_context *ctx}
+    
+    %code requires {
+      #include <stdio.h>
+      #include <stdint.h>
+      #include <functional>
+      #include <memory>
+      #include <string>
+      #include <vector>
+      #ifndef YYLTYPE
+      #define YYLTYPE int
+      #endif
+      struct parse_context;
+      class diagnostics;
+      class compact_tree;
+    }
+    
+    /* The state of one parse; see cool_yyparse() and parse_token_files()
+       at the end of the file. */
+    %code provides {
+      struct token_stream {
+        bool started;
+        bool binary;                    /* reading blocks, not text */
+        bool done;                      /* the empty block has been read */
+        bool keyed;                     /* has a key in the parse cache */
+        uint32_t key[4];
+        bool cached;                    /* the tree, not the tokens, came */
+        std::string lexer;              /* and the lexer that sent it */
+        std::vector<char> entry;        /* that tree, if read from a FILE */
+        std::vector<YYSTYPE> symbols;   /* by symbol index */
+        std::vector<int> token;         /* the current block */
+        std::vector<int> line;
+        std::vector<int> value;
+        size_t count;
+        size_t next;
+      };
+      
+      /* The tokens the hand written parser has read, which the LALR
+         parser reads again from next on (see descent_parse()). */
+      struct buffered_token {
+        int token;
+        int line;
+        YYSTYPE value;
+      };
+      
+      struct token_buffer {
+        std::vector<buffered_token> tokens;
+        size_t next;
+      };
+      
+      struct parse_context {
+        FILE *tokens;                   /* where the tokens come from */
+        token_stream stream;
+        char *filename;                 /* of the file being parsed */
+        Symbol filename_sym;            /* filename in stringtable */
+        int lineno;                     /* line of the last token read */
+        int last_token;                 /* the parser's lookahead */
+        YYSTYPE last_value;             /* and its value */
+        int node_lineno;                /* line of the nodes being built */
+        int errors;                     /* lexing and parsing errors */
+        std::shared_ptr<diagnostics> diag;      /* gets the errors, if set */
+        bool lazy_bodies;               /* see lazy-body.h */
+        Program ast_root;
+        Classes parse_results;
+        std::shared_ptr<node_arena> arena;      /* holds the tree, if set */
+        token_buffer replay;
+        std::vector<char> stacks[3];    /* the parser's, past YYINITDEPTH */
+        std::function<void(Class_)> on_class;   /* see class_done() */
+        std::shared_ptr<std::vector<compact_tree> > trees;  /* see cached_parse() */
+        
+        parse_context(FILE *tokens);
+      };
+      
+      /* A parse fed its binary token stream by the caller, a chunk at a
+         time as it arrives, instead of reading it from ctx->tokens. */
+      class push_parser {
+      public:
+        push_parser(parse_context *ctx);
+        ~push_parser();
+        
+        bool push(const char *bytes, size_t n); /* false once the parse is over */
+        int finish();                           /* at the end of the input */
+        
+      private:
+        enum { NAME, HEADER, BLOCKS } state;
+        parse_context *ctx;
+        struct cool_yypstate *parser;
+        int status;                     /* of the last token pushed */
+        std::vector<char> input;        /* not yet decoded */
+        
+        size_t decode(const char *bytes, size_t n);
+        void push_token(int token, YYSTYPE *value);
+        
+        push_parser(const push_parser &);
+        push_parser &operator=(const push_parser &);
+      };
+      
+      extern YYSTYPE cool_yylval;
+      int cool_yyparse();
+      void parse_token_files(const std::vector<FILE *> &files,
+                             std::vector<parse_context> &results,
+                             bool lazy_bodies = false);
+    }
+    
+    %code {
+      void yyerror(YYLTYPE *loc, parse_context *ctx, const char *s);
+      static int token_stream_lex(YYSTYPE *lval, YYLTYPE *lloc, parse_context *ctx);
+      
+      /* Symbols the actions need for every class or dispatch; defined below. */
+      static Symbol object_symbol();
+      static Symbol self_symbol();
+      static Symbol filename_symbol(parse_context *ctx);
+      static void class_done(parse_context *ctx, Class_ c);
+      static bool stop_parse(parse_context *ctx);
+      static parse_cache *shared_cache();
+      
+      template <class T> static T node_at(parse_context *ctx, T node);
+      
+      /* Move one of the parser's stacks, holding used bytes, into space,
+         grown to bytes. */
+      static void grow_stack(std::vector<char> &space, void *stack,
+                             size_t used, size_t bytes)
+      {
+        if (stack == space.data() && !space.empty()) {
+          space.resize(bytes);
+          return;
+        }
+        std::vector<char> grown(bytes);
+        memcpy(grown.data(), stack, used);
+        space.swap(grown);
+      }
+      
+      template <class State, class Size>
+      static void grow_stacks(parse_context *ctx, State **ss, size_t ss_bytes,
+                              YYSTYPE **vs, size_t vs_bytes,
+                              YYLTYPE **ls, size_t ls_bytes, Size *size)
+      {
+        size_t depth = 2 * *size;
+        
+        grow_stack(ctx->stacks[0], *ss, ss_bytes, depth * sizeof(State));
+        grow_stack(ctx->stacks[1], *vs, vs_bytes, depth * sizeof(YYSTYPE));
+        grow_stack(ctx->stacks[2], *ls, ls_bytes, depth * sizeof(YYLTYPE));
+        *ss = (State *) ctx->stacks[0].data();
+        *vs = (YYSTYPE *) ctx->stacks[1].data();
+        *ls = (YYLTYPE *) ctx->stacks[2].data();
+        *size = depth;
+      }
+    }
+    
     /* 
     Declare the terminals; a few have types for associated lexemes.
     The token ERROR is never used in the parser; thus, it is a parse
@@ -172,178 +362,2774 @@
     /* 
     Save the root of the abstract syntax tree in a global variable.
     */
-    program	: class_list	{ @$ = @1; ast_root = program($1); }
+    program	: class_list	{ @$ = @1; ctx->ast_root = NODE(program($1)); }
     ;
     
     class_list
     : class			/* single class */
-    { $$ = single_Classes($1);
-    parse_results = $$; }
+    { $$ = flat_single($1);
+    ctx->parse_results = $$; }
     | class_list class		/* several classes */
-    { $$ = append_Classes($1,single_Classes($2)); 
-    parse_results = $$; }
+    { $$ = flat_append($1,$2); 
+    ctx->parse_results = $$; }
     ;
     
     /* If no parent is specified, the class inherits from the Object class. */
     class	: CLASS TYPEID '{' feature_list '}' ';'
-    { $$ = class_($2,idtable.add_string("Object"),$4,
-    stringtable.add_string(curr_filename)); }
+    { $$ = NODE(class_($2,object_symbol(),$4,filename_symbol(ctx)));
+    class_done(ctx, $$); }
     | CLASS TYPEID INHERITS TYPEID '{' feature_list '}' ';'
-    { $$ = class_($2,$4,$6,stringtable.add_string(curr_filename)); }
+    { $$ = NODE(class_($2,$4,$6,filename_symbol(ctx)));
+    class_done(ctx, $$); }
 	| error ';'
-	{}
+	{ if (stop_parse(ctx)) YYABORT; }
     ;
     
     /* Feature list may be empty, but no empty features in list. */
     feature_list
 	:
-    { $$ = nil_Features(); }
+    { $$ = flat_nil<Feature>(); }
 	| feature ';' /* single feature */
-	{ $$ = single_Features($1); }
+	{ $$ = flat_single($1); }
 	| feature_list feature ';'	/* many features */
-	{ $$ = append_Features($1,single_Features($2)); }
+	{ $$ = flat_append($1,$2); }
 	;
 
 	/* Feature phylum has two constructors: method and attr */
 	feature
 	: OBJECTID '(' formal_list ')' ':' TYPEID '{' expr '}'
-	{ $$ = method($1,$3,$6,$8); }
+	{ $$ = NODE(method($1,$3,$6,$8)); }
 	| OBJECTID ':' TYPEID ASSIGN expr
-	{ $$ = attr($1,$3,$5); }
+	{ $$ = NODE(attr($1,$3,$5)); }
 	| OBJECTID ':' TYPEID
-	{ $$ = attr($1,$3,no_expr()); }
+	{ $$ = NODE(attr($1,$3,NODE(no_expr()))); }
 	| error
+	{ if (stop_parse(ctx)) YYABORT; }
 	;
 	
 	formal_list
 	:
-	{ $$ = nil_Formals(); }
+	{ $$ = flat_nil<Formal>(); }
 	| formal 
-	{ $$ = single_Formals($1); }
+	{ $$ = flat_single($1); }
 	| formal_list ',' formal
-	{ $$ = append_Formals($1, single_Formals($3)); }
+	{ $$ = flat_append($1, $3); }
 	;
 
 	formal
 	: OBJECTID ':' TYPEID
-	{ $$ = formal($1, $3); }
+	{ $$ = NODE(formal($1, $3)); }
 	;
 
 	/* Case-switch cases (branches) */
 	branch_list
 	: branch
-	{ $$ = single_Cases($1); }
+	{ $$ = flat_single($1); }
 	| branch_list branch
-	{ $$ = append_Cases($1, single_Cases($2)); }
+	{ $$ = flat_append($1, $2); }
 	;
 
 	branch
 	: OBJECTID ':' TYPEID DARROW expr ';'
-	{ $$ = branch($1,$3,$5); }
+	{ $$ = NODE(branch($1,$3,$5)); }
 	;
 
 	/* Expressions used in methods */ 
 	comma_expr_list
 	:
-	{ $$ = nil_Expressions(); }
+	{ $$ = flat_nil<Expression>(); }
 	| expr
-	{ $$ = single_Expressions($1); }
+	{ $$ = flat_single($1); }
 	| comma_expr_list ',' expr
-	{ $$ = append_Expressions($1,single_Expressions($3)); }
+	{ $$ = flat_append($1,$3); }
 	;
 
 	/* Expressions used in block structure */ 
 	smcl_expr_list
 	: expr ';'
-	{ $$ = single_Expressions($1); }
+	{ $$ = flat_single($1); }
 	| smcl_expr_list expr ';'
-	{ $$ = append_Expressions($1,single_Expressions($2)); }
+	{ $$ = flat_append($1,$2); }
 	| error ';'
+	{ if (stop_parse(ctx)) YYABORT; $$ = flat_nil<Expression>(); }
 	;
 
 	expr
 	: OBJECTID ASSIGN expr
-	{ $$ = assign($1,$3); }
+	{ $$ = NODE(assign($1,$3)); }
 	| expr '@' TYPEID '.' OBJECTID '(' comma_expr_list ')'
-	{ $$ = static_dispatch($1,$3,$5,$7); }
+	{ $$ = NODE(static_dispatch($1,$3,$5,$7)); }
 	| expr '.' OBJECTID '(' comma_expr_list ')'
-	{ $$ = dispatch($1,$3,$5); }
+	{ $$ = NODE(dispatch($1,$3,$5)); }
 	| OBJECTID '(' comma_expr_list ')'
-	{ $$ = dispatch(object(idtable.add_string("self")),$1,$3); }
+	{ $$ = NODE(dispatch(NODE(object(self_symbol())),$1,$3)); }
 	| IF expr THEN expr ELSE expr FI
-	{ $$ = cond($2,$4,$6); }
+	{ $$ = NODE(cond($2,$4,$6)); }
 	| WHILE expr LOOP expr POOL
-	{ $$ = loop($2,$4); }
+	{ $$ = NODE(loop($2,$4)); }
 	| '{' smcl_expr_list '}'
-	{ $$ = block($2); }
+	{ $$ = NODE(block($2)); }
 	| CASE expr OF branch_list ESAC
-	{ $$ = typcase($2,$4); }
+	{ $$ = NODE(typcase($2,$4)); }
 	| LET let_body 
 	{ $$ = $2; }
 	| expr '+' expr
-	{ $$ = plus($1,$3); }
+	{ $$ = NODE(plus($1,$3)); }
 	| expr '-' expr
-	{ $$ = sub($1,$3); }
+	{ $$ = NODE(sub($1,$3)); }
 	| expr '*' expr
-	{ $$ = mul($1,$3); }
+	{ $$ = NODE(mul($1,$3)); }
 	| expr '/' expr
-	{ $$ = divide($1,$3); }
+	{ $$ = NODE(divide($1,$3)); }
 	| '~' expr
-	{ $$ = neg($2); }
+	{ $$ = NODE(neg($2)); }
 	| expr '<' expr
-	{ $$ = lt($1,$3); }
+	{ $$ = NODE(lt($1,$3)); }
 	| expr '=' expr
-	{ $$ = eq($1,$3); }
+	{ $$ = NODE(eq($1,$3)); }
 	| expr LE expr
-	{ $$ = leq($1,$3); }
+	{ $$ = NODE(leq($1,$3)); }
 	| NOT expr
-	{ $$ = comp($2); }
+	{ $$ = NODE(comp($2)); }
 	| '(' expr ')'
 	{ $$ = $2; }
 	| INT_CONST
-	{ $$ = int_const($1); }
+	{ $$ = NODE(int_const($1)); }
 	| BOOL_CONST
-	{ $$ = bool_const($1); }
+	{ $$ = NODE(bool_const($1)); }
 	| STR_CONST
-	{ $$ = string_const($1); }
+	{ $$ = NODE(string_const($1)); }
 	| NEW TYPEID
-	{ $$ = new_($2); }
+	{ $$ = NODE(new_($2)); }
 	| ISVOID expr
-	{ $$ = isvoid($2); }
+	{ $$ = NODE(isvoid($2)); }
 	| OBJECTID
-	{ $$ = object($1); }
+	{ $$ = NODE(object($1)); }
 	;
 
 	/* let structure implementation. */
 	let_body
 	: OBJECTID ':' TYPEID ASSIGN expr IN expr
-	{ $$ = let($1,$3,$5,$7); }
+	{ $$ = NODE(let($1,$3,$5,$7)); }
 	| OBJECTID ':' TYPEID IN expr
-	{ $$ = let($1,$3,no_expr(),$5); }
+	{ $$ = NODE(let($1,$3,NODE(no_expr()),$5)); }
 	| OBJECTID ':' TYPEID ASSIGN expr ',' let_body
-	{ $$ = let($1,$3,$5,$7); }
+	{ $$ = NODE(let($1,$3,$5,$7)); }
 	| OBJECTID ':' TYPEID ',' let_body
-	{ $$ = let($1,$3,no_expr(),$5); }
+	{ $$ = NODE(let($1,$3,NODE(no_expr()),$5)); }
 	| error ',' let_body
-	{}
+	{ if (stop_parse(ctx)) YYABORT; }
 	;
    
 	
     /* end of grammar */
     %%
     
-    /* This function is called automatically when Bison detects a parse error. */
-    void yyerror(char *s)
+    /* The string tables, and cool_token_to_string() when reporting
+       errors, are shared by all parses. */
+    static std::mutex symbols_lock;
+    
+    /* What print_cool_token() shows for token. */
+    static std::string token_text(int token, const YYSTYPE &value)
+    {
+      std::ostringstream text;
+      
+      text << cool_token_to_string(token);
+      switch (token) {
+        case STR_CONST:
+          text << " = \"";
+          print_escaped_string(text, value.symbol->get_string());
+          text << "\"";
+          break;
+        case INT_CONST:
+        case TYPEID:
+        case OBJECTID:
+          text << " = " << value.symbol;
+          break;
+        case BOOL_CONST:
+          text << (value.boolean ? " = true" : " = false");
+          break;
+        case ERROR:
+          text << " = \"" << value.error_msg << "\"";
+          break;
+      }
+      return text.str();
+    }
+    
+    /* This function is called automatically when Bison detects a parse
+       error, with loc at the line of the offending token.  The error
+       goes to ctx->diag (see diagnostics.h). */
+    void yyerror(YYLTYPE *loc, parse_context *ctx, const char *s)
+    {
+      ctx->errors++;
+      if (ctx->diag == nullptr)
+        return;
+      
+      diagnostic d;
+      d.file = ctx->filename;
+      d.line = *loc;
+      d.message = s;
+      {
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        d.token = token_text(ctx->last_token, ctx->last_value);
+      }
+      ctx->diag->report(d);
+    }
+    
+    /* For the error rules: whether to give up rather than recover.  A
+       parse without diagnostics only needs to know it has errors. */
+    static bool stop_parse(parse_context *ctx)
+    {
+      return ctx->diag == nullptr || (size_t) ctx->errors > ctx->diag->limit;
+    }
+    
+    parse_context::parse_context(FILE *tokens)
+      : tokens(tokens), stream(), filename(curr_filename), filename_sym(NULL),
+        lineno(1), last_token(0), node_lineno(1), errors(0),
+        lazy_bodies(false), ast_root(NULL), parse_results(NULL), replay()
+    {
+    }
+    
+    /* A node built by an action gets the line of the rule being reduced
+       (see NODE() at the top of the file). */
+    struct line_access : tree_node {
+      static int tree_node::*member() { return &line_access::line_number; }
+    };
+    
+    template <class T> static T node_at(int line, T node)
+    {
+      node->*line_access::member() = line;
+      return node;
+    }
+    
+    template <class T> static T node_at(parse_context *ctx, T node)
+    {
+      return node_at(ctx->node_lineno, node);
+    }
+    
+    /*
+     * Token input.  The lexer writes a binary token stream instead of the
+     * textual dump when run with COOL_TOKEN_FORMAT=binary (the format is
+     * described next to write_token_stream() in cool.flex).  A stream is
+     * recognised by the magic word right after the "#name" line and read
+     * here a block at a time, straight into the arrays of ctx->stream;
+     * anything else is left to cool_yylex() from tokens-lex.cc, which
+     * reads token_file through globals of its own, so only binary streams
+     * can be parsed several at a time.
+     */
+    #define TOKEN_STREAM_MAGIC    0x4b54437fu
+    #define TOKEN_STREAM_VERSION  2u
+    #define TOKEN_STREAM_KEYED    4u      /* with a parse cache key */
+    #define TOKEN_STREAM_CACHED   8u      /* the cache's tree in place of blocks */
+    
+    enum { SYM_ID, SYM_INT, SYM_STR, SYM_ERROR };
+    
+    extern FILE *token_file;
+    extern int cool_yylex();
+    extern int curr_lineno;
+    extern int verbose_flag;
+    
+    /* The lexer of tokens-lex.cc hands its values over in cool_yylval,
+       which a pure parser does not define for it. */
+    YYSTYPE cool_yylval;
+    
+    /* fatal_error() takes a char *, which a string literal is not. */
+    static void stream_error(const char *msg)
+    {
+      std::string text(msg);
+      fatal_error(&text[0]);
+    }
+    
+    /* The cache of COOL_PARSE_CACHE (see parse-cache.h), or NULL. */
+    static parse_cache *shared_cache()
+    {
+      static const char *dir = getenv("COOL_PARSE_CACHE");
+      static parse_cache *cache =
+        dir != NULL && *dir != '\0' ? new parse_cache(dir) : NULL;
+      
+      return cache;
+    }
+    
+    /* Where a stream is read from: ctx->tokens, or for push_parser a
+       buffer already known to hold all that is read from it. */
+    struct file_source {
+      FILE *file;
+      
+      void read(void *to, size_t n)
+      {
+        if (fread(to, 1, n, file) != n)
+          stream_error("truncated binary token stream");
+      }
+    };
+    
+    struct buffer_source {
+      const char *bytes;
+      
+      void read(void *to, size_t n)
+      {
+        memcpy(to, bytes, n);
+        bytes += n;
+      }
+    };
+    
+    template <class Source> static unsigned get_word(Source &in)
+    {
+      unsigned w;
+      
+      in.read(&w, sizeof(w));
+      return w;
+    }
+    
+    template <class Source>
+    static void get_words(Source &in, std::vector<int> &words, size_t n)
+    {
+      words.resize(n);
+      in.read(words.data(), n * sizeof(int));
+    }
+    
+    /* Read the next block: its new symbols, then its tokens. */
+    template <class Source> static void read_block(parse_context *ctx, Source &in)
+    {
+      token_stream &stream = ctx->stream;
+      unsigned nsyms = get_word(in);
+      std::string text;
+      for (unsigned i = 0; i < nsyms; i++) {
+        unsigned kind = get_word(in);
+        text.resize(get_word(in));
+        in.read(&text[0], text.length());
+        
+        YYSTYPE v;
+        char *s = (char *) text.c_str();
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        switch (kind) {
+          case SYM_ID:  v.symbol = idtable.add_string(s); break;
+          case SYM_INT: v.symbol = inttable.add_string(s); break;
+          case SYM_STR: v.symbol = stringtable.add_string(s); break;
+          default:      v.error_msg = strdup(s); break;
+        }
+        stream.symbols.push_back(v);
+      }
+      
+      stream.count = get_word(in);
+      stream.next = 0;
+      stream.done = stream.count == 0;
+      get_words(in, stream.token, stream.count);
+      get_words(in, stream.line, stream.count);
+      get_words(in, stream.value, stream.count);
+    }
+    
+    /* The text of a "#name" line, after the '#'. */
+    static void set_name(parse_context *ctx, const std::string &line)
+    {
+      size_t open = line.find('"'), close = line.rfind('"');
+      if (line.compare(0, 4, "name") == 0 && open != close)
+      {
+        ctx->filename = strdup(line.substr(open + 1, close - open - 1).c_str());
+        ctx->filename_sym = NULL;
+      }
+    }
+    
+    /* Read the header of a new stream. */
+    template <class Source> static void start_stream(parse_context *ctx, Source &in)
+    {
+      token_stream &stream = ctx->stream;
+      unsigned magic = get_word(in);
+      unsigned version = get_word(in);
+      
+      stream.keyed = stream.cached = false;
+      if (magic == TOKEN_STREAM_MAGIC &&
+          (version == TOKEN_STREAM_KEYED || version == TOKEN_STREAM_CACHED)) {
+        for (int i = 0; i < 4; i++)
+          stream.key[i] = get_word(in);
+        stream.keyed = true;
+      } else if (magic != TOKEN_STREAM_MAGIC || version != TOKEN_STREAM_VERSION)
+        stream_error("bad binary token stream header");
+      stream.symbols.clear();
+      stream.done = false;
+      stream.count = stream.next = 0;
+      
+      /* A file the lexer found in the cache has no blocks to read, and
+         only cached_parse() knows what to do with its tree. */
+      if (version == TOKEN_STREAM_CACHED) {
+        if (shared_cache() == NULL)
+          stream_error("cached tree in the token stream, but no COOL_PARSE_CACHE");
+        size_t path = get_word(in);
+        stream.entry.resize(get_word(in));
+        stream.lexer.resize(path);
+        in.read(&stream.lexer[0], path);
+        char pad[3];
+        in.read(pad, -path & 3);
+        in.read(stream.entry.data(), stream.entry.size());
+        stream.cached = stream.done = true;
+      }
+    }
+    
+    static unsigned word_at(const char *bytes, size_t at)
+    {
+      unsigned w;
+      
+      memcpy(&w, bytes + at, sizeof(w));
+      return w;
+    }
+    
+    /* The length of the header bytes starts with, or 0 if fewer than n. */
+    static size_t header_size(const char *bytes, size_t n)
+    {
+      unsigned version;
+      
+      if (n < 2 * sizeof(unsigned))
+        return 0;
+      memcpy(&version, bytes + sizeof(unsigned), sizeof(version));
+      size_t size = (version == TOKEN_STREAM_KEYED ? 6 :
+                     version == TOKEN_STREAM_CACHED ? 8 : 2) * sizeof(unsigned);
+      if (version == TOKEN_STREAM_CACHED && size <= n) {
+        /* with the lexer's path and the entry, the whole stream */
+        unsigned path = word_at(bytes, 6 * sizeof(unsigned));
+        unsigned entry = word_at(bytes, 7 * sizeof(unsigned));
+        size += (path + 3) / 4 * 4 + entry;
+      }
+      return size <= n ? size : 0;
+    }
+    
+    /* Consume the "#name" line the lexer puts before each file and see
+       whether a binary stream follows it.  Returns false at EOF. */
+    static bool start_file(parse_context *ctx)
+    {
+      int c = getc(ctx->tokens);
+      
+      if (c == '#') {
+        std::string line;
+        while ((c = getc(ctx->tokens)) != EOF && c != '\n')
+          line += (char) c;
+        set_name(ctx, line);
+        c = getc(ctx->tokens);
+      }
+      if (c == EOF)
+        return false;
+      ungetc(c, ctx->tokens);
+      
+      ctx->stream.binary = (unsigned char) c == (TOKEN_STREAM_MAGIC & 0xff);
+      if (ctx->stream.binary) {
+        file_source in = { ctx->tokens };
+        start_stream(ctx, in);
+      }
+      return true;
+    }
+    
+    /* The value of the token stream.next - 1 of the current block. */
+    static int stream_token(parse_context *ctx, YYSTYPE *lval)
+    {
+      token_stream &stream = ctx->stream;
+      size_t i = stream.next - 1;
+      int token = stream.token[i];
+      
+      ctx->lineno = stream.line[i];
+      switch (token) {
+        case TYPEID:
+        case OBJECTID:
+        case INT_CONST:
+        case STR_CONST:
+        case ERROR:
+          *lval = stream.symbols[stream.value[i]];
+          break;
+        case BOOL_CONST:
+          lval->boolean = stream.value[i];
+          break;
+      }
+      return token;
+    }
+    
+    static int next_token(parse_context *ctx, YYSTYPE *lval)
     {
-      extern int curr_lineno;
+      token_stream &stream = ctx->stream;
+      token_buffer &replay = ctx->replay;
+      
+      if (replay.next < replay.tokens.size()) {
+        const buffered_token &t = replay.tokens[replay.next++];
+        *lval = t.value;
+        ctx->lineno = t.line;
+        return t.token;
+      }
+      if (!stream.started) {
+        stream.started = true;
+        if (!start_file(ctx))
+          return 0;
+      }
       
-      cerr << "\"" << curr_filename << "\", line " << curr_lineno << ": " \
-      << s << " at or near ";
-      print_cool_token(yychar);
-      cerr << endl;
-      omerrs++;
+      while (stream.binary && stream.next == stream.count) {
+        file_source in = { ctx->tokens };
+        if (!stream.done)
+          read_block(ctx, in);
+        else if (!start_file(ctx))
+          return 0;
+      }
+      if (!stream.binary) {
+        /* tokens-lex interns, perhaps while pieces are parsed */
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        int token = cool_yylex();
+        *lval = cool_yylval;
+        ctx->lineno = curr_lineno;
+        return token;
+      }
       
-      if(omerrs>50) {fprintf(stdout, "More than 50 errors\n"); exit(1);}
+      stream.next++;
+      return stream_token(ctx, lval);
+    }
+    
+    static int token_stream_lex(YYSTYPE *lval, YYLTYPE *lloc, parse_context *ctx)
+    {
+      ctx->last_token = next_token(ctx, lval);
+      ctx->last_value = *lval;
+      *lloc = ctx->lineno;
+      return ctx->last_token;
+    }
+    
+    /* add_string walks the table's list, so these are looked up once
+       rather than once per class or dispatch. */
+    static Symbol intern_id(const char *s)
+    {
+      std::lock_guard<std::mutex> hold(symbols_lock);
+      return idtable.add_string((char *) s);
+    }
+    
+    static Symbol object_symbol()
+    {
+      static Symbol sym = intern_id("Object");
+      return sym;
     }
     
+    static Symbol self_symbol()
+    {
+      static Symbol sym = intern_id("self");
+      return sym;
+    }
+    
+    /* start_file() clears ctx->filename_sym whenever the name changes. */
+    static Symbol filename_symbol(parse_context *ctx)
+    {
+      if (ctx->filename_sym == NULL) {
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        ctx->filename_sym = stringtable.add_string(ctx->filename);
+      }
+      return ctx->filename_sym;
+    }
+    
+    /* Each class is handed to ctx->on_class as soon as it is reduced, for
+       as long as the program has no errors, so that a caller can start
+       on the first classes of a long program while the rest of it is
+       still being read (see push_parser, and cool_yyparse(), which
+       dumps them there for COOL_PARSER=stream). */
+    static void class_done(parse_context *ctx, Class_ c)
+    {
+      if (ctx->on_class && ctx->errors == 0)
+        ctx->on_class(c);
+    }
+    
+    /* For descent_parser::splice() and cached_parse(), as line_access is
+       for node_at(), and for the outline of a program (see
+       print_outline()). */
+    struct class_access : class__class {
+      static Features class__class::*member() { return &class_access::features; }
+      static Symbol class__class::*file() { return &class_access::filename; }
+      static Symbol class__class::*class_name() { return &class_access::name; }
+      static Symbol class__class::*parent_name() { return &class_access::parent; }
+    };
+    
+    /* For lazy_body, which parses its tokens as the body of a method or
+       the initializer of an attribute, and for the outline. */
+    struct method_access : method_class {
+      static Expression method_class::*body() { return &method_access::expr; }
+      static Symbol method_class::*method_name() { return &method_access::name; }
+      static Formals method_class::*formal_list() { return &method_access::formals; }
+      static Symbol method_class::*result() { return &method_access::return_type; }
+    };
+    
+    struct attr_access : attr_class {
+      static Expression attr_class::*body() { return &attr_access::init; }
+      static Symbol attr_class::*attr_name() { return &attr_access::name; }
+      static Symbol attr_class::*type() { return &attr_access::type_decl; }
+    };
+    
+    struct formal_access : formal_class {
+      static Symbol formal_class::*formal_name() { return &formal_access::name; }
+      static Symbol formal_class::*type() { return &formal_access::type_decl; }
+    };
+    
+    /*
+     * A hand written parser for the grammar above, used instead of the
+     * LALR tables with COOL_PARSER=descent, and for the signatures of a
+     * program when its bodies are left lazy and the bodies once they are
+     * asked for.  parser-diff.pl checks that it builds the same trees as
+     * the tables do.  Expressions are parsed by precedence climbing over the levels of
+     * the %left/%right/%nonassoc declarations, taking the same shift or
+     * reduce decision the tables take: an operator continues the operand
+     * of a rule of level R when its own level is higher, or equal and
+     * %right; at an equal %nonassoc level it is an error.  A rule without
+     * a level (the body of a let) takes every operator, as the default
+     * shift does.  Each node gets the line of the first token of its
+     * rule, as NODE() gives it, and lists are built with the same flat_
+     * helpers.
+     *
+     * The parser only recognises programs without syntax errors.  At the
+     * first token that cannot continue the program it gives up, and the
+     * LALR parser parses the tokens in ctx->replay again, then the rest
+     * of the input, so that errors are reported and recovered from
+     * exactly as before.  The tables recover from an error inside a
+     * feature the same way whichever classes and features came before
+     * it (the error rules of feature and class are reached through the
+     * same states), so the buffer only keeps the header of the current
+     * class and the tokens of its current feature.
+     *
+     * Recursion follows the nesting of the program.  Past MAX_DEPTH
+     * expressions one inside the other the parser gives up as well, and
+     * once the LALR parser, whose stacks are on the heap, has parsed the
+     * rest of the program, splice() puts the classes and features that
+     * were done in front of what it built.
+     *
+     * With ctx->lazy_bodies the expressions of features are skipped and
+     * left to lazy_body (see lazy-body.h), which parses them with
+     * parse_body() when asked.  An error in them is not seen then, so a
+     * parse only gives up on the signatures around them.
+     */
+    class descent_parser {
+    private:
+      struct give_up { };
+      
+      enum { LEFT, RIGHT, NONASSOC };
+      enum { MAX_DEPTH = 10000 };
+      
+      parse_context *ctx;
+      token_buffer &buf;
+      int first_line;                 /* of the program */
+      flat_list<Class_> *classes;     /* those parsed so far */
+      flat_list<Feature> *features;   /* of the class being parsed, in its body */
+      int depth;                      /* of the expressions being parsed */
+      
+      struct nested {
+        int &depth;
+        
+        nested(int &depth) : depth(depth)
+        {
+          if (++depth > MAX_DEPTH)
+            throw give_up();
+        }
+        ~nested() { depth--; }
+      };
+      
+      const buffered_token &next()
+      {
+        if (buf.next == buf.tokens.size()) {
+          buffered_token t;
+          t.token = next_token(ctx, &t.value);
+          t.line = ctx->lineno;
+          buf.tokens.push_back(t);
+        }
+        return buf.tokens[buf.next];
+      }
+      
+      int peek() { return next().token; }
+      
+      /* Drop the tokens read since from, the next one excepted. */
+      void forget(size_t from)
+      {
+        buf.tokens.erase(buf.tokens.begin() + from,
+                         buf.tokens.begin() + buf.next);
+        buf.next = from;
+      }
+      int line() { return next().line; }
+      
+      void expect(int token)
+      {
+        if (peek() != token)
+          throw give_up();
+        buf.next++;
+      }
+      
+      /* The value of the next token, which must be token. */
+      YYSTYPE take(int token)
+      {
+        expect(token);
+        return buf.tokens[buf.next - 1].value;
+      }
+      
+      /* The level of an operator that follows an operand, 0 for none. */
+      static int level(int token, int &assoc)
+      {
+        switch (token) {
+          case '=':            assoc = NONASSOC; return 1;
+          case '+': case '-':  assoc = LEFT;     return 3;
+          case '*': case '/':  assoc = LEFT;     return 4;
+          case '.': case '@':  assoc = LEFT;     return 5;
+          case '<': case LE:   assoc = NONASSOC; return 9;
+          default:             return 0;
+        }
+      }
+      
+      /* Levels of the rules that end in an operand. */
+      enum { ANY = 0, ASSIGN_LEVEL = 2, NEG_LEVEL = 6, ISVOID_LEVEL = 7,
+             NOT_LEVEL = 8 };
+      
+      Class_ parse_class()
+      {
+        int at = line();
+        expect(CLASS);
+        Symbol name = take(TYPEID).symbol;
+        Symbol parent = object_symbol();
+        if (peek() == INHERITS) {
+          buf.next++;
+          parent = take(TYPEID).symbol;
+        }
+        expect('{');
+        size_t header = buf.next;
+        features = flat_nil<Feature>();
+        for (forget(header); peek() != '}'; forget(header)) {
+          features = flat_append(features, parse_feature());
+          expect(';');
+        }
+        buf.next++;
+        expect(';');
+        Features body = features;
+        features = NULL;
+        return node_at(at, class_(name, parent, body, filename_symbol(ctx)));
+      }
+      
+      Feature parse_feature()
+      {
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        
+        if (peek() == '(') {
+          buf.next++;
+          flat_list<Formal> *formals = flat_nil<Formal>();
+          if (peek() != ')') {
+            if (peek() == ',')        /* formal_list may start empty */
+              buf.next++;
+            formals = flat_append(formals, parse_formal());
+            while (peek() == ',') {
+              buf.next++;
+              formals = flat_append(formals, parse_formal());
+            }
+          }
+          expect(')');
+          expect(':');
+          Symbol type = take(TYPEID).symbol;
+          expect('{');
+          Expression body = ctx->lazy_bodies ? skip_body('}') : parse_expr(ANY);
+          expect('}');
+          return node_at(at, method(name, formals, type, body));
+        }
+        
+        expect(':');
+        Symbol type = take(TYPEID).symbol;
+        if (peek() != ASSIGN)
+          return node_at(at, attr(name, type, node_at(at, no_expr())));
+        buf.next++;
+        Expression init = ctx->lazy_bodies ? skip_body(';') : parse_expr(ANY);
+        return node_at(at, attr(name, type, init));
+      }
+      
+      /* A lazy_body for the tokens up to end, outside any brackets. */
+      Expression skip_body(int end)
+      {
+        size_t from = buf.next;
+        int nesting = 0;
+        
+        for (int token; (token = peek()) != end || nesting > 0; buf.next++)
+          switch (token) {
+            case '{': case '(': case CASE:
+              nesting++;
+              break;
+            case '}': case ')': case ESAC:
+              if (--nesting < 0)
+                throw give_up();
+              break;
+            case 0:
+              throw give_up();
+          }
+        int at = buf.tokens[from].line;
+        return node_at(at, new lazy_body(&buf.tokens[from], buf.next + 1 - from,
+                                         ctx->filename, ctx->diag));
+      }
+      
+      Formal parse_formal()
+      {
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        expect(':');
+        return node_at(at, formal(name, take(TYPEID).symbol));
+      }
+      
+      /* '(' comma_expr_list ')' */
+      Expressions parse_actuals()
+      {
+        flat_list<Expression> *actuals = flat_nil<Expression>();
+        
+        expect('(');
+        if (peek() != ')') {
+          if (peek() == ',')          /* comma_expr_list may start empty */
+            buf.next++;
+          actuals = flat_append(actuals, parse_expr(ANY));
+          while (peek() == ',') {
+            buf.next++;
+            actuals = flat_append(actuals, parse_expr(ANY));
+          }
+        }
+        expect(')');
+        return actuals;
+      }
+      
+      Case parse_branch()
+      {
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        expect(':');
+        Symbol type = take(TYPEID).symbol;
+        expect(DARROW);
+        Expression expr = parse_expr(ANY);
+        expect(';');
+        return node_at(at, branch(name, type, expr));
+      }
+      
+      Expression parse_let_body()
+      {
+        nested in(depth);
+        int at = line();
+        Symbol name = take(OBJECTID).symbol;
+        expect(':');
+        Symbol type = take(TYPEID).symbol;
+        Expression init = node_at(at, no_expr());
+        if (peek() == ASSIGN) {
+          buf.next++;
+          init = parse_expr(ANY);
+        }
+        if (peek() == IN) {
+          buf.next++;
+          return node_at(at, let(name, type, init, parse_expr(ANY)));
+        }
+        expect(',');
+        return node_at(at, let(name, type, init, parse_let_body()));
+      }
+      
+      /* An expression that is the operand of a rule of level rule. */
+      Expression parse_expr(int rule)
+      {
+        nested in(depth);
+        int at = line();
+        Expression e = parse_operand();
+        int assoc;
+        
+        for (int op; (op = level(peek(), assoc)) != 0; ) {
+          if (op < rule || (op == rule && assoc == LEFT))
+            break;
+          if (op == rule && assoc == NONASSOC)
+            throw give_up();
+          
+          int token = buf.tokens[buf.next++].token;
+          if (token == '.') {
+            Symbol name = take(OBJECTID).symbol;
+            e = node_at(at, dispatch(e, name, parse_actuals()));
+            continue;
+          }
+          if (token == '@') {
+            Symbol type = take(TYPEID).symbol;
+            expect('.');
+            Symbol name = take(OBJECTID).symbol;
+            e = node_at(at, static_dispatch(e, type, name, parse_actuals()));
+            continue;
+          }
+          
+          Expression rhs = parse_expr(op);
+          switch (token) {
+            case '+': e = plus(e, rhs);   break;
+            case '-': e = sub(e, rhs);    break;
+            case '*': e = mul(e, rhs);    break;
+            case '/': e = divide(e, rhs); break;
+            case '<': e = lt(e, rhs);     break;
+            case LE:  e = leq(e, rhs);    break;
+            case '=': e = eq(e, rhs);     break;
+          }
+          node_at(at, e);
+        }
+        return e;
+      }
+      
+      Expression parse_operand()
+      {
+        const buffered_token &t = next();
+        int at = t.line;
+        YYSTYPE value = t.value;
+        Expression e;
+        
+        switch (t.token) {
+          case OBJECTID:
+            buf.next++;
+            if (peek() == ASSIGN) {
+              buf.next++;
+              return node_at(at, assign(value.symbol, parse_expr(ASSIGN_LEVEL)));
+            }
+            if (peek() == '(') {
+              Expressions actuals = parse_actuals();
+              return node_at(at, dispatch(node_at(at, object(self_symbol())),
+                                          value.symbol, actuals));
+            }
+            return node_at(at, object(value.symbol));
+          case INT_CONST:
+            buf.next++;
+            return node_at(at, int_const(value.symbol));
+          case BOOL_CONST:
+            buf.next++;
+            return node_at(at, bool_const(value.boolean));
+          case STR_CONST:
+            buf.next++;
+            return node_at(at, string_const(value.symbol));
+          case NEW:
+            buf.next++;
+            return node_at(at, new_(take(TYPEID).symbol));
+          case '~':
+            buf.next++;
+            return node_at(at, neg(parse_expr(NEG_LEVEL)));
+          case ISVOID:
+            buf.next++;
+            return node_at(at, isvoid(parse_expr(ISVOID_LEVEL)));
+          case NOT:
+            buf.next++;
+            return node_at(at, comp(parse_expr(NOT_LEVEL)));
+          case '(':
+            buf.next++;
+            e = parse_expr(ANY);
+            expect(')');
+            return e;
+          case IF: {
+            buf.next++;
+            Expression pred = parse_expr(ANY);
+            expect(THEN);
+            Expression then_exp = parse_expr(ANY);
+            expect(ELSE);
+            Expression else_exp = parse_expr(ANY);
+            expect(FI);
+            return node_at(at, cond(pred, then_exp, else_exp));
+          }
+          case WHILE: {
+            buf.next++;
+            Expression pred = parse_expr(ANY);
+            expect(LOOP);
+            Expression body = parse_expr(ANY);
+            expect(POOL);
+            return node_at(at, loop(pred, body));
+          }
+          case '{': {
+            buf.next++;
+            flat_list<Expression> *body = flat_nil<Expression>();
+            do {
+              body = flat_append(body, parse_expr(ANY));
+              expect(';');
+            } while (peek() != '}');
+            buf.next++;
+            return node_at(at, block(body));
+          }
+          case CASE: {
+            buf.next++;
+            Expression expr = parse_expr(ANY);
+            expect(OF);
+            flat_list<Case> *cases = flat_nil<Case>();
+            do
+              cases = flat_append(cases, parse_branch());
+            while (peek() != ESAC);
+            buf.next++;
+            return node_at(at, typcase(expr, cases));
+          }
+          case LET:
+            buf.next++;
+            return parse_let_body();
+          default:
+            throw give_up();
+        }
+      }
+      
+    public:
+      descent_parser(parse_context *ctx)
+        : ctx(ctx), buf(ctx->replay), first_line(0), classes(NULL),
+          features(NULL), depth(0) { }
+      
+      /* program: false at a syntax error, or too deep a nesting */
+      bool parse()
+      {
+        try {
+          first_line = line();
+          classes = flat_nil<Class_>();
+          do {
+            forget(0);
+            Class_ c = parse_class();
+            classes = flat_append(classes, c);
+            ctx->parse_results = classes;
+            class_done(ctx, c);
+          } while (peek() != 0);
+          ctx->ast_root = node_at(first_line, program(classes));
+          return true;
+        } catch (give_up &) {
+          return false;
+        }
+      }
+      
+      /* The tokens of a lazy_body, up to the '}' or ';' after them: false
+         if they are not an expression, or too deeply nested. */
+      bool parse_body(Expression &body)
+      {
+        try {
+          body = parse_expr(ANY);
+          return buf.next + 2 == buf.tokens.size();
+        } catch (give_up &) {
+          return false;
+        }
+      }
+      
+      /* After parse() gave up inside a class: put the features done
+         before that in front of those the LALR parser gave c, the first
+         class it reduced, which it went on with from there. */
+      void complete(Class_ c)
+      {
+        if (features == NULL)
+          return;
+        Features &tail = static_cast<class__class *>(c)->*class_access::member();
+        for (int j = tail->first(); tail->more(j); j = tail->next(j))
+          features = flat_append(features, tail->nth(j));
+        tail = features;
+        features = NULL;
+      }
+      
+      /* After parse() gave up, and the LALR parser went on from the class
+         or feature it was in without errors: the whole program. */
+      void splice()
+      {
+        Classes rest = ctx->parse_results;
+        int i = rest->first();
+        
+        if (rest->more(i))
+          complete(rest->nth(i));
+        for (; rest->more(i); i = rest->next(i))
+          classes = flat_append(classes, rest->nth(i));
+        ctx->parse_results = classes;
+        ctx->ast_root = node_at(first_line, program(classes));
+      }
+    };
+    
+    /* The classes the LALR parser reduces go to ctx->on_class once the
+       first of them has been completed, so that none is seen short of
+       the features the hand written parser did. */
+    static int descent_parse(parse_context *ctx)
+    {
+      descent_parser parser(ctx);
+      
+      if (parser.parse()) {
+        ctx->replay = token_buffer();
+        return 0;
+      }
+      ctx->replay.next = 0;
+      ctx->ast_root = NULL;
+      ctx->parse_results = NULL;
+      std::function<void(Class_)> on_class = ctx->on_class;
+      if (on_class)
+        ctx->on_class = [&](Class_ c) {
+          parser.complete(c);
+          on_class(c);
+        };
+      int result = cool_yyparse(ctx);
+      ctx->on_class = on_class;
+      if (result == 0 && ctx->errors == 0)
+        parser.splice();
+      return result;
+    }
+    
+    /*
+     * lazy_body (see lazy-body.h).  Its tokens are copied into the arena of
+     * the tree it is part of, so that they go with it.
+     */
+    lazy_body::lazy_body(const buffered_token *from, size_t count, char *filename,
+                         const std::shared_ptr<diagnostics> &diag)
+      : count(count), filename(filename), diag(diag.get()),
+        arena(&node_arena::current()), expr(NULL), error_count(0)
+    {
+      size_t bytes = (count + 1) * sizeof(buffered_token);
+      
+      arena->keep(diag);      
+      tokens = (buffered_token *) arena->alloc_bytes(bytes, PHYLUM_EXPRESSION);
+      memcpy(tokens, from, count * sizeof(buffered_token));
+      tokens[count] = tokens[count - 1];
+      tokens[count].token = 0;
+    }
+    
+    Expression lazy_body::body()
+    {
+      if (expr == NULL) {
+        node_arena::scope in(arena);
+        expr = parse_tokens();
+      }
+      return expr;
+    }
+    
+    /* With the hand written parser, or, when it gives up, with the tables
+       and a class around the tokens, as the body of a method or attribute
+       as they were found in, so that errors are reported as in that. */
+    Expression lazy_body::parse_tokens()
+    {
+      parse_context part(NULL);
+      const buffered_token &end = tokens[count - 1];
+      Expression e;
+      
+      part.filename = filename;
+      if (diag != NULL)               /* which the parse does not own */
+        part.diag = std::shared_ptr<diagnostics>(diag, [](diagnostics *) { });
+      part.replay.tokens.assign(tokens, tokens + count + 1);
+      part.replay.next = 0;
+      descent_parser parser(&part);
+      if (parser.parse_body(e))
+        return e;
+      
+      YYSTYPE object, self, none = YYSTYPE();
+      object.symbol = object_symbol();
+      self.symbol = self_symbol();
+      std::vector<buffered_token> &wrapped = part.replay.tokens;
+      auto add = [&](int token, int line) {
+        buffered_token t = { token, line, none };
+        if (token == TYPEID)
+          t.value = object;
+        else if (token == OBJECTID)
+          t.value = self;
+        wrapped.push_back(t);
+      };
+      
+      bool method = end.token == '}';
+      const int method_head[] = { CLASS, TYPEID, '{', OBJECTID, '(', ')', ':',
+                                  TYPEID, '{' };
+      const int attr_head[] = { CLASS, TYPEID, '{', OBJECTID, ':', TYPEID, ASSIGN };
+      const int *head = method ? method_head : attr_head;
+      size_t head_size = method ? 9 : 7;
+      int at = tokens[0].line;
+      
+      wrapped.clear();
+      for (size_t i = 0; i < head_size; i++)
+        add(head[i], at);
+      wrapped.insert(wrapped.end(), tokens, tokens + count);
+      if (method)
+        add(';', end.line);
+      add('}', end.line);
+      add(';', end.line);
+      add(0, end.line);
+      part.replay.next = 0;
+      
+      if (cool_yyparse(&part) == 0 && part.errors == 0) {
+        Classes classes = part.parse_results;
+        class__class *c = static_cast<class__class *>(classes->nth(0));
+        Feature f = (c->*class_access::member())->nth(0);
+        if (method)
+          return static_cast<method_class *>(f)->*method_access::body();
+        return static_cast<attr_class *>(f)->*attr_access::body();
+      }
+      error_count = std::max(part.errors, 1);
+      return node_at(at, no_expr());
+    }
+    
+    /*
+     * push_parser.  What is pushed is what ctx->tokens would hold: for
+     * each file a "#name" line and a binary token stream.  A block is
+     * decoded once all of it has come and its tokens pushed into the
+     * tables straight away, so that a class is reduced, and given to
+     * ctx->on_class, as soon as the block with its last token is in.  If
+     * the header of the first stream has been read from ctx->tokens
+     * already, as stream_parse() does, the bytes pushed start at its
+     * first block.  A file sent as its tree from the parse cache has no
+     * tokens to push and is passed over.
+     */
+    push_parser::push_parser(parse_context *ctx)
+      : state(ctx->stream.started && !ctx->stream.done ? BLOCKS : NAME), ctx(ctx),
+        parser(cool_yypstate_new()), status(YYPUSH_MORE)
+    {
+    }
+    
+    push_parser::~push_parser()
+    {
+      cool_yypstate_delete(parser);
+    }
+    
+    bool push_parser::push(const char *bytes, size_t n)
+    {
+      if (status != YYPUSH_MORE)
+        return false;
+      if (input.empty()) {
+        size_t used = decode(bytes, n);
+        input.assign(bytes + used, bytes + n);
+      } else {
+        input.insert(input.end(), bytes, bytes + n);
+        input.erase(input.begin(), input.begin() + decode(input.data(), input.size()));
+      }
+      return status == YYPUSH_MORE;
+    }
+    
+    /* Returns what cool_yyparse() would have. */
+    int push_parser::finish()
+    {
+      if (status == YYPUSH_MORE) {
+        if (state == BLOCKS || (state == HEADER && !input.empty()))
+          stream_error("truncated binary token stream");
+        YYSTYPE none = YYSTYPE();
+        push_token(0, &none);
+      }
+      return status;
+    }
+    
+    /* The length of the block bytes starts with, or 0 if fewer than n. */
+    static size_t block_size(const char *bytes, size_t n)
+    {
+      const size_t word = sizeof(unsigned);
+      size_t at = word;
+      
+      if (n < at)
+        return 0;
+      for (unsigned nsyms = word_at(bytes, 0); nsyms > 0; nsyms--) {
+        if (at + 2 * word > n)
+          return 0;
+        at += 2 * word + word_at(bytes, at + word);
+      }
+      if (at + word > n)
+        return 0;
+      at += word + 3 * word * (size_t) word_at(bytes, at);
+      return at <= n ? at : 0;
+    }
+    
+    /* Decode and push what can be of bytes; returns how much that was. */
+    size_t push_parser::decode(const char *bytes, size_t n)
+    {
+      token_stream &stream = ctx->stream;
+      size_t at = 0;
+      
+      while (status == YYPUSH_MORE && at < n) {
+        const char *p = bytes + at;
+        
+        if (state == NAME) {
+          if (*p == '#') {
+            const char *end = (const char *) memchr(p, '\n', n - at);
+            if (end == NULL)
+              break;
+            set_name(ctx, std::string(p + 1, end));
+            at += end + 1 - p;
+          }
+          state = HEADER;
+        } else if (state == HEADER) {
+          if ((unsigned char) *p != (TOKEN_STREAM_MAGIC & 0xff))
+            stream_error("push_parser: not a binary token stream");
+          size_t size = header_size(p, n - at);
+          if (size == 0)
+            break;
+          buffer_source in = { p };
+          start_stream(ctx, in);
+          stream.binary = true;
+          at += size;
+          state = stream.cached ? NAME : BLOCKS;
+        } else {
+          size_t size = block_size(p, n - at);
+          if (size == 0)
+            break;
+          buffer_source in = { p };
+          read_block(ctx, in);
+          at += size;
+          if (stream.done)
+            state = NAME;
+          while (stream.next < stream.count && status == YYPUSH_MORE) {
+            YYSTYPE value;
+            stream.next++;
+            int token = stream_token(ctx, &value);
+            push_token(token, &value);
+          }
+        }
+      }
+      return at;
+    }
+    
+    /* As token_stream_lex() does for the pull parser. */
+    void push_parser::push_token(int token, YYSTYPE *value)
+    {
+      YYLTYPE line = ctx->lineno;
+      
+      ctx->last_token = token;
+      ctx->last_value = *value;
+      status = cool_yypush_parse(parser, token, value, &line, ctx);
+    }
     
+    /* COOL_PARSER=stream: read a binary token stream with read(), as
+       much as the lexer has written each time, and push it. */
+    static int stream_parse(parse_context *ctx)
+    {
+      /* Unbuffered, ctx->tokens has read no further than start_file()
+         asked, and read() goes on from there. */
+      if (setvbuf(ctx->tokens, NULL, _IONBF, 0) != 0)
+        return cool_yyparse(ctx);
+      ctx->stream.started = true;
+      if (!start_file(ctx) || !ctx->stream.binary)
+        return cool_yyparse(ctx);
+      
+      push_parser parser(ctx);
+      std::vector<char> chunk(1 << 16);
+      ssize_t n;
+      while ((n = read(fileno(ctx->tokens), chunk.data(), chunk.size())) > 0)
+        if (!parser.push(chunk.data(), n))
+          break;
+      return parser.finish();
+    }
+    
+    static size_t parse_threads()
+    {
+      const char *threads = getenv("COOL_PARSE_THREADS");
+      
+      if (threads != NULL && atoi(threads) > 0)
+        return atoi(threads);
+      return std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    /* A piece of a program read by parallel_parse(): whole classes, the
+       file each of its tokens came from, and what parsing it alone gave. */
+    struct program_piece {
+      std::vector<buffered_token> tokens;
+      std::vector<std::pair<size_t, char *> > files;  /* first token, name */
+      int end_line;                   /* of its last token, or of the input */
+      parse_context part;
+      std::shared_ptr<node_arena> arena;
+      int status;
+      
+      program_piece() : end_line(0), part(NULL), status(0) { }
+    };
+    
+    /* Parse the tokens of pieces [first, last) as a whole program, each
+       token under the name of the file it came from, as the tables would
+       have read them from ctx->tokens. */
+    static int push_pieces(parse_context *ctx, program_piece *const *first,
+                           program_piece *const *last)
+    {
+      cool_yypstate *parser = cool_yypstate_new();
+      int status = YYPUSH_MORE;
+      
+      for (program_piece *const *p = first; p < last && status == YYPUSH_MORE; p++) {
+        const program_piece &piece = **p;
+        size_t file = 0;
+        for (size_t i = 0; i < piece.tokens.size() && status == YYPUSH_MORE; i++) {
+          if (file < piece.files.size() && piece.files[file].first == i) {
+            ctx->filename = piece.files[file++].second;
+            ctx->filename_sym = NULL;
+          }
+          buffered_token t = piece.tokens[i];
+          ctx->lineno = t.line;
+          ctx->last_token = t.token;
+          ctx->last_value = t.value;
+          status = cool_yypush_parse(parser, t.token, &t.value, &t.line, ctx);
+        }
+      }
+      if (status == YYPUSH_MORE) {
+        YYSTYPE none = YYSTYPE();
+        YYLTYPE line = first < last ? last[-1]->end_line : ctx->lineno;
+        ctx->lineno = line;
+        ctx->last_token = 0;
+        ctx->last_value = none;
+        status = cool_yypush_parse(parser, 0, &none, &line, ctx);
+      }
+      cool_yypstate_delete(parser);
+      return status;
+    }
+    
+    /*
+     * COOL_PARSER=parallel: read the program, cut it into pieces of whole
+     * classes at CLASS tokens outside any braces, and parse the pieces on
+     * parse_threads() threads as they are read, each on its own as a
+     * program, with no errors reported and into an arena of its own.  If
+     * none has errors, the program is all of them, which is what parsing
+     * it in one go gives: each piece is a class_list.  Otherwise the
+     * pieces before the first with errors are the start of the program,
+     * and the rest is parsed again in one go from there, so that its
+     * errors, and the recovery from them, come out as they would have;
+     * the tables are in the same state at the start of a class whatever
+     * classes came before.
+     */
+    static int parallel_parse(parse_context *ctx)
+    {
+      size_t threads = parse_threads();
+      if (threads == 1)
+        return cool_yyparse(ctx);
+      
+      /* A piece starts at a class and is at least size tokens long, for
+         about 4 pieces a thread; a binary stream takes 12 bytes a token,
+         a text one more. */
+      struct stat file;
+      size_t size = 4096;
+      if (fstat(fileno(ctx->tokens), &file) == 0 && S_ISREG(file.st_mode))
+        size = std::max<size_t>(file.st_size / 12 / (4 * threads), size);
+      
+      std::vector<std::unique_ptr<program_piece> > pieces;
+      std::mutex lock;                /* over pieces, next and read_all */
+      std::condition_variable ready;
+      size_t next = 0;
+      bool read_all = false;
+      auto work = [&]() {
+        for (;;) {
+          program_piece *piece;
+          {
+            std::unique_lock<std::mutex> hold(lock);
+            ready.wait(hold, [&]() { return next < pieces.size() || read_all; });
+            if (next == pieces.size())
+              return;
+            piece = pieces[next++].get();
+          }
+          piece->arena = std::make_shared<node_arena>();
+          node_arena::scope in(piece->arena.get());
+          piece->status = push_pieces(&piece->part, &piece, &piece + 1);
+        }
+      };
+      std::vector<std::thread> pool;
+      for (size_t t = 1; t < threads; t++)
+        pool.push_back(std::thread(work));
+      
+      /* Read on this thread, handing each piece over once it is cut. */
+      std::unique_ptr<program_piece> piece(new program_piece);
+      int nesting = 0;
+      for (;;) {
+        buffered_token t;
+        t.token = next_token(ctx, &t.value);
+        t.line = ctx->lineno;
+        if (t.token == 0)
+          break;
+        if (t.token == '{')
+          nesting++;
+        else if (t.token == '}')
+          nesting--;
+        else if (t.token == CLASS && nesting == 0 && piece->tokens.size() >= size) {
+          piece->end_line = piece->tokens.back().line;
+          std::lock_guard<std::mutex> hold(lock);
+          pieces.push_back(std::move(piece));
+          piece.reset(new program_piece);
+          ready.notify_one();
+        }
+        if (piece->files.empty() || piece->files.back().second != ctx->filename)
+          piece->files.push_back(std::make_pair(piece->tokens.size(), ctx->filename));
+        piece->tokens.push_back(t);
+      }
+      piece->end_line = ctx->lineno;
+      {
+        std::lock_guard<std::mutex> hold(lock);
+        pieces.push_back(std::move(piece));
+        read_all = true;
+      }
+      ready.notify_all();
+      work();
+      for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+      
+      flat_list<Class_> *classes = flat_nil<Class_>();
+      size_t done = 0;
+      for (; done < pieces.size() && pieces[done]->status == 0 &&
+             pieces[done]->part.errors == 0; done++) {
+        node_arena::current().adopt(*pieces[done]->arena);
+        Classes got = pieces[done]->part.parse_results;
+        for (int j = got->first(); got->more(j); j = got->next(j)) {
+          classes = flat_append(classes, got->nth(j));
+          class_done(ctx, got->nth(j));
+        }
+      }
+      if (done < pieces.size()) {
+        std::vector<program_piece *> rest;
+        for (size_t i = done; i < pieces.size(); i++)
+          rest.push_back(pieces[i].get());
+        int result = push_pieces(ctx, rest.data(), rest.data() + rest.size());
+        
+        Classes after = ctx->parse_results;
+        if (done > 0 && after != NULL) {
+          for (int j = after->first(); after->more(j); j = after->next(j))
+            classes = flat_append(classes, after->nth(j));
+          ctx->parse_results = classes;
+          ctx->ast_root = node_at(pieces[0]->part.ast_root->get_line_number(),
+                                  program(classes));
+        }
+        return result;
+      }
+      
+      ctx->filename = pieces.back()->files.back().second;
+      ctx->filename_sym = NULL;
+      ctx->parse_results = classes;
+      ctx->ast_root = node_at(pieces[0]->part.ast_root->get_line_number(), program(classes));
+      return 0;
+    }
+    
+    /* The stream of one file: its blocks, or the cache's entry for it,
+       which the lexer sent instead; end is where the stream ends in the
+       input of split_files(). */
+    struct file_tokens {
+      char *name;
+      bool keyed;
+      uint32_t key[4];
+      bool cached;
+      std::string lexer;
+      const char *bytes;
+      size_t size;
+      size_t end;
+    };
+    
+    /* Split input, the rest of ctx->tokens after start_file(), into the
+       streams of its files; false if it is not all binary streams. */
+    static bool split_files(parse_context *ctx, const std::vector<char> &input,
+                            std::vector<file_tokens> &files)
+    {
+      const char *bytes = input.data();
+      size_t n = input.size(), at = 0;
+      parse_context next(NULL);       /* for the headers after the first */
+      const parse_context *header = ctx;
+      
+      next.filename = ctx->filename;
+      for (;;) {
+        const token_stream &stream = header->stream;
+        file_tokens f = { header->filename, stream.keyed, { 0 }, stream.cached,
+                          stream.lexer, bytes + at, 0, 0 };
+        memcpy(f.key, stream.key, sizeof(f.key));
+        if (f.cached) {
+          /* The entry ends the header, read already; the first file's
+             went into ctx->stream. */
+          f.size = stream.entry.size();
+          f.bytes = header == ctx ? stream.entry.data() : bytes + at - f.size;
+        } else {
+          /* The blocks, up to the empty one, the only block of 2 words. */
+          size_t size;
+          do {
+            size = block_size(bytes + at, n - at);
+            if (size == 0)
+              return false;
+            at += size;
+          } while (size != 2 * sizeof(unsigned));
+          f.size = bytes + at - f.bytes;
+        }
+        f.end = at;
+        files.push_back(f);
+        if (at == n)
+          return true;
+        
+        if (bytes[at] == '#') {
+          const char *end = (const char *) memchr(bytes + at, '\n', n - at);
+          if (end == NULL)
+            return false;
+          set_name(&next, std::string(bytes + at + 1, end));
+          at = end + 1 - bytes;
+        }
+        size_t size = header_size(bytes + at, n - at);
+        if (size == 0)
+          return false;
+        buffer_source in = { bytes + at };
+        start_stream(&next, in);
+        at += size;
+        header = &next;
+      }
+    }
+    
+    /* Set ctx to read the blocks of f. */
+    static void begin_file(parse_context *ctx, const file_tokens &f)
+    {
+      token_stream &stream = ctx->stream;
+      
+      ctx->filename = f.name;
+      ctx->filename_sym = NULL;
+      stream.started = stream.binary = true;
+      stream.keyed = f.keyed;
+      stream.cached = false;
+      stream.symbols.clear();
+      stream.done = false;
+      stream.count = stream.next = 0;
+    }
+    
+    extern char **environ;
+    
+    /*
+     * Have the lexer that sent the entry of f, which this parser cannot
+     * use, lex its file again without the cache, and leave what it writes,
+     * a "#name" line and a token stream, in tokens; false if it could not
+     * be run.
+     */
+    static bool lex_again(const file_tokens &f, std::vector<char> &tokens)
+    {
+      std::vector<char *> env;
+      std::string format = "COOL_TOKEN_FORMAT=binary";
+      char *argv[] = { (char *) f.lexer.c_str(), f.name, NULL };
+      posix_spawn_file_actions_t actions;
+      int out[2], status;
+      pid_t pid;
+      
+      for (char **e = environ; *e != NULL; e++)
+        if (strncmp(*e, "COOL_PARSE_CACHE=", 17) != 0 &&
+            strncmp(*e, "COOL_TOKEN_FORMAT=", 18) != 0)
+          env.push_back(*e);
+      env.push_back(&format[0]);
+      env.push_back(NULL);
+      if (pipe(out) != 0)
+        return false;
+      posix_spawn_file_actions_init(&actions);
+      posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+      posix_spawn_file_actions_addclose(&actions, out[0]);
+      posix_spawn_file_actions_addclose(&actions, out[1]);
+      int failed = posix_spawn(&pid, argv[0], &actions, NULL, argv, env.data());
+      posix_spawn_file_actions_destroy(&actions);
+      close(out[1]);
+      
+      char chunk[1 << 16];
+      ssize_t got;
+      tokens.clear();
+      while (!failed && (got = read(out[0], chunk, sizeof(chunk))) > 0)
+        tokens.insert(tokens.end(), chunk, chunk + got);
+      close(out[0]);
+      return !failed && waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+        WEXITSTATUS(status) == 0 && !tokens.empty();
+    }
+    
+    /* Parse the n bytes of tokens at bytes into part: the blocks of a
+       file after begin_file(), or, with part->stream.started false, a
+       "#name" line and a whole stream.  A lazy parse reads them through
+       a FILE, as descent_parse() does. */
+    static int parse_file(parse_context *part, const char *bytes, size_t n)
+    {
+      if (part->lazy_bodies) {
+        FILE *in = fmemopen((void *) bytes, n, "r");
+        if (in == NULL)
+          stream_error("cannot read a token stream from memory");
+        part->tokens = in;
+        int result = descent_parse(part);
+        fclose(in);
+        part->tokens = NULL;
+        return result;
+      }
+      push_parser parser(part);
+      parser.push(bytes, n);
+      return parser.finish();
+    }
+    
+    /*
+     * COOL_PARSE_CACHE=dir (see parse-cache.h): load each file of a
+     * binary token stream the lexer sent the cache's entry for, and parse
+     * each other file on its own, storing its tree if it has a key.  An
+     * entry another build of the parser stored is a miss, and its file is
+     * lexed again.  A file with errors is not stored; it is parsed again
+     * with the files after it, as without the cache, so that its errors
+     * and the recovery from them are the same, the files after it that
+     * came from the cache being lexed again for their tokens.  The files
+     * before it cannot make a difference, each having ended a class, and
+     * their classes go in front of those of the rest.  A lazy parse is
+     * not stored, and reports the errors of each file as it goes.  A text
+     * stream is parsed as usual.
+     *
+     * With ctx->trees set, as cool_yyparse() does, the tree of each file
+     * is left there as a compact_tree instead of in ast_root, so that one
+     * loaded from the cache is dumped as it was loaded, and not expanded.
+     */
+    static int cached_parse(parse_context *ctx, parse_cache &cache)
+    {
+      ctx->stream.started = true;
+      if (!start_file(ctx) || !ctx->stream.binary)
+        return ctx->lazy_bodies ? descent_parse(ctx) : cool_yyparse(ctx);
+      
+      std::vector<char> input;
+      std::vector<file_tokens> files;
+      char chunk[1 << 16];
+      size_t got;
+      while ((got = fread(chunk, 1, sizeof(chunk), ctx->tokens)) > 0)
+        input.insert(input.end(), chunk, chunk + got);
+      
+      flat_list<Class_> *classes = flat_nil<Class_>();
+      int first_line = 0;
+      std::vector<char> again;        /* the tokens of a file lexed again */
+      size_t failed = split_files(ctx, input, files) ? files.size() : 0;
+      for (size_t i = 0; i < failed; i++) {
+        const file_tokens &f = files[i];
+        parse_context part(NULL);
+        compact_tree tree;
+        Program file;
+        
+        begin_file(&part, f);
+        part.lazy_bodies = ctx->lazy_bodies;
+        if (f.cached && cache.load(f.bytes, f.size, tree)) {
+          Symbol name = filename_symbol(&part);
+          if (ctx->trees != nullptr) {
+            tree.set_file(name);
+            ctx->trees->push_back(std::move(tree));
+            continue;
+          }
+          file = tree.expand();
+          Classes got = static_cast<program_class *>(file)->get_classes();
+          for (int j = got->first(); got->more(j); j = got->next(j)) {
+            static_cast<class__class *>(got->nth(j))->*class_access::file() = name;
+            class_done(ctx, got->nth(j));
+          }
+        } else {
+          const char *from = f.bytes;
+          size_t n = f.size;
+          if (f.cached) {
+            if (!lex_again(f, again))
+              stream_error("cannot run the lexer again for an old parse cache entry");
+            from = again.data();
+            n = again.size();
+            part.stream.started = false;
+          }
+          part.on_class = ctx->on_class;
+          if (part.lazy_bodies) {
+            part.diag = ctx->diag;
+            parse_file(&part, from, n);
+            ctx->errors += part.errors;
+            if (part.ast_root == NULL)
+              continue;
+          } else if (parse_file(&part, from, n) != 0 || part.errors != 0) {
+            failed = i;
+            break;
+          }
+          again.clear();
+          file = part.ast_root;
+          if ((f.keyed || ctx->trees != nullptr) && !part.lazy_bodies)
+            tree.build(file);
+          if (f.keyed && !part.lazy_bodies)
+            cache.store(f.key, tree);
+          if (ctx->trees != nullptr) {
+            ctx->trees->push_back(std::move(tree));
+            continue;
+          }
+        }
+        if (i == 0)
+          first_line = file->get_line_number();
+        Classes got = static_cast<program_class *>(file)->get_classes();
+        for (int j = got->first(); got->more(j); j = got->next(j))
+          classes = flat_append(classes, got->nth(j));
+      }
+      
+      if (failed < files.size() || files.empty()) {
+        /* The classes before the error have been handed over already. */
+        std::function<void(Class_)> on_class = ctx->on_class;
+        if (ctx->trees != nullptr) {
+          for (size_t i = 0; i < ctx->trees->size(); i++) {
+            Program file = (*ctx->trees)[i].expand();
+            Classes got = static_cast<program_class *>(file)->get_classes();
+            if (i == 0)
+              first_line = file->get_line_number();
+            for (int j = got->first(); got->more(j); j = got->next(j))
+              classes = flat_append(classes, got->nth(j));
+          }
+          ctx->trees->clear();
+        }
+        ctx->on_class = nullptr;
+        if (!files.empty()) {
+          begin_file(ctx, files[failed]);
+          ctx->stream.started = !files[failed].cached;
+        }
+        push_parser parser(ctx);
+        if (files.empty())
+          parser.push(input.data(), input.size());
+        for (size_t i = failed; i < files.size(); i++) {
+          const file_tokens &f = files[i];
+          if (f.cached) {
+            if (i > failed && !lex_again(f, again))
+              stream_error("cannot run the lexer again for a parse cache entry");
+            parser.push(again.data(), again.size());
+          } else if (i == failed)
+            parser.push(f.bytes, f.size);
+          else
+            parser.push(input.data() + files[i - 1].end, f.end - files[i - 1].end);
+        }
+        int result = parser.finish();
+        ctx->on_class = on_class;
+        
+        Classes rest = ctx->parse_results;
+        if (failed > 0 && rest != NULL) {
+          for (int j = rest->first(); rest->more(j); j = rest->next(j))
+            classes = flat_append(classes, rest->nth(j));
+          ctx->parse_results = classes;
+          ctx->ast_root = node_at(first_line, program(classes));
+        }
+        return result;
+      }
+      ctx->filename = files.back().name;
+      ctx->filename_sym = NULL;
+      if (ctx->trees == nullptr) {
+        ctx->parse_results = classes;
+        ctx->ast_root = node_at(first_line, program(classes));
+      }
+      return 0;
+    }
+    
+    /* With -v, how the cache did. */
+    static void print_cache_stats()
+    {
+      parse_cache *cache = shared_cache();
+      
+      if (verbose_flag && cache != NULL)
+        cerr << "parse cache: " << cache->hits << " hits, "
+             << cache->misses << " misses\n";
+    }
+    
+    /* Whether COOL_PARSER names backend. */
+    static bool parser_backend(const char *backend)
+    {
+      static const char *chosen = getenv("COOL_PARSER");
+      
+      return chosen != NULL && strcmp(chosen, backend) == 0;
+    }
+    
+    static int parse(parse_context *ctx)
+    {
+      if (shared_cache() != NULL)
+        return cached_parse(ctx, *shared_cache());
+      if (ctx->lazy_bodies)
+        return descent_parse(ctx);
+      if (parser_backend("descent"))
+        return descent_parse(ctx);
+      if (parser_backend("stream"))
+        return stream_parse(ctx);
+      if (parser_backend("parallel"))
+        return parallel_parse(ctx);
+      return cool_yyparse(ctx);
+    }
+    
+    /* COOL_AST_FORMAT=outline: parse with lazy bodies and print the
+       signatures of the program instead of its tree (see print_outline()). */
+    static bool outline_ast()
+    {
+      const char *format = getenv("COOL_AST_FORMAT");
+      
+      return format != NULL && strcmp(format, "outline") == 0;
+    }
+    
+    /*
+     * The outline of a program, for class hierarchies, method tables and
+     * editors: a line for each class, with its parent, and one for each of
+     * its features, with the types of a method's formals and result or
+     * the type of an attribute, each headed by file and line as errors
+     * are.  Only signatures are looked at, so the bodies of a lazy parse
+     * are never parsed, and errors in them are not found.
+     */
+    static void print_outline(Program tree, ostream &out)
+    {
+      Classes classes = static_cast<program_class *>(tree)->get_classes();
+      
+      for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+        class__class *c = static_cast<class__class *>(classes->nth(i));
+        Symbol file = c->*class_access::file();
+        Features features = c->*class_access::member();
+        
+        out << "\"" << file << "\", line " << c->get_line_number() << ": class "
+            << c->*class_access::class_name() << " inherits "
+            << c->*class_access::parent_name() << "\n";
+        for (int j = features->first(); features->more(j); j = features->next(j)) {
+          Feature f = features->nth(j);
+          out << "\"" << file << "\", line " << f->get_line_number() << ":   ";
+          if (method_class *m = dynamic_cast<method_class *>(f)) {
+            Formals formals = m->*method_access::formal_list();
+            out << "method " << m->*method_access::method_name() << "(";
+            for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
+              formal_class *x = static_cast<formal_class *>(formals->nth(k));
+              out << (k == formals->first() ? "" : ", ")
+                  << x->*formal_access::formal_name() << " : "
+                  << x->*formal_access::type();
+            }
+            out << ") : " << m->*method_access::result() << "\n";
+          } else {
+            attr_class *a = static_cast<attr_class *>(f);
+            out << "attr " << a->*attr_access::attr_name() << " : "
+                << a->*attr_access::type() << "\n";
+          }
+        }
+      }
+    }
+    
+    /*
+     * The text dump of each class, made as soon as the class is reduced
+     * (see class_done()) when COOL_PARSER=stream reads the tokens from a
+     * pipe, so that the dump of the first classes is done while the rest
+     * is still being read.  Other parses dump the program once it is
+     * done, straight to the driver's stream.  It is kept in a temporary file until the parse is over,
+     * since a program with errors is not dumped at all.
+     */
+    class dumped_classes {
+    public:
+      int count;
+      
+      dumped_classes() : count(0), text(tmpfile()) { }
+      ~dumped_classes()
+      {
+        if (text != NULL)
+          fclose(text);
+      }
+      
+      void add(Class_ c)
+      {
+        compact_tree compact;
+        std::ostringstream out;
+        
+        if (text == NULL)
+          return;
+        compact.build(program(flat_single(c)));
+        compact.dump(out);
+        /* all but the "#line" and "_program" of the program */
+        const std::string &dump = out.str();
+        size_t from = dump.find('\n', dump.find('\n') + 1) + 1;
+        fwrite(dump.data() + from, 1, dump.size() - from, text);
+        count++;
+      }
+      
+      /* Whether every dump made it into the file. */
+      bool kept()
+      {
+        return text != NULL && fflush(text) == 0 && !ferror(text);
+      }
+      
+      void copy(std::ostream &out)
+      {
+        char chunk[1 << 16];
+        size_t got;
+        
+        rewind(text);
+        while ((got = fread(chunk, 1, sizeof(chunk), text)) > 0)
+          out.write(chunk, got);
+      }
+      
+    private:
+      FILE *text;
+      
+      dumped_classes(const dumped_classes &);
+      dumped_classes &operator=(const dumped_classes &);
+    };
+    
+    /* What ast_root becomes, so that the dump_with_types() of the driver
+       goes through a compact_tree, which needs no C stack for deep trees,
+       and writes the outline with COOL_AST_FORMAT=outline.  The classes
+       already dumped as they were reduced are not dumped again.  Made
+       from the trees cached_parse() left, one per file, it dumps those,
+       and only builds the program from them if asked for anything else. */
+    class compact_program : public Program_class {
+    private:
+      Program tree;
+      std::shared_ptr<std::vector<compact_tree> > files;
+      std::shared_ptr<dumped_classes> dumped;
+      
+      Program whole()
+      {
+        if (tree == NULL) {
+          flat_list<Class_> *classes = flat_nil<Class_>();
+          for (size_t i = 0; i < files->size(); i++) {
+            Program file = (*files)[i].expand();
+            Classes got = static_cast<program_class *>(file)->get_classes();
+            for (int j = got->first(); got->more(j); j = got->next(j))
+              classes = flat_append(classes, got->nth(j));
+          }
+          tree = node_at((*files)[0].line((*files)[0].root), program(classes));
+        }
+        return tree;
+      }
+      
+    public:
+      compact_program(Program tree, std::shared_ptr<dumped_classes> dumped = nullptr)
+        : tree(tree), dumped(dumped) { }
+      compact_program(std::shared_ptr<std::vector<compact_tree> > files)
+        : tree(NULL), files(files) { }
+      Program copy_Program() { return new compact_program(whole()->copy_Program()); }
+      void dump(ostream& stream, int n) { whole()->dump(stream, n); }
+      void dump_with_types(ostream& stream, int)
+      {
+        if (outline_ast()) {
+          print_outline(whole(), stream);
+          return;
+        }
+        if (tree == NULL) {
+          const compact_tree &first = (*files)[0];
+          stream << "#" << first.line(first.root) << "\n_program\n";
+          for (size_t i = 0; i < files->size(); i++)
+            (*files)[i].dump(stream, false);
+          return;
+        }
+        Classes classes = static_cast<program_class *>(tree)->get_classes();
+        if (dumped != nullptr && dumped->count == classes->len() && dumped->kept()) {
+          stream << "#" << tree->get_line_number() << "\n_program\n";
+          dumped->copy(stream);
+          stream.flush();
+          return;
+        }
+        compact_tree compact;
+        compact.build(tree);
+        compact.dump(stream);
+      }
+      uint32_t compact(compact_tree &t) { return whole()->compact(t); }
+      uint32_t walk(tree_walk &t) { return whole()->walk(t); }
+    };
+    
+    /*
+     * The compiler's entry point: parse token_file, leaving the results in
+     * the globals at the top of the file as before.
+     */
+    /* COOL_ERROR_LIMIT: how many syntax errors a parse may have before it
+       stops, 50 by default. */
+    static size_t error_limit()
+    {
+      const char *limit = getenv("COOL_ERROR_LIMIT");
+      
+      if (limit != NULL && atoi(limit) > 0)
+        return atoi(limit);
+      return 50;
+    }
+    
+    int cool_yyparse()
+    {
+      parse_context ctx(token_file);
+      std::shared_ptr<dumped_classes> dumped;
+      ctx.diag = std::make_shared<diagnostics>(error_limit(), &cerr);
+      ctx.lazy_bodies = outline_ast();
+      struct stat st;
+      if (!ctx.lazy_bodies && parser_backend("stream") &&
+          fstat(fileno(token_file), &st) == 0 && S_ISFIFO(st.st_mode)) {
+        dumped = std::make_shared<dumped_classes>();
+        ctx.on_class = [dumped](Class_ c) { dumped->add(c); };
+      }
+      if (!ctx.lazy_bodies)
+        ctx.trees = std::make_shared<std::vector<compact_tree> >();
+      int result = parse(&ctx);
+      
+      if ((size_t) ctx.errors > ctx.diag->limit)
+        fprintf(stdout, "More than %zu errors\n", ctx.diag->limit);
+      ast_root = ctx.ast_root;
+      parse_results = ctx.parse_results;
+      omerrs += ctx.errors;
+      curr_filename = ctx.filename;
+      print_cache_stats();
+      if (ast_root != NULL)
+        ast_root = new compact_program(ast_root, dumped);
+      else if (result == 0 && ctx.errors == 0 && ctx.trees != nullptr &&
+               !ctx.trees->empty())
+        ast_root = new compact_program(ctx.trees);  /* parse_results stays NULL */
+      if (getenv("COOL_MEM_STATS") != NULL && ast_root != NULL) {
+        compact_tree compact;
+        compact.build(ast_root);
+        node_arena::current().print_stats(cerr);
+        cerr << "compact tree: " << compact.node_count() << " nodes, "
+             << compact.bytes() << " bytes\n";
+      }
+      return result;
+    }
+    
+    /*
+     * Parse several binary token streams at once, one per file, on up to
+     * parse_threads() threads.  results[i] is the context the stream in
+     * files[i] was parsed with, holding its tree, and its errors in a
+     * diagnostics of its own that writes them nowhere; each tree is
+     * allocated from the context's own arena and freed with it.  With
+     * lazy_bodies, the expressions of features are left to be parsed when
+     * asked for (see lazy-body.h).
+     */
+    void parse_token_files(const std::vector<FILE *> &files,
+                           std::vector<parse_context> &results,
+                           bool lazy_bodies)
+    {
+      std::atomic<size_t> next(0);
+      std::vector<std::thread> pool;
+      size_t threads = parse_threads();
+      
+      results.clear();
+      for (size_t i = 0; i < files.size(); i++) {
+        results.push_back(parse_context(files[i]));
+        results.back().arena = std::make_shared<node_arena>();
+        results.back().lazy_bodies = lazy_bodies;
+        results.back().diag = std::make_shared<diagnostics>(error_limit());
+      }
+      
+      auto work = [&]() {
+        for (size_t i; (i = next++) < files.size(); ) {
+          node_arena::scope in(results[i].arena.get());
+          parse(&results[i]);
+        }
+      };
+      for (size_t t = 1; t < std::min(threads, files.size()); t++)
+        pool.push_back(std::thread(work));
+      work();
+      for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+      print_cache_stats();
+    }
+    
+    /*
+     * compact_tree (see compact-tree.h).
+     */
+    compact_tree::compact_tree() : root(0)
+    {
+      symbols.push_back(NULL);
+    }
+    
+    compact_tree::ref compact_tree::add(kind k, int line, uint32_t f0,
+                                        uint32_t f1, uint32_t f2, uint32_t f3)
+    {
+      pool &p = pools[k];
+      uint32_t values[MAX_FIELDS] = { f0, f1, f2, f3 };
+      uint32_t row = p.line.size();
+      
+      if (row > row_of(~0u)) {
+        cerr << "compact_tree: too many nodes\n";
+        abort();
+      }
+      ref r = ((ref) k << (32 - KIND_BITS)) | row;
+      const char *f = fields(k);
+      p.line.push_back(line);
+      for (int i = 0; i < arity(k); i++) {
+        /* A subtree from put() goes here once build() has compacted it. */
+        if (k != KIND_LIST && f[i] == 'e' && values[i] != 0) {
+          pending[values[i] - 1].owner = r;
+          pending[values[i] - 1].slot = i;
+          values[i] = 0;
+        }
+        p.fields[i].push_back(values[i]);
+      }
+      if (is_expression(k))
+        p.type.push_back(0);
+      return r;
+    }
+    
+    /* With elems NULL the items are left 0, for set_child() to fill in. */
+    compact_tree::ref compact_tree::add_list(const ref *elems, size_t n)
+    {
+      ref list = add(KIND_LIST, 0, items.size(), n);
+      if (elems != NULL)
+        items.insert(items.end(), elems, elems + n);
+      else
+        items.resize(items.size() + n);
+      return list;
+    }
+    
+    uint32_t compact_tree::symbol_id(Symbol sym)
+    {
+      if (sym == NULL)
+        return 0;
+      std::pair<std::unordered_map<Symbol, uint32_t>::iterator, bool> in =
+        ids.insert(std::make_pair(sym, (uint32_t) symbols.size()));
+      if (in.second)
+        symbols.push_back(sym);
+      return in.first->second;
+    }
+    
+    size_t compact_tree::node_count() const
+    {
+      size_t n = 0;
+      for (int k = 0; k < KIND_LIST; k++)
+        n += pools[k].line.size();
+      return n;
+    }
+    
+    size_t compact_tree::bytes() const
+    {
+      size_t n = items.capacity() * sizeof(ref)
+        + symbols.capacity() * sizeof(Symbol)
+        + ids.size() * (sizeof(Symbol) + sizeof(uint32_t) + sizeof(void *))
+        + ids.bucket_count() * sizeof(void *);
+      for (int k = 0; k < KINDS; k++) {
+        n += (pools[k].line.capacity() + pools[k].type.capacity())
+          * sizeof(uint32_t);
+        for (int i = 0; i < MAX_FIELDS; i++)
+          n += pools[k].fields[i].capacity() * sizeof(uint32_t);
+      }
+      return n;
+    }
+    
+    /* Walking the subtrees of a node: next_child() gives the one from the
+       field (or list item) i on, if any, and steps i past it. */
+    bool compact_tree::next_child(ref r, uint32_t &i, ref &child) const
+    {
+      kind k = kind_of(r);
+      
+      if (k == KIND_LIST) {
+        if (i >= list_len(r))
+          return false;
+        child = list_nth(r, i++);
+        return true;
+      }
+      for (const char *f = fields(k); f[i] != '\0'; i++)
+        if (is_subtree(f[i])) {
+          child = field(r, i++);
+          return true;
+        }
+      return false;
+    }
+    
+    void compact_tree::set_child(ref r, uint32_t i, ref child)
+    {
+      if (kind_of(r) == KIND_LIST)
+        items[field(r, 0) + i] = child;
+      else
+        pools[kind_of(r)].fields[i][row_of(r)] = child;
+    }
+    
+    void compact_tree::build(Program program)
+    {
+      pending.clear();
+      root = program->compact(*this);
+      while (!pending.empty()) {
+        deferred d = pending.back();
+        pending.pop_back();
+        set_child(d.owner, d.slot, d.compact(d.node, *this));
+      }
+      
+      /* The tree is complete: give back what the columns grew past. */
+      pending.shrink_to_fit();
+      items.shrink_to_fit();
+      symbols.shrink_to_fit();
+      for (int k = 0; k < KINDS; k++) {
+        pools[k].line.shrink_to_fit();
+        pools[k].type.shrink_to_fit();
+        for (int i = 0; i < MAX_FIELDS; i++)
+          pools[k].fields[i].shrink_to_fit();
+      }
+    }
+    
+    /* The constructor classes, with their fields in the order of their
+       constructors' arguments, each given to t.put(): NODE for those of
+       the phyla above Expression, EXPRESSION for expressions. */
+    #define CONSTRUCTORS(NODE, EXPRESSION)                                   \
+      NODE(program, PROGRAM, t.put(classes))                                 \
+      NODE(class_, CLASS_, t.put(name), t.put(parent), t.put(features),      \
+           t.put(filename))                                                  \
+      NODE(method, METHOD, t.put(name), t.put(formals), t.put(return_type),  \
+           t.put(expr))                                                      \
+      NODE(attr, ATTR, t.put(name), t.put(type_decl), t.put(init))           \
+      NODE(formal, FORMAL, t.put(name), t.put(type_decl))                    \
+      NODE(branch, BRANCH, t.put(name), t.put(type_decl), t.put(expr))       \
+      EXPRESSION(assign, ASSIGN, t.put(name), t.put(expr))                   \
+      EXPRESSION(static_dispatch, STATIC_DISPATCH, t.put(expr),              \
+                 t.put(type_name), t.put(name), t.put(actual))               \
+      EXPRESSION(dispatch, DISPATCH, t.put(expr), t.put(name),               \
+                 t.put(actual))                                              \
+      EXPRESSION(cond, COND, t.put(pred), t.put(then_exp),                   \
+                 t.put(else_exp))                                            \
+      EXPRESSION(loop, LOOP, t.put(pred), t.put(body))                       \
+      EXPRESSION(typcase, TYPCASE, t.put(expr), t.put(cases))                \
+      EXPRESSION(block, BLOCK, t.put(body))                                  \
+      EXPRESSION(let, LET, t.put(identifier), t.put(type_decl),              \
+                 t.put(init), t.put(body))                                   \
+      EXPRESSION(plus, PLUS, t.put(e1), t.put(e2))                           \
+      EXPRESSION(sub, SUB, t.put(e1), t.put(e2))                             \
+      EXPRESSION(mul, MUL, t.put(e1), t.put(e2))                             \
+      EXPRESSION(divide, DIVIDE, t.put(e1), t.put(e2))                       \
+      EXPRESSION(neg, NEG, t.put(e1))                                        \
+      EXPRESSION(lt, LT, t.put(e1), t.put(e2))                               \
+      EXPRESSION(eq, EQ, t.put(e1), t.put(e2))                               \
+      EXPRESSION(leq, LEQ, t.put(e1), t.put(e2))                             \
+      EXPRESSION(comp, COMP, t.put(e1))                                      \
+      EXPRESSION(int_const, INT_CONST, t.put(token))                         \
+      EXPRESSION(bool_const, BOOL_CONST, t.put(val))                         \
+      EXPRESSION(string_const, STRING_CONST, t.put(token))                   \
+      EXPRESSION(new_, NEW_, t.put(type_name))                               \
+      EXPRESSION(isvoid, ISVOID, t.put(e1))                                  \
+      EXPRESSION(no_expr, NO_EXPR, 0)                                        \
+      EXPRESSION(object, OBJECT, t.put(name))
+    
+    /* Each constructor class adds itself, after its subtrees. */
+    #define COMPACT(cls, kind, ...)                                     \
+    uint32_t cls##_class::compact(compact_tree &t)                      \
+    {                                                                   \
+      return t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__); \
+    }
+    
+    #define COMPACT_EXPRESSION(cls, kind, ...)                          \
+    uint32_t cls##_class::compact(compact_tree &t)                      \
+    {                                                                   \
+      compact_tree::ref r =                                             \
+        t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__);     \
+      t.set_type(r, type);                                              \
+      return r;                                                         \
+    }
+    
+    CONSTRUCTORS(COMPACT, COMPACT_EXPRESSION)
+    
+    /* And for tree_walk, visits itself and leaves its subtrees to it. */
+    #define WALK(cls, kind, ...)                                        \
+    uint32_t cls##_class::walk(tree_walk &t)                            \
+    {                                                                   \
+      return t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__); \
+    }
+    
+    #define WALK_EXPRESSION(cls, kind, ...)                             \
+    uint32_t cls##_class::walk(tree_walk &t)                            \
+    {                                                                   \
+      return t.add(compact_tree::KIND_##kind, line_number, __VA_ARGS__) + \
+             t.put(type);                                               \
+    }
+    
+    CONSTRUCTORS(WALK, WALK_EXPRESSION)
+    
+    void tree_walk::run(Program program)
+    {
+      program->walk(*this);
+      while (!pending.empty()) {
+        step s = pending.back();
+        pending.pop_back();
+        s.second(s.first, *this);
+      }
+    }
+    
+    size_t compact_tree::walk(uint64_t &sum) const
+    {
+      std::vector<ref> stack(1, root);
+      size_t n = 0;
+      
+      sum = 0;
+      while (!stack.empty()) {
+        ref r = stack.back();
+        kind k = kind_of(r);
+        const char *f = fields(k);
+        
+        stack.pop_back();
+        n++;
+        sum += k + line(r);
+        for (int i = 0; f[i] != '\0'; i++) {
+          uint32_t v = field(r, i);
+          sum += v;
+          if (f[i] == 'e')
+            stack.push_back(v);
+          else if (f[i] == 'l')
+            for (size_t j = 0; j < list_len(v); j++)
+              stack.push_back(list_nth(v, j));
+        }
+        if (is_expression(k))
+          sum += pools[k].type[row_of(r)];
+      }
+      return n;
+    }
+    
+    /*
+     * Build the nodes back, each with the line of its row.  A node is
+     * built once its subtrees have been, from the top of values, where
+     * the subtrees of each field (the items of a list one by one) were
+     * left in order.
+     */
+    template <class Elem> static list_node<Elem> *expand_list(tree_node **elems,
+                                                              size_t n)
+    {
+      flat_list<Elem> *l = flat_nil<Elem>();
+      for (size_t i = 0; i < n; i++)
+        l = flat_append(l, static_cast<Elem>(elems[i]));
+      return l;
+    }
+    
+    Program compact_tree::expand()
+    {
+      struct frame { ref r; uint32_t next; };
+      std::vector<frame> stack;
+      std::vector<tree_node *> values;
+      frame top = { root, 0 };
+      
+      stack.push_back(top);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        ref child;
+        if (next_child(f.r, f.next, child)) {
+          frame c = { child, 0 };
+          stack.push_back(c);
+          continue;
+        }
+        ref r = f.r;
+        stack.pop_back();
+        if (kind_of(r) != KIND_LIST)
+          values.push_back(expand_node(r, values));
+      }
+      return static_cast<Program>(values.back());
+    }
+    
+    #define SYM(i)    symbol(field(r, i))
+    #define EXPR(i)   static_cast<Expression>(values[at[i]])
+    #define LIST(Elem, i) expand_list<Elem>(&values[at[i]], list_len(field(r, i)))
+    
+    /* Build the node of r, taking its subtrees off values. */
+    tree_node *compact_tree::expand_node(ref r, std::vector<tree_node *> &values)
+    {
+      kind k = kind_of(r);
+      const char *f = fields(k);
+      size_t at[MAX_FIELDS];
+      size_t n = 0;
+      
+      for (int i = 0; f[i] != '\0'; i++)
+        n += f[i] == 'e' ? 1 : f[i] == 'l' ? list_len(field(r, i)) : 0;
+      for (int i = 0, next = values.size() - n; f[i] != '\0'; i++) {
+        at[i] = next;
+        next += f[i] == 'e' ? 1 : f[i] == 'l' ? list_len(field(r, i)) : 0;
+      }
+      
+      tree_node *node = NULL;
+      Expression e = NULL;
+      switch (k) {
+        case KIND_PROGRAM:
+          node = program(LIST(Class_, 0));
+          break;
+        case KIND_CLASS_:
+          node = class_(SYM(0), SYM(1), LIST(Feature, 2), SYM(3));
+          break;
+        case KIND_METHOD:
+          node = method(SYM(0), LIST(Formal, 1), SYM(2), EXPR(3));
+          break;
+        case KIND_ATTR:
+          node = attr(SYM(0), SYM(1), EXPR(2));
+          break;
+        case KIND_FORMAL:
+          node = formal(SYM(0), SYM(1));
+          break;
+        case KIND_BRANCH:
+          node = branch(SYM(0), SYM(1), EXPR(2));
+          break;
+        case KIND_ASSIGN:
+          e = assign(SYM(0), EXPR(1));
+          break;
+        case KIND_STATIC_DISPATCH:
+          e = static_dispatch(EXPR(0), SYM(1), SYM(2), LIST(Expression, 3));
+          break;
+        case KIND_DISPATCH:
+          e = dispatch(EXPR(0), SYM(1), LIST(Expression, 2));
+          break;
+        case KIND_COND:
+          e = cond(EXPR(0), EXPR(1), EXPR(2));
+          break;
+        case KIND_LOOP:
+          e = loop(EXPR(0), EXPR(1));
+          break;
+        case KIND_TYPCASE:
+          e = typcase(EXPR(0), LIST(Case, 1));
+          break;
+        case KIND_BLOCK:
+          e = block(LIST(Expression, 0));
+          break;
+        case KIND_LET:
+          e = let(SYM(0), SYM(1), EXPR(2), EXPR(3));
+          break;
+        case KIND_PLUS:
+          e = plus(EXPR(0), EXPR(1));
+          break;
+        case KIND_SUB:
+          e = sub(EXPR(0), EXPR(1));
+          break;
+        case KIND_MUL:
+          e = mul(EXPR(0), EXPR(1));
+          break;
+        case KIND_DIVIDE:
+          e = divide(EXPR(0), EXPR(1));
+          break;
+        case KIND_NEG:
+          e = neg(EXPR(0));
+          break;
+        case KIND_LT:
+          e = lt(EXPR(0), EXPR(1));
+          break;
+        case KIND_EQ:
+          e = eq(EXPR(0), EXPR(1));
+          break;
+        case KIND_LEQ:
+          e = leq(EXPR(0), EXPR(1));
+          break;
+        case KIND_COMP:
+          e = comp(EXPR(0));
+          break;
+        case KIND_INT_CONST:
+          e = int_const(SYM(0));
+          break;
+        case KIND_BOOL_CONST:
+          e = bool_const(field(r, 0) != 0);
+          break;
+        case KIND_STRING_CONST:
+          e = string_const(SYM(0));
+          break;
+        case KIND_NEW_:
+          e = new_(SYM(0));
+          break;
+        case KIND_ISVOID:
+          e = isvoid(EXPR(0));
+          break;
+        case KIND_NO_EXPR:
+          e = no_expr();
+          break;
+        case KIND_OBJECT:
+          e = object(SYM(0));
+          break;
+        default:
+          assert(0);
+      }
+      values.resize(values.size() - n);
+      if (e != NULL) {
+        e->set_type(type(r));
+        node = e;
+      }
+      return node_at(line(r), node);
+    }
+    
+    #undef SYM
+    #undef EXPR
+    #undef LIST
+    
+    void compact_tree::write(std::ostream &out) const
+    {
+      std::vector<uint32_t> records;
+      std::vector<uint32_t> tables(symbols.size(), AST_SYM_NONE);
+      std::vector<uint32_t> header;
+      std::string text;
+      
+      struct frame { ref r; size_t at; uint32_t next; };
+      std::vector<frame> stack;
+      frame first = { root, 0, 0 };
+      
+      write_record(root, records, tables);
+      stack.push_back(first);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        ref child;
+        if (next_child(f.r, f.next, child)) {
+          frame c = { child, records.size(), 0 };
+          write_record(child, records, tables);
+          stack.push_back(c);
+        } else {
+          records[f.at + 2] = records.size() - f.at;
+          stack.pop_back();
+        }
+      }
+      for (size_t id = 0; id < symbols.size(); id++) {
+        header.push_back(tables[id]);
+        header.push_back(id == 0 ? 0 : symbols[id]->get_len());
+        header.push_back(text.size());
+        if (id != 0)
+          text.append(symbols[id]->get_string(), symbols[id]->get_len());
+        text.push_back('\0');
+      }
+      
+      uint32_t top[5] = { AST_IMAGE_MAGIC, AST_IMAGE_VERSION,
+                          (uint32_t) symbols.size(), (uint32_t) text.size(),
+                          (uint32_t) records.size() };
+      text.resize((text.size() + 3) / 4 * 4, '\0');
+      out.write((const char *) top, sizeof(top));
+      out.write((const char *) header.data(), header.size() * 4);
+      out.write(text.data(), text.size());
+      out.write((const char *) records.data(), records.size() * 4);
+      out.flush();
+    }
+    
+    /* Append the record of r to out, noting in tables which table each
+       of its symbols goes back to.  write() fills in its size. */
+    void compact_tree::write_record(ref r, std::vector<uint32_t> &out,
+                                    std::vector<uint32_t> &tables) const
+    {
+      kind k = kind_of(r);
+      const char *f = fields(k);
+      size_t at = out.size();
+      
+      out.push_back(k);
+      out.push_back(line(r));
+      out.push_back(0);
+      if (is_expression(k)) {
+        uint32_t t = pools[k].type[row_of(r)];
+        if (t != 0)
+          tables[t] = AST_SYM_ID;
+        out.push_back(t);
+      }
+      if (k == KIND_LIST)
+        out.push_back(list_len(r));
+      for (int i = 0; f[i] != '\0'; i++) {
+        if (is_subtree(f[i]))
+          continue;
+        uint32_t v = field(r, i);
+        if (f[i] != 'b' && v != 0)
+          tables[v] = f[i] == 'n' ? AST_SYM_INT :
+                      f[i] == 's' ? AST_SYM_STR : AST_SYM_ID;
+        out.push_back(v);
+      }
+      out[at] |= (out.size() - at) << 8;
+    }
+    
+    void compact_tree::set_file(Symbol file)
+    {
+      std::vector<uint32_t> &names = pools[KIND_CLASS_].fields[3];
+      std::fill(names.begin(), names.end(), symbol_id(file));
+    }
+    
+    /* Replace this tree with the one in image, interning its symbols. */
+    void compact_tree::load(const ast_image &image)
+    {
+      std::vector<uint32_t> ids(image.symbol_count(), 0);
+      struct frame { uint32_t child; ref r; uint32_t next; };
+      std::vector<frame> stack;
+      
+      *this = compact_tree();
+      for (uint32_t id = 1; id < image.symbol_count(); id++) {
+        char *s = (char *) image.symbol_text(id);
+        int len = image.symbol_len(id);
+        Symbol sym;
+        std::lock_guard<std::mutex> hold(symbols_lock);
+        switch (image.symbol_table(id)) {
+          case AST_SYM_INT: sym = inttable.add_string(s, len); break;
+          case AST_SYM_STR: sym = stringtable.add_string(s, len); break;
+          default:          sym = idtable.add_string(s, len); break;
+        }
+        ids[id] = symbol_id(sym);
+      }
+      
+      /* Each record is added before its subtrees, which are set in it as
+         they are added in turn. */
+      root = load_record(image, image.root(), ids);
+      frame top = { image.first_child(image.root()), root, 0 };
+      stack.push_back(top);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        ref child;
+        if (!next_child(f.r, f.next, child)) {
+          stack.pop_back();
+          continue;
+        }
+        uint32_t node = f.child;
+        f.child = image.next_sibling(node);
+        child = load_record(image, node, ids);
+        set_child(f.r, f.next - 1, child);
+        frame c = { image.first_child(node), child, 0 };
+        stack.push_back(c);
+      }
+    }
+    
+    /* Add the record at node, with its subtrees left 0. */
+    compact_tree::ref compact_tree::load_record(const ast_image &image,
+                                                uint32_t node,
+                                                const std::vector<uint32_t> &ids)
+    {
+      kind k = image.kind(node);
+      
+      if (k == KIND_LIST)
+        return add_list(NULL, image.list_len(node));
+      
+      const char *f = fields(k);
+      uint32_t values[MAX_FIELDS] = { 0, 0, 0, 0 };
+      for (int i = 0, scalar = 0; f[i] != '\0'; i++) {
+        if (!is_subtree(f[i])) {
+          uint32_t v = image.field(node, scalar++);
+          values[i] = f[i] == 'b' ? v : ids[v];
+        }
+      }
+      ref r = add(k, image.line(node), values[0], values[1], values[2], values[3]);
+      if (is_expression(k))
+        pools[k].type[row_of(r)] = ids[image.type(node)];
+      return r;
+    }
+    
+    /* What dump_with_types() prints for each constructor. */
+    static const char *const dump_tags[compact_tree::KIND_LIST] = {
+      "_program", "_class", "_method", "_attr", "_formal", "_branch",
+      "_assign", "_static_dispatch", "_dispatch", "_cond", "_loop",
+      "_typcase", "_block", "_let", "_plus", "_sub", "_mul", "_divide",
+      "_neg", "_lt", "_eq", "_leq", "_comp", "_int", "_bool", "_string",
+      "_new", "_isvoid", "_no_expr", "_object"
+    };
+    
+    /* The text of dump(), gathered a chunk at a time and written out
+       with one call, rather than an ostream << for every word. */
+    class dump_text {
+    public:
+      dump_text(std::ostream &out) : out(out) { }
+      ~dump_text() { flush(); }
+      
+      dump_text &operator<<(const char *s) { text += s; return more(); }
+      dump_text &operator<<(Symbol sym) { return *this << sym->get_string(); }
+      dump_text &operator<<(int n) { text += std::to_string(n); return more(); }
+      dump_text &escaped(Symbol sym)
+      {
+        escape.str("");
+        print_escaped_string(escape, sym->get_string());
+        text += escape.str();
+        return more();
+      }
+      void flush()
+      {
+        out.write(text.data(), text.size());
+        text.clear();
+        out.flush();
+      }
+      
+    private:
+      std::ostream &out;
+      std::string text;
+      std::ostringstream escape;
+      
+      dump_text &more()
+      {
+        if (text.size() >= 1 << 16) {
+          out.write(text.data(), text.size());
+          text.clear();
+        }
+        return *this;
+      }
+    };
+    
+    /*
+     * Write the text dump_with_types() writes for the tree.  The fields of
+     * a node are printed in order, each scalar as it comes and each subtree
+     * or list pushed on the stack, except that a class prints its filename
+     * ahead of its features.  The features of a class and the actuals of a
+     * dispatch are printed between parentheses.
+     */
+    void compact_tree::dump(std::ostream &stream, bool whole) const
+    {
+      struct frame { ref r; int n; uint32_t next; bool parens; };
+      std::vector<frame> stack;
+      frame top = { root, 0, 0, false };
+      dump_text out(stream);
+      
+      if (whole)
+        out << "#" << line(root) << "\n" << dump_tags[KIND_PROGRAM] << "\n";
+      stack.push_back(top);
+      while (!stack.empty()) {
+        frame &f = stack.back();
+        kind k = kind_of(f.r);
+        int n = f.n;
+        
+        if (k == KIND_LIST) {
+          if (f.next < list_len(f.r)) {
+            frame c = { list_nth(f.r, f.next++), n, 0, false };
+            out << pad(n) << "#" << line(c.r) << "\n"
+                << pad(n) << dump_tags[kind_of(c.r)] << "\n";
+            stack.push_back(c);
+          } else {
+            if (f.parens)
+              out << pad(n) << ")\n";
+            stack.pop_back();
+          }
+          continue;
+        }
+        
+        const char *fs = fields(k);
+        uint32_t i = f.next;
+        for (; fs[i] != '\0' && !is_subtree(fs[i]); i++) {
+          uint32_t v = field(f.r, i);
+          if (k == KIND_CLASS_ && i == 3)
+            continue;
+          if (fs[i] == 'b')
+            out << pad(n + 2) << (v ? "1" : "0") << "\n";
+          else if (fs[i] == 's') {
+            out << pad(n + 2) << "\"";
+            out.escaped(symbol(v)) << "\"\n";
+          } else
+            out << pad(n + 2) << symbol(v) << "\n";
+        }
+        if (fs[i] == '\0') {
+          if (is_expression(k)) {
+            if (type(f.r) != NULL)
+              out << pad(n) << ": " << type(f.r) << "\n";
+            else
+              out << pad(n) << ": _no_type\n";
+          }
+          stack.pop_back();
+          continue;
+        }
+        
+        f.next = i + 1;
+        frame c = { field(f.r, i), n + 2, 0, false };
+        if (fs[i] == 'l') {
+          c.parens = k == KIND_CLASS_ || k == KIND_DISPATCH ||
+                     k == KIND_STATIC_DISPATCH;
+          if (k == KIND_CLASS_) {
+            out << pad(n + 2) << "\"";
+            out.escaped(symbol(field(f.r, 3))) << "\"\n";
+          }
+          if (c.parens)
+            out << pad(n + 2) << "(\n";
+        } else
+          out << pad(c.n) << "#" << line(c.r) << "\n"
+              << pad(c.n) << dump_tags[kind_of(c.r)] << "\n";
+        stack.push_back(c);
+      }
+    }
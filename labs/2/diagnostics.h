@@ -0,0 +1,72 @@
+/*
+ * The syntax errors found by a parse, kept as records.
+ */
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stddef.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct diagnostic {
+	std::string file;
+	int line;
+	std::string token;	/* as print_cool_token() shows it */
+	std::string message;
+};
+
+/*
+ * A parse reports each syntax error to the diagnostics of its
+ * parse_context, if it has one, and otherwise only counts it.  The
+ * parser goes on recovering through the error rules of the grammar, and
+ * once the parse has had more than limit errors it stops at the next
+ * error rule it reduces; the records and the process are left alone.
+ * Nothing here is touched until there is an error, so a parse without
+ * any costs the same as before.
+ *
+ * One diagnostics may take the errors of several parses at once.  With
+ * echo, each record is also written there as it comes in, in the form
+ * the parser has always used, which is what the compiler does with cerr.
+ */
+class diagnostics {
+public:
+	const size_t limit;		/* errors a parse may have */
+
+	diagnostics(size_t limit, std::ostream *echo = NULL)
+		: limit(limit), echo(echo) { }
+
+	void report(const diagnostic &d) {
+		std::lock_guard<std::mutex> hold(lock);
+		if (echo != NULL)
+			print(*echo, d);
+		records.push_back(d);
+	}
+
+	size_t count() const {
+		std::lock_guard<std::mutex> hold(lock);
+		return records.size();
+	}
+
+	std::vector<diagnostic> all() const {
+		std::lock_guard<std::mutex> hold(lock);
+		return records;
+	}
+
+	static void print(std::ostream &out, const diagnostic &d) {
+		out << "\"" << d.file << "\", line " << d.line << ": " << d.message
+		    << " at or near " << d.token << std::endl;
+	}
+
+private:
+	std::ostream *echo;
+	mutable std::mutex lock;
+	std::vector<diagnostic> records;
+
+	diagnostics(const diagnostics &);
+	diagnostics &operator=(const diagnostics &);
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Method bodies and attribute initializers left unparsed until they are
+ * asked for.
+ */
+
+#ifndef LAZY_BODY_H
+#define LAZY_BODY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include "cool-tree.h"
+
+/*
+ * A parse with lazy_bodies set in its parse_context (see
+ * parse_token_files()) parses the classes, features and formals of a
+ * program but not the expressions of its features: the hand written
+ * parser skips each to the '}' or ';' that ends it, counting the
+ * brackets, parentheses and case ... esac in between, and leaves a
+ * lazy_body holding its tokens where the expression goes.  Building the
+ * class hierarchy or the method tables of a program then costs a pass
+ * over its tokens and the nodes of its signatures.
+ *
+ * body() parses the tokens the first time it is called, with the tree's
+ * own arena.  Syntax errors in them are reported then, to the
+ * diagnostics of the parse, counted in errors(), and the body is a
+ * no_expr.  The diagnostics are kept with the arena of the tree, so
+ * they last as long as the lazy_body whatever becomes of the
+ * parse_context.  A lazy_body that is copied, dumped or compacted parses
+ * itself first and hands over to its body, so that a phase that walks
+ * whole trees need not know; one that sets types calls body() and sets
+ * them there.
+ * body() is not to be called from two threads at once.
+ */
+struct buffered_token;
+class diagnostics;
+
+class lazy_body : public Expression_class {
+public:
+	/* tokens ends with the '}' or ';' after the expression. */
+	lazy_body(const buffered_token *tokens, size_t count, char *filename,
+		  const std::shared_ptr<diagnostics> &diag);
+
+	Expression body();
+	bool parsed() const { return expr != NULL; }
+	int errors() const { return error_count; }
+
+	Expression copy_Expression() { return body()->copy_Expression(); }
+	void dump(ostream& stream, int n) { body()->dump(stream, n); }
+	void dump_with_types(ostream& stream, int n) {
+		body()->dump_with_types(stream, n);
+	}
+	uint32_t compact(compact_tree &t) { return body()->compact(t); }
+	uint32_t walk(tree_walk &t) { return body()->walk(t); }
+
+private:
+	buffered_token *tokens;		/* in arena, with a 0 token after them */
+	size_t count;
+	char *filename;
+	diagnostics *diag;		/* of the parse, kept by arena, or NULL */
+	node_arena *arena;		/* that the tree is allocated from */
+	Expression expr;
+	int error_count;
+
+	Expression parse_tokens();
+};
+
+#endif
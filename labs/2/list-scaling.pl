@@ -0,0 +1,102 @@
+# chmod a+x list-scaling.pl
+#!/usr/bin/perl -w
+
+# Scaling test for long lists.  Generates programs with one list of
+# 10^3, 10^4 and 10^5 elements: the features of a class, the formals of
+# a method, the expressions of a block, the actuals of a dispatch, the
+# branches of a case, or the classes of the program.  Runs the lexer and
+# the parser over each and gives the time of each phase and the
+# parser's time per element, which should stay flat as the list grows:
+# the parser's lists are flat_lists (cool-tree.handcode.h), taking
+# constant time to append to and to index.
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+use Time::HiRes qw(time);
+
+my $lexer = "./lexer";
+my $parser = "./parser";
+my @lengths = (1000, 10000, 100000);
+my @shapes = ("features", "formals", "block", "actuals", "cases", "classes");
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>  - lexer to run [default = \"$lexer\"]\n";
+    print "             -parser <path> - parser to run [default = \"$parser\"]\n";
+    print "             -length <n>    - length to try, may be repeated\n";
+    print "                              [default = @lengths]\n";
+    print "             -shape <name>  - one of @shapes, may be repeated\n";
+    return "\n";
+}
+
+my (@length_opts, @shape_opts);
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "parser=s" => \$parser,
+		      "length=i" => \@length_opts,
+		      "shape=s" => \@shape_opts,
+		      "help" => sub { usage(); exit 0; }));
+@lengths = @length_opts if @length_opts;
+@shapes = @shape_opts if @shape_opts;
+
+foreach my $p ($lexer, $parser) {
+    die "$p is not executable\n" unless -x $p;
+}
+
+# A program whose list of the given shape has n elements.  The elements
+# are all alike, so that the time goes into the lists rather than into
+# interning ever more names in the string tables, which are lists too.
+sub program {
+    my ($shape, $n) = @_;
+
+    return "class Main {\n" . "  a : Int <- 1;\n" x $n .
+	"  main() : Int { 0 };\n};\n" if $shape eq "features";
+    return "class Main {\n  f(" . join(", ", ("x : Int") x $n) .
+	") : Int { 0 };\n  main() : Int { 0 };\n};\n" if $shape eq "formals";
+    return "class Main {\n  main() : Int {\n    {\n" . "      1;\n" x $n .
+	"    }\n  };\n};\n" if $shape eq "block";
+    return "class Main {\n  main() : Object {\n    f(" . join(", ", (1) x $n) .
+	")\n  };\n};\n" if $shape eq "actuals";
+    return "class Main {\n  main() : Int {\n    case 0 of\n" .
+	"      x : T => 1;\n" x $n . "    esac\n  };\n};\n" if $shape eq "cases";
+    return "class C {\n  a : Int <- 1;\n};\n" x $n if $shape eq "classes";
+    die "unknown shape $shape\n";
+}
+
+# Run cmd, from in to out, and return the seconds it took, or undef if
+# it failed.
+sub run {
+    my ($cmd, $in, $out) = @_;
+    my $start = time();
+
+    return undef if system("$cmd < $in > $out 2> /dev/null") != 0;
+    return time() - $start;
+}
+
+my $dir = tempdir("list-scaling-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+my $failed = 0;
+
+printf("%-9s %8s | %8s | %8s %12s\n", "shape", "length", "lex s",
+       "parse s", "parse us/elem");
+foreach my $shape (@shapes) {
+    foreach my $n (@lengths) {
+	my $file = "$dir/$shape$n.cl";
+	open(my $out, ">", $file) or die "$file: $!\n";
+	print $out program($shape, $n);
+	close($out);
+
+	local $ENV{COOL_TOKEN_FORMAT} = "binary";
+	my $lexed = run("$lexer $file", "/dev/null", "$dir/$shape$n.tok");
+	my $parsed = defined($lexed) ?
+	    run($parser, "$dir/$shape$n.tok", "$dir/$shape$n.ast") : undef;
+	printf("%-9s %8d | %8s | %8s %12s\n", $shape, $n,
+	       defined($lexed) ? sprintf("%.3f", $lexed) : "failed",
+	       defined($parsed) ? sprintf("%.3f", $parsed) : "failed",
+	       defined($parsed) ? sprintf("%.2f", $parsed / $n * 1e6) : "-");
+	$failed++ unless defined($parsed);
+	unlink(glob("$dir/$shape$n.*"));
+    }
+}
+exit($failed ? 1 : 0);
@@ -0,0 +1,117 @@
+# chmod a+x parse-cache-bench.pl
+#!/usr/bin/perl -w
+
+# Cold and warm timing of the parse cache.  Generates a program of
+# several files, runs the lexer and the parser over them with binary
+# token streams and no cache, then with COOL_PARSE_CACHE set to an
+# empty directory (cold: every file is lexed, parsed and stored) and
+# to the same directory again (warm: the lexer sends each file's entry
+# and neither lexes nor parses it), and gives the best time of each.
+# The parser's output must be the same all three ways.
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+use Time::HiRes qw(time);
+
+my $lexer = "./lexer";
+my $parser = "./parser";
+my $files = 8;
+my $size = 4;
+my $runs = 3;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>  - lexer to run [default = \"$lexer\"]\n";
+    print "             -parser <path> - parser to run [default = \"$parser\"]\n";
+    print "             -files <n>     - files in the program [default = $files]\n";
+    print "             -size <MB>     - size of each file [default = $size]\n";
+    print "             -runs <n>      - best of n runs [default = $runs]\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "parser=s" => \$parser,
+		      "files=i" => \$files,
+		      "size=i" => \$size,
+		      "runs=i" => \$runs,
+		      "help" => sub { usage(); exit 0; }));
+
+foreach my $p ($lexer, $parser) {
+    die "$p is not executable\n" unless -x $p;
+}
+
+# Code with every kind of token, repeated with one of a few class
+# names, so that the time goes into lexing, parsing and loading rather
+# than into interning ever more symbols in the string tables.
+my $code = <<'END';
+class C%N% inherits IO {
+  x : Int <- %N%;
+  f(a : Int, s : String) : Object {
+    let b : Bool <- true in
+      if isvoid s then a * 2 + 1 else while not b loop b <- false pool fi
+  };
+  g() : String { case self of o : Object => "text %N%\n"; esac };
+};
+END
+
+my $dir = tempdir("parse-cache-bench-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+my @sources;
+my $n = 0;
+for (my $i = 0; $i < $files; $i++) {
+    my $file = "$dir/part$i.cl";
+    open(my $out, ">", $file) or die "$file: $!\n";
+    for (my $written = 0; $written < $size << 20; $n++) {
+	(my $class = $code) =~ s/%N%/$n % 64/ge;
+	print $out $class;
+	$written += length($class);
+    }
+    close($out);
+    push(@sources, $file);
+}
+mkdir("$dir/cache") or die "$dir/cache: $!\n";
+
+# Time the pipeline with the parse cache in $cache, if given, leaving
+# the parser's output in $out.
+sub pipeline {
+    my ($cache, $out) = @_;
+    local $ENV{COOL_TOKEN_FORMAT} = "binary";
+    local $ENV{COOL_PARSE_CACHE} = defined($cache) ? $cache : "";
+    my $start = time();
+
+    system("$lexer @sources | $parser > $out 2>&1") == 0
+	or die "the pipeline failed\n";
+    return time() - $start;
+}
+
+sub best {
+    my ($cache, $out) = @_;
+    my $best;
+
+    for (my $i = 0; $i < $runs; $i++) {
+	my $t = pipeline($cache, $out);
+	$best = $t if !defined($best) || $t < $best;
+    }
+    return $best;
+}
+
+my $none = best(undef, "$dir/none.out");
+my $cold = pipeline("$dir/cache", "$dir/cold.out");
+my $warm = best("$dir/cache", "$dir/warm.out");
+
+printf("%d files, %d MB, %d classes\n", $files, $files * $size, $n);
+printf("%-9s %8s %8s\n", "cache", "s", "speedup");
+printf("%-9s %8.3f %8.2f\n", "none", $none, 1);
+printf("%-9s %8.3f %8.2f\n", "cold", $cold, $none / $cold);
+printf("%-9s %8.3f %8.2f\n", "warm", $warm, $none / $warm);
+
+my $failed = 0;
+foreach my $run ("cold", "warm") {
+    if (system("cmp", "-s", "$dir/none.out", "$dir/$run.out") != 0) {
+	print "$run: the output differs from the parse without the cache\n";
+	$failed++;
+    }
+}
+exit($failed ? 1 : 0);
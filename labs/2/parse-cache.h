@@ -0,0 +1,128 @@
+/*
+ * A cache of parsed files on disk, so that a file which has not changed
+ * since it was last parsed is neither lexed nor parsed again.
+ */
+
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include "compact-tree.h"
+#include "ast-image.h"
+
+/*
+ * With COOL_PARSE_CACHE=dir, for both the lexer and the parser, the
+ * lexer gives each file it reads a 128 bit key made from its text, the
+ * line it starts on and its own executable, so that the tokens of a
+ * text are the same for a key.  The entry for a key is the file
+ * dir/<key in hex>.ast.  When there is none, the lexer sends the key in
+ * the header of the file's token stream (see write_token_stream() in
+ * cool.flex), followed by the tokens as usual; when there is one, it
+ * does not lex the file at all, and sends the entry in place of the
+ * tokens, so a file that has not changed is neither lexed nor parsed,
+ * and the parser never looks for an entry itself.
+ *
+ * An entry is build_id() of the parser that stored it (2 words),
+ * followed by the image of ast-image.h of a program holding the classes
+ * of one file.  build_id() tells apart one build of the parser from the
+ * next, and so the grammar, the actions and the image format: an entry
+ * another build stored is of no use to this one, which has the file
+ * lexed again by the lexer that sent the entry, parses it and stores
+ * its own.  The parser stores an entry for each file with a key that it
+ * parses without errors.  The classes of an entry get the name of the
+ * file being compiled, so that files with the same text share one.
+ *
+ * An entry is written to a file of its own name in dir and renamed into
+ * place, so compilers sharing dir never see one half written; when two
+ * store the same entry the last rename wins.  A lexer that cannot read
+ * an entry lexes the file, and a parser that cannot tell its own build
+ * does without the cache.
+ */
+
+class parse_cache {
+public:
+	std::atomic<size_t> hits;	/* files loaded */
+	std::atomic<size_t> misses;	/* files parsed and stored */
+
+	parse_cache(const char *dir) : hits(0), misses(0), dir(dir), build(build_id()) { }
+
+	/* Load the entry of size bytes at entry into tree; false if this
+	   build did not store it. */
+	bool load(const char *entry, size_t size, compact_tree &tree) {
+		uint64_t from;
+		ast_image image;
+
+		if (build == 0 || size < sizeof(from))
+			return false;
+		memcpy(&from, entry, sizeof(from));
+		if (from != build || !image.open(entry + sizeof(from), size - sizeof(from)))
+			return false;
+		tree.load(image);
+		hits++;
+		return true;
+	}
+
+	void store(const uint32_t key[4], const compact_tree &tree) {
+		if (build == 0)
+			return;
+
+		static std::atomic<unsigned> serial(0);
+		std::string to = path(key);
+		std::string tmp = to + "." + std::to_string(getpid()) + "." +
+				  std::to_string(serial++);
+		std::ofstream out(tmp.c_str(), std::ios::binary);
+
+		out.write((const char *) &build, sizeof(build));
+		tree.write(out);
+		out.close();
+		if (!out || rename(tmp.c_str(), to.c_str()) != 0)
+			unlink(tmp.c_str());
+		misses++;
+	}
+
+private:
+	std::string dir;
+	uint64_t build;
+
+	std::string path(const uint32_t key[4]) const {
+		char name[64];
+
+		snprintf(name, sizeof(name), "/%08x%08x%08x%08x.ast",
+			 key[0], key[1], key[2], key[3]);
+		return dir + name;
+	}
+
+	/* The device, inode, size and modification time of this executable,
+	   which a new build changes, mixed with the image version; never 0,
+	   or 0 if there is no executable to stat. */
+	static uint64_t build_id() {
+		struct stat st;
+		uint64_t parts[5];
+		uint64_t h = 0x9e3779b97f4a7c15ull ^ AST_IMAGE_VERSION;
+
+		if (stat("/proc/self/exe", &st) != 0)
+			return 0;
+		parts[0] = st.st_dev;
+		parts[1] = st.st_ino;
+		parts[2] = st.st_size;
+		parts[3] = st.st_mtim.tv_sec;
+		parts[4] = st.st_mtim.tv_nsec;
+		for (int i = 0; i < 5; i++) {
+			h = (h ^ parts[i]) * 0x100000001b3ull;
+			h ^= h >> 29;
+		}
+		return h | 1;
+	}
+
+	parse_cache(const parse_cache &);
+	parse_cache &operator=(const parse_cache &);
+};
+
+#endif
@@ -0,0 +1,139 @@
+# chmod a+x parse-scaling.pl
+#!/usr/bin/perl -w
+
+# Scaling test for deep nesting.  Generates programs whose one method
+# body is a let, if, + or ~ chain of 10^3, 10^5 and 10^6 levels, runs
+# the lexer, the parser and, if given, semant over each, and records
+# the time and peak memory of every phase and how it ended.  No phase
+# should need more than heap memory in proportion to the depth.
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+use POSIX qw(WNOHANG);
+use Time::HiRes qw(time sleep);
+
+my $lexer = "./lexer";
+my $parser = "./parser";
+my $semant;
+my @levels = (1000, 100000, 1000000);
+my @shapes = ("let", "if", "plus", "neg");
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>  - lexer to run [default = \"$lexer\"]\n";
+    print "             -parser <path> - parser to run [default = \"$parser\"]\n";
+    print "             -semant <path> - semant to run on the parser's output\n";
+    print "             -level <n>     - depth to try, may be repeated\n";
+    print "                              [default = @levels]\n";
+    print "             -shape <name>  - one of @shapes, may be repeated\n";
+    return "\n";
+}
+
+my (@level_opts, @shape_opts);
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "parser=s" => \$parser,
+		      "semant=s" => \$semant,
+		      "level=i" => \@level_opts,
+		      "shape=s" => \@shape_opts,
+		      "help" => sub { usage(); exit 0; }));
+@levels = @level_opts if @level_opts;
+@shapes = @shape_opts if @shape_opts;
+
+foreach my $p ($lexer, $parser, defined($semant) ? $semant : ()) {
+    die "$p is not executable\n" unless -x $p;
+}
+
+# The body of main() nested n deep.
+sub nesting {
+    my ($shape, $n) = @_;
+
+    return "let x : Int <- 1 in " x $n . "x" if $shape eq "let";
+    return "if true then " x $n . "0" . " else 0 fi" x $n if $shape eq "if";
+    return "1" . " + 1" x $n if $shape eq "plus";
+    return "~" x $n . "1" if $shape eq "neg";
+    die "unknown shape $shape\n";
+}
+
+# Our own name in /proc, which the child has until it execs.
+my $self_name = "";
+if (open(my $status, "<", "/proc/self/status")) {
+    while (<$status>) {
+	$self_name = $1 if /^Name:\s+(.*)/;
+    }
+    close($status);
+}
+
+# Run cmd with stdin and stdout from and to files.  Returns the seconds
+# it took, its peak resident set in MB, sampled from /proc while it
+# runs, and how it ended.
+sub run {
+    my ($cmd, $in, $out) = @_;
+    my $start = time();
+    my $peak = 0;
+    my $pid = fork();
+
+    die "fork: $!\n" unless defined($pid);
+    if ($pid == 0) {
+	open(STDIN, "<", $in) or die "$in: $!\n";
+	open(STDOUT, ">", $out) or die "$out: $!\n";
+	open(STDERR, ">", "/dev/null");
+	exec(@$cmd) or exit(127);
+    }
+    while (waitpid($pid, WNOHANG) == 0) {
+	if (open(my $status, "<", "/proc/$pid/status")) {
+	    my ($name, $hwm) = ("", 0);
+	    while (<$status>) {
+		$name = $1 if /^Name:\s+(.*)/;
+		$hwm = $1 if /^VmHWM:\s+(\d+)/;
+	    }
+	    close($status);
+	    $peak = $hwm if $name ne $self_name && $hwm > $peak;
+	}
+	sleep(0.002);
+    }
+    my $ended = $? & 127 ? "signal " . ($? & 127) :
+		$? >> 8 ? "exit " . ($? >> 8) : "ok";
+    return (time() - $start, $peak / 1024, $ended);
+}
+
+my $dir = tempdir("parse-scaling-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+my @phases = ([ "lex", [ $lexer ] ], [ "parse", [ $parser ] ],
+	      defined($semant) ? ([ "semant", [ $semant ] ]) : ());
+my $failed = 0;
+
+printf("%-6s %8s", "shape", "depth");
+printf(" | %-6s %8s %8s %-9s", $_->[0], "s", "MB", "") foreach @phases;
+print "\n";
+foreach my $shape (@shapes) {
+    foreach my $n (@levels) {
+	my $file = "$dir/$shape$n.cl";
+	open(my $out, ">", $file) or die "$file: $!\n";
+	print $out "class Main {\n  main() : Int {\n", nesting($shape, $n),
+	    "\n  };\n};\n";
+	close($out);
+
+	printf("%-6s %8d", $shape, $n);
+	my $in = "/dev/null";
+	my $prev = "";
+	foreach my $phase (@phases) {
+	    my ($name, $cmd) = @$phase;
+	    my @argv = $name eq "lex" ? (@$cmd, $file) : @$cmd;
+	    my $result = "$dir/$shape$n.$name";
+	    if ($prev ne "" && $prev ne "ok") {
+		printf(" | %-6s %8s %8s %-9s", $name, "-", "-", "");
+		next;
+	    }
+	    my ($secs, $mb, $ended) = run(\@argv, $in, $result);
+	    printf(" | %-6s %8.2f %8.1f %-9s", $name, $secs, $mb, $ended);
+	    $failed++ if $ended ne "ok";
+	    $in = $result;
+	    $prev = $ended;
+	}
+	print "\n";
+	unlink(glob("$dir/$shape$n.*"));
+    }
+}
+exit($failed ? 1 : 0);
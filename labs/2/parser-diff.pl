@@ -0,0 +1,138 @@
+# chmod a+x parser-diff.pl
+#!/usr/bin/perl -w
+
+# Differential test of the two parsers: runs the parser built from
+# cool.y with the LALR tables and with COOL_PARSER=descent over the
+# token streams of the example programs, good.cl and bad.cl, and of
+# programs with tokens dropped into them, and reports every file whose
+# output or exit status differs, with the first line where they do.
+
+use strict;
+
+use File::Basename;
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $root = dirname(__FILE__) . "/../..";
+my $lexer = "./lexer";
+my $parser = "./parser";
+my $count = 200;
+my $seed = 1;
+my $keep;
+my $verbose;
+
+sub usage {
+    print "Usage: $0 [options] [file.cl ...]\n";
+    print "    Options: -lexer <path>  - lexer to run [default = \"$lexer\"]\n";
+    print "             -parser <path> - parser to run [default = \"$parser\"]\n";
+    print "             -n <count>     - mutated inputs to make [default = $count]\n";
+    print "             -seed <n>      - seed of the first one [default = $seed]\n";
+    print "             -keep          - keep the mutated inputs\n";
+    print "             -v             - name each file as it is checked\n";
+    print "    Files given are checked too.  Each file is lexed once and\n";
+    print "    both parsers read the same tokens.\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "parser=s" => \$parser,
+		      "n=i" => \$count,
+		      "seed=i" => \$seed,
+		      "keep" => \$keep,
+		      "v" => \$verbose,
+		      "help" => sub { usage(); exit 0; }));
+
+foreach my $p ($lexer, $parser) {
+    die "$p is not executable\n" unless -x $p;
+}
+
+my @examples = (glob("$root/examples/*.cl"), "$root/tasks/stack.cl",
+		"$root/labs/2/good.cl", "$root/labs/2/bad.cl");
+my @files = (@examples, @ARGV);
+
+# Tokens the mutator drops into the examples, so that both parsers meet
+# errors at every kind of place: in headers, between features, inside
+# expressions and at the end of the program.
+my @pieces = (
+    "class", "inherits", "if", "then", "else", "fi", "while", "loop",
+    "pool", "let", "in", "case", "of", "esac", "new", "isvoid", "not",
+    "true", "x", "Main", "SELF_TYPE", "0", "42", "\"s\"",
+    "<-", "<=", "=>", "<", "=", "-", "+", "*", "/", "~", "@", ".", ",",
+    ":", ";", "(", ")", "{", "}",
+);
+
+sub mutate {
+    my ($n) = @_;
+    my $file = $examples[$n % @examples];
+    my $text;
+
+    srand($n);
+    {
+	local $/;
+	open(my $in, "<", $file) or die "$file: $!\n";
+	$text = <$in>;
+	close($in);
+    }
+    for (my $i = int(rand(4)); $i >= 0; $i--) {
+	my $at = int(rand(length($text) + 1));
+	my $cut = int(rand(3));
+	substr($text, $at, $cut) = " " . $pieces[int(rand(@pieces))] . " ";
+    }
+    return $text;
+}
+
+sub run {
+    my ($cmd, $env, $value) = @_;
+    my $out;
+
+    local $ENV{$env} = $value;
+    open(my $pipe, "-|", "$cmd 2>&1") or die "$cmd: $!\n";
+    { local $/; $out = <$pipe>; }
+    close($pipe);
+    return (defined($out) ? $out : "", $?);
+}
+
+sub check {
+    my ($file, $dir) = @_;
+    my $tokens = "$dir/tokens";
+
+    print "$file\n" if $verbose;
+    my ($lexed, $status) = run("$lexer '$file' > $tokens", "COOL_PARSER", "");
+    die "$lexer $file: exit status $status\n" if $status != 0;
+
+    my ($lalr, $a) = run("$parser < $tokens", "COOL_PARSER", "");
+    my ($descent, $b) = run("$parser < $tokens", "COOL_PARSER", "descent");
+    if ($a != $b) {
+	print "$file: exit status $a with the tables, $b with descent\n";
+	return 0;
+    }
+    my @lalr = split(/\n/, $lalr, -1);
+    my @descent = split(/\n/, $descent, -1);
+    for (my $i = 0; $i < @lalr || $i < @descent; $i++) {
+	my $x = $i < @lalr ? $lalr[$i] : "(end)";
+	my $y = $i < @descent ? $descent[$i] : "(end)";
+	next if $x eq $y;
+	print "$file: outputs differ at line ", $i + 1, "\n";
+	print "    tables:  $x\n    descent: $y\n";
+	return 0;
+    }
+    return 1;
+}
+
+my $dir = tempdir("parser-diff-XXXXXX", TMPDIR => 1, CLEANUP => !$keep);
+for (my $n = $seed; $n < $seed + $count; $n++) {
+    my $file = "$dir/mutant$n.cl";
+    open(my $out, ">", $file) or die "$file: $!\n";
+    print $out mutate($n);
+    close($out);
+    push(@files, $file);
+}
+
+my $failed = 0;
+foreach my $file (@files) {
+    $failed++ unless check($file, $dir);
+}
+print scalar(@files) - $failed, " of ", scalar(@files),
+    " files parsed the same", ($keep ? " (inputs in $dir)" : ""), "\n";
+exit($failed ? 1 : 0);
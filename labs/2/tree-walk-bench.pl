@@ -0,0 +1,173 @@
+# chmod a+x tree-walk-bench.pl
+#!/usr/bin/perl -w
+
+# Traversal benchmark of the two forms of the tree: the pointer tree of
+# cool-tree.h and the compact_tree of compact-tree.h.  Builds a small
+# driver against the objects 'make parser' leaves behind (all but
+# parser-phase.o), parses the tokens of a generated program, and gives
+# the best nodes per second of a walk over every node of each form
+# (tree_walk, and compact_tree::walk()) with the bytes each form takes.
+# Both walks must count the same nodes.
+
+use strict;
+
+use File::Temp qw(tempdir);
+use Getopt::Long;
+
+my $lexer = "../1/lexer";
+my $cxx = "g++";
+my $cxxflags = "-O2 -I. -I/usr/class/cool/include/PA2";
+my $objs = "cool-parse.o utilities.o stringtab.o dumptype.o tree.o " .
+    "cool-tree.o tokens-lex.o handle_flags.o";
+my $runs = 5;
+my $size = 16;
+
+sub usage {
+    print "Usage: $0 [options]\n";
+    print "    Options: -lexer <path>      - lexer to run [default = \"$lexer\"]\n";
+    print "             -cxx <path>        - compiler [default = \"$cxx\"]\n";
+    print "             -cxxflags <flags>  - its flags [default = \"$cxxflags\"]\n";
+    print "             -objs <files>      - objects of the parser\n";
+    print "                                  [default = \"$objs\"]\n";
+    print "             -runs <n>          - best of n runs [default = $runs]\n";
+    print "             -size <MB>         - size of the program [default = $size]\n";
+    return "\n";
+}
+
+die usage()
+    unless(GetOptions("lexer=s" => \$lexer,
+		      "cxx=s" => \$cxx,
+		      "cxxflags=s" => \$cxxflags,
+		      "objs=s" => \$objs,
+		      "runs=i" => \$runs,
+		      "size=i" => \$size,
+		      "help" => sub { usage(); exit 0; }));
+
+die "$lexer is not executable\n" unless -x $lexer;
+foreach my $o (split(' ', $objs)) {
+    die "$o not found; build the parser with 'make parser'\n" unless -f $o;
+}
+
+# The driver.  It stands in for parser-phase.cc, so it defines what that
+# does; token_file is weak in case one of the other files defines it.
+my $driver = <<'END';
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "cool-tree.h"
+#include "compact-tree.h"
+
+FILE *token_file __attribute__((weak)) = stdin;
+
+extern Classes parse_results;
+extern int omerrs;
+extern int cool_yyparse();
+
+static double now()
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+  int runs = atoi(argv[2]);
+  size_t counts[2];
+
+  if ((token_file = fopen(argv[1], "r")) == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+  cool_yyparse();
+  if (omerrs != 0 || parse_results == NULL) {
+    fprintf(stderr, "%s: the program did not parse\n", argv[1]);
+    return 1;
+  }
+  size_t pointer_bytes = node_arena::current().used();
+  Program tree = program(parse_results);
+  compact_tree compact;
+  compact.build(tree);
+
+  for (int form = 0; form < 2; form++) {
+    double best = 0;
+    uint64_t sum = 0;
+
+    for (int i = 0; i < runs; i++) {
+      double start = now();
+      if (form == 0) {
+        tree_walk walk;
+        walk.run(tree);
+        counts[form] = walk.nodes;
+        sum = walk.sum;
+      } else
+        counts[form] = compact.walk(sum);
+      double t = now() - start;
+      if (i == 0 || t < best)
+        best = t;
+    }
+    printf("%s %lu %.4f %lu %lu\n", form == 0 ? "pointer" : "compact",
+           (unsigned long) counts[form], best,
+           (unsigned long) (form == 0 ? pointer_bytes : compact.bytes()),
+           (unsigned long) (sum & 1));
+  }
+  return counts[0] == counts[1] ? 0 : 1;
+}
+END
+
+# Code with every kind of expression, repeated with a new class name.
+my $code = <<'END';
+class C%N% inherits IO {
+  x : Int <- %N%;
+  f(a : Int, s : String) : Object {
+    let b : Bool <- true in
+      if isvoid s then a * 2 + 1 else while not b loop b <- false pool fi
+  };
+  g() : String { case self of o : Object => "text %N%\n"; esac };
+  h(n : Int) : Int {
+    { x <- ~n; (new C%N%)@IO.out_int(n); f(n - 1, ""); (n / 2 <= x) = false; }
+  };
+};
+END
+
+my $dir = tempdir("tree-walk-bench-XXXXXX", TMPDIR => 1, CLEANUP => 1);
+open(my $out, ">", "$dir/bench.cc") or die "$dir/bench.cc: $!\n";
+print $out $driver;
+close($out);
+system("$cxx $cxxflags $dir/bench.cc $objs -o $dir/bench -lpthread") == 0
+    or die "could not build the driver\n";
+
+my $file = "$dir/program.cl";
+my $bytes = $size << 20;
+open($out, ">", $file) or die "$file: $!\n";
+for (my ($n, $written) = (0, 0); $written < $bytes; $n++) {
+    (my $class = $code) =~ s/%N%/$n/g;
+    print $out $class;
+    $written += length($class);
+}
+close($out);
+# The driver needs the whole pointer tree, which a cached or outline
+# parse does not leave in parse_results.
+delete @ENV{qw(COOL_PARSE_CACHE COOL_AST_FORMAT)};
+{
+    local $ENV{COOL_TOKEN_FORMAT} = "binary";
+    system("$lexer $file > $dir/program.tok") == 0
+	or die "$lexer $file failed\n";
+}
+
+printf("%-8s %10s %8s %10s %12s %10s\n", "form", "nodes", "s", "Mnodes/s",
+       "bytes", "bytes/node");
+open(my $pipe, "-|", "$dir/bench", "$dir/program.tok", $runs)
+    or die "$dir/bench: $!\n";
+while (<$pipe>) {
+    my ($form, $nodes, $t, $used) = split;
+    printf("%-8s %10d %8.4f %10.2f %12d %10.1f\n", $form, $nodes, $t,
+	   $nodes / $t / 1e6, $used, $used / $nodes);
+}
+close($pipe);
+if ($? != 0) {
+    print "the two walks counted different nodes\n";
+    exit(1);
+}
+exit(0);
@@ -98,7 +98,8 @@ public:
    tree_node *copy()		 { return copy_Expression(); }
    virtual Expression copy_Expression() = 0;
 
-   virtual Symbol typecheck(type_env &tenv) = 0;
+   Symbol typecheck(type_env &tenv);
+   virtual Expression check_step(type_env &tenv, int step) = 0;
 
 #ifdef Expression_EXTRAS
    Expression_EXTRAS
@@ -371,7 +372,7 @@ public:
       return name;
    }
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -395,11 +396,15 @@ public:
       type_name = a2;
       name = a3;
       actual = a4;
+      method = NULL;
+      formals = NULL;
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
+   method_class *method;	// found at step 1 of check_step()
+   Formals formals;
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -421,11 +426,15 @@ public:
       expr = a1;
       name = a2;
       actual = a3;
+      method = NULL;
+      formals = NULL;
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
+   method_class *method;	// found at step 1 of check_step()
+   Formals formals;
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -451,7 +460,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -475,7 +484,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -499,7 +508,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -521,7 +530,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -549,7 +558,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -573,7 +582,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -597,7 +606,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -621,7 +630,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -645,7 +654,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -667,7 +676,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -691,7 +700,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -715,7 +724,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -739,7 +748,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -761,7 +770,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -783,7 +792,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -805,7 +814,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -827,7 +836,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -849,7 +858,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -871,7 +880,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -891,7 +900,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
@@ -913,7 +922,7 @@ public:
    Expression copy_Expression();
    void dump(ostream& stream, int n);
 
-   Symbol typecheck(type_env &tenv);
+   Expression check_step(type_env &tenv, int step);
 
    Symbol get_name() {
       return name;
@@ -391,35 +391,59 @@ method_class *lookup_method(Symbol cls_name, Symbol method_name) {
 }
 
 // Type checking
+//
+// An expression is checked in steps, so that deep nesting costs heap
+// rather than C stack: typecheck() calls check_step(tenv, 0), then 1, 2,
+// ..., and whenever a step returns a subexpression, checks that one
+// first.  The next step finds its type in its type field.  The last
+// step sets the type of the expression and returns nullptr.
+
+Symbol Expression_class::typecheck(type_env &tenv) {
+    std::vector<std::pair<Expression, int> > work;
+    work.push_back(std::make_pair(this, 0));
+
+    while (!work.empty()) {
+        Expression e = work.back().first;
+        Expression sub = e->check_step(tenv, work.back().second++);
+
+        if (sub) {
+            work.push_back(std::make_pair(sub, 0));
+        } else {
+            work.pop_back();
+        }
+    }
+    return type;
+}
 
-
-Symbol int_const_class::typecheck(type_env &tenv) {
+Expression int_const_class::check_step(type_env &tenv, int step) {
     type = Int;
-    return type;
+    return nullptr;
 }
 
-Symbol bool_const_class::typecheck(type_env &tenv) {
+Expression bool_const_class::check_step(type_env &tenv, int step) {
     type = Bool;
-    return type;
+    return nullptr;
 }
 
-Symbol string_const_class::typecheck(type_env &tenv) {
+Expression string_const_class::check_step(type_env &tenv, int step) {
     type = Str;
-    return type;
+    return nullptr;
 }
 
-Symbol no_expr_class::typecheck(type_env &tenv) {
+Expression no_expr_class::check_step(type_env &tenv, int step) {
     type = No_type;
-    return type;
+    return nullptr;
 }
 
-Symbol isvoid_class::typecheck(type_env &tenv) {
-    e1->typecheck(tenv);
+Expression isvoid_class::check_step(type_env &tenv, int step) {
+    if (step == 0) {
+        return e1;
+    }
     type = Bool;
-    return type;
+    return nullptr;
 }
 
-Symbol new__class::typecheck(type_env &tenv) {
+Expression new__class::check_step(type_env &tenv, int step) {
     Symbol t = type_name;
     if (!cls_is_defined(t)) {
         classtable->semant_error(tenv.c -> get_filename(), this) << "Class " << t << " is not defined." << std::endl;
@@ -427,16 +451,19 @@ Symbol new__class::typecheck(type_env &tenv) {
     } else {
         type = t;
     }
-    return type;
+    return nullptr;
 }
 
-Symbol comp_class::typecheck(type_env &tenv) {
-    type = e1->typecheck(tenv);
+Expression comp_class::check_step(type_env &tenv, int step) {
+    if (step == 0) {
+        return e1;
+    }
+    type = e1->get_type();
     if (type != Bool) {
         classtable->semant_error(tenv.c->get_filename(), this) << "Argument of 'not' has type " << type << " instead of Bool." << std::endl;
     }
     type = Bool;
-    return type;
+    return nullptr;
 }
 
 Symbol attr_class::typecheck(type_env &tenv) {
@@ -457,207 +484,283 @@ Symbol attr_class::typecheck(type_env &tenv) {
     return t0;
 }
 
-Symbol loop_class::typecheck(type_env &tenv) {
-    if (pred->typecheck(tenv) != Bool) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "Loop condition does not have type Bool." << std::endl;
+Expression loop_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return pred;
+    case 1:
+        if (pred->get_type() != Bool) {
+            classtable->semant_error(tenv.c->get_filename(), this) << "Loop condition does not have type Bool." << std::endl;
+        }
+        return body;
     }
-    body->typecheck(tenv);
     type = Object;
-    return type;
+    return nullptr;
 }
 
-Symbol block_class::typecheck(type_env &tenv) {
-    for (int i = body->first(); body->more(i); i = body->next(i)) {
-        type = body->nth(i)->typecheck(tenv);
+Expression block_class::check_step(type_env &tenv, int step) {
+    if (step > 0) {
+        type = body->nth(step - 1)->get_type();
     }
-    return type;
+    if (body->more(step)) {
+        return body->nth(step);
+    }
+    return nullptr;
 }
 
-Symbol cond_class::typecheck(type_env &tenv) {
-    Symbol t1 = pred->typecheck(tenv);
-    Symbol t2 = then_exp->typecheck(tenv);
-    Symbol t3 = else_exp->typecheck(tenv);
+Expression cond_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return pred;
+    case 1:
+        return then_exp;
+    case 2:
+        return else_exp;
+    }
 
-    if (t1 != Bool) {
+    if (pred->get_type() != Bool) {
         classtable->semant_error(tenv.c->get_filename(), this) << "Predicate of 'if' does not have type Bool." << std::endl;
     }
-    type = cls_join(t2, t3, tenv);
-    return type;
+    type = cls_join(then_exp->get_type(), else_exp->get_type(), tenv);
+    return nullptr;
 }
 
-Symbol plus_class::typecheck(type_env &tenv) {
-    if (e1->typecheck(tenv) != Int || e2->typecheck(tenv) != Int) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->typecheck(tenv) << " + " << e2->typecheck(tenv) << std::endl;
+Expression plus_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return e1;
+    case 1:
+        return e2;
+    }
+
+    if (e1->get_type() != Int || e2->get_type() != Int) {
+        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->get_type() << " + " << e2->get_type() << std::endl;
         type = Object;
     } else {
         type = Int;
     }
-    return type;
+    return nullptr;
 }
 
-Symbol sub_class::typecheck(type_env &tenv) {
-    if (e1->typecheck(tenv) != Int || e2->typecheck(tenv) != Int) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->typecheck(tenv) << " - " << e2->typecheck(tenv) << std::endl;
+Expression sub_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return e1;
+    case 1:
+        return e2;
+    }
+
+    if (e1->get_type() != Int || e2->get_type() != Int) {
+        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->get_type() << " - " << e2->get_type() << std::endl;
         type = Object;
     } else {
         type = Int;
     }
-    return type;
+    return nullptr;
 }
 
-Symbol mul_class::typecheck(type_env &tenv) {
-    if (e1->typecheck(tenv) != Int || e2->typecheck(tenv) != Int) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->typecheck(tenv) << " * " << e2->typecheck(tenv) << std::endl;
+Expression mul_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return e1;
+    case 1:
+        return e2;
+    }
+
+    if (e1->get_type() != Int || e2->get_type() != Int) {
+        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->get_type() << " * " << e2->get_type() << std::endl;
         type = Object;
     } else {
         type = Int;
     }
-    return type;
+    return nullptr;
 }
 
-Symbol divide_class::typecheck(type_env &tenv) {
-    if (e1->typecheck(tenv) != Int || e2->typecheck(tenv) != Int) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->typecheck(tenv) << " / " << e2->typecheck(tenv) << std::endl;
+Expression divide_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return e1;
+    case 1:
+        return e2;
+    }
+
+    if (e1->get_type() != Int || e2->get_type() != Int) {
+        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->get_type() << " / " << e2->get_type() << std::endl;
         type = Object;
     } else {
         type = Int;
     }
-    return type;
+    return nullptr;
 }
 
-Symbol neg_class::typecheck(type_env &tenv) {
-    type = e1->typecheck(tenv);
+Expression neg_class::check_step(type_env &tenv, int step) {
+    if (step == 0) {
+        return e1;
+    }
+    type = e1->get_type();
     if (type != Int) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "Argument of '~' has type " << e1->typecheck(tenv) << " instead of Int." << std::endl;
+        classtable->semant_error(tenv.c->get_filename(), this) << "Argument of '~' has type " << type << " instead of Int." << std::endl;
         type = Int;
     }
-    return type;
+    return nullptr;
 }
 
-Symbol lt_class::typecheck(type_env &tenv) {
-    if (e1->typecheck(tenv) != Int || e2->typecheck(tenv) != Int) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->typecheck(tenv) << " < " << e2->typecheck(tenv) << std::endl;
+Expression lt_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return e1;
+    case 1:
+        return e2;
+    }
+
+    if (e1->get_type() != Int || e2->get_type() != Int) {
+        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->get_type() << " < " << e2->get_type() << std::endl;
     }
     type = Bool;
-    return type;
+    return nullptr;
 }
 
-Symbol eq_class::typecheck(type_env &tenv) {
-    Symbol t1 = e1->typecheck(tenv);
-    Symbol t2 = e2->typecheck(tenv);
+Expression eq_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return e1;
+    case 1:
+        return e2;
+    }
+
+    Symbol t1 = e1->get_type();
+    Symbol t2 = e2->get_type();
 
     if ((t1 == Int || t1 == Bool || t1 == Str || t2 == Int || t2 == Bool || t2 == Str) && t1 != t2) {
         classtable->semant_error(tenv.c->get_filename(), this) << "Illegal comparison with a basic type." << std::endl;
     }
     type = Bool;
-    return type;
+    return nullptr;
 }
 
-Symbol leq_class::typecheck(type_env &tenv) {
-    if (e1->typecheck(tenv) != Int || e2->typecheck(tenv) != Int) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->typecheck(tenv) << " <= " << e2->typecheck(tenv) << std::endl;
+Expression leq_class::check_step(type_env &tenv, int step) {
+    switch (step) {
+    case 0:
+        return e1;
+    case 1:
+        return e2;
+    }
+
+    if (e1->get_type() != Int || e2->get_type() != Int) {
+        classtable->semant_error(tenv.c->get_filename(), this) << "non-Int arguments: " << e1->get_type() << " <= " << e2->get_type() << std::endl;
     }
     type = Bool;
-    return type;
+    return nullptr;
 }
 
-Symbol object_class::typecheck(type_env &tenv) {
+Expression object_class::check_step(type_env &tenv, int step) {
     Symbol *t = tenv.o.lookup(name);
     if (!t) {
         classtable->semant_error(tenv.c->get_filename(), this) << "Undeclared identifier " << name << "." << std::endl;
         type = Object;
-        return type;
+        return nullptr;
     }
     type = *t;
-    return type;
+    return nullptr;
 }
 
-Symbol assign_class::typecheck(type_env &tenv) {
+Expression assign_class::check_step(type_env &tenv, int step) {
     type = Object;
 
-    if (name == self) {
-        classtable->semant_error(tenv.c->get_filename(), this) << "Cannot assign to 'self'." << std::endl;
-        return type;
+    if (step == 0) {
+        if (name == self) {
+            classtable->semant_error(tenv.c->get_filename(), this) << "Cannot assign to 'self'." << std::endl;
+            return nullptr;
+        }
+        return expr;
     }
 
     Symbol *t = tenv.o.lookup(name);
-    Symbol t1 = expr->typecheck(tenv);
+    Symbol t1 = expr->get_type();
 
     if (!t) {
         classtable->semant_error(tenv.c->get_filename(), this) << "Assignment to undeclared variable " << name << "." << std::endl;
-        return type;
+        return nullptr;
     }
 
     if (!is_subclass(t1, *t, tenv)) {
         classtable->semant_error(tenv.c->get_filename(), this) << "Type " << t1 << " of assigned expression does not conform to declared type " << *t << " of identifier " << name << "." << std::endl;
-        return type;
+        return nullptr;
     }
     type = t1;
-    return type;
+    return nullptr;
 }
 
-Symbol let_class::typecheck(type_env &tenv) {
+Expression let_class::check_step(type_env &tenv, int step) {
+    if (step == 0) {
+        return init;
+    }
 
-    Symbol t0 = type_decl;
-    Symbol t1 = init->typecheck(tenv);
+    if (step == 1) {
+        Symbol t0 = type_decl;
+        Symbol t1 = init->get_type();
 
-    if (t1 != No_type && !is_subclass(t1, t0, tenv)) {
-        classtable->semant_error(tenv.c->get_filename(), this) <<
-            "Inferred type " << t1 << " of initialization of " << identifier <<
-            " does not conform to identifier's declared type " << t0 << "." << std::endl;
-    }
+        if (t1 != No_type && !is_subclass(t1, t0, tenv)) {
+            classtable->semant_error(tenv.c->get_filename(), this) <<
+                "Inferred type " << t1 << " of initialization of " << identifier <<
+                " does not conform to identifier's declared type " << t0 << "." << std::endl;
+        }
 
-    tenv.o.enterscope();
+        tenv.o.enterscope();
 
-    if (identifier != self) {
-        tenv.o.addid(identifier, new Symbol(t0));
-    } else {
-        classtable->semant_error(tenv.c->get_filename(), this) <<
-            "'self' cannot be bound in a 'let' expression." << std::endl;
+        if (identifier != self) {
+            tenv.o.addid(identifier, new Symbol(t0));
+        } else {
+            classtable->semant_error(tenv.c->get_filename(), this) <<
+                "'self' cannot be bound in a 'let' expression." << std::endl;
+        }
+
+        return body;
     }
 
-    type = body->typecheck(tenv);
+    type = body->get_type();
 
     tenv.o.exitscope();
 
-    return type;
+    return nullptr;
 }
 
-Symbol typcase_class::typecheck(type_env &tenv) {
+// Step i + 1 checks branch i, in a scope of its own which step i + 2
+// leaves, joining the type of the branch with those before it.
+Expression typcase_class::check_step(type_env &tenv, int step) {
+    if (step == 0) {
+        return expr;
+    }
 
-    Symbol t0 = expr->typecheck(tenv);
+    int i = step - 1;
 
-    std::vector<Symbol> used;
+    if (i > 0) {
+        Symbol t = cases->nth(i - 1)->get_expr()->get_type();
+        type = i > 1 ? cls_join(t, type, tenv) : t;
+        tenv.o.exitscope();
+    }
 
-    for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
-        Symbol prev_type = type;
+    if (!cases->more(i)) {
+        return nullptr;
+    }
 
-        Case c = cases->nth(i);
-        Symbol type_decl = c->get_type_decl();
+    Case c = cases->nth(i);
+    Symbol type_decl = c->get_type_decl();
 
-        if (std::find(used.begin(), used.end(), type_decl) == used.end() ) {
-            used.push_back(type_decl);
-        } else {
+    for (int j = 0; j < i; j++) {
+        if (cases->nth(j)->get_type_decl() == type_decl) {
             classtable->semant_error(tenv.c->get_filename(), this) <<
                 "Duplicate branch " << type_decl << " in case statement." << std::endl;
 
             type = Object;
-            return type;
+            return nullptr;
         }
-
-        tenv.o.enterscope();
-
-        tenv.o.addid(c->get_name(), new Symbol(type_decl));
-        type = c->get_expr()->typecheck(tenv);
-
-        if (i > 0) {
-            type = cls_join(type, prev_type, tenv);
-        }
-
-        tenv.o.exitscope();
     }
 
-    return type;
+    tenv.o.enterscope();
+
+    tenv.o.addid(c->get_name(), new Symbol(type_decl));
+    return c->get_expr();
 }
 
 Symbol method_class::typecheck(type_env &tenv) {
@@ -745,46 +848,52 @@ Symbol method_class::typecheck(type_env &tenv) {
     return Object;
 }
 
-Symbol dispatch_class::typecheck(type_env &tenv) {
-    Symbol t0 = expr->typecheck(tenv);
-    Symbol t0_ = t0;
-    if (t0_ == SELF_TYPE) {
-        t0_ = tenv.c->get_name();
+// Step i + 1 checks actual i, and step i + 2 its conformance to the
+// formal it is passed for.  The method is looked up once, at step 1,
+// and kept with its formals for the steps after.
+Expression dispatch_class::check_step(type_env &tenv, int step) {
+    if (step == 0) {
+        return expr;
     }
 
-    method_class *method = lookup_method(t0_, name);
-    if (!method) {
-        classtable->semant_error(tenv.c->get_filename(), this) <<
-            "Dispatch to undefined method " << name << "." << std::endl;
+    Symbol t0 = expr->get_type();
+    int i = step - 1;
 
-        type = Object;
-        return type;
-    }
-
-    Formals formals = method->get_formals();
+    if (i == 0) {
+        Symbol t0_ = t0;
+        if (t0_ == SELF_TYPE) {
+            t0_ = tenv.c->get_name();
+        }
 
-    bool formals_are_less;
-    int i;
+        method = lookup_method(t0_, name);
+        if (!method) {
+            classtable->semant_error(tenv.c->get_filename(), this) <<
+                "Dispatch to undefined method " << name << "." << std::endl;
 
-    for (i = actual->first(); actual->more(i); i = actual->next(i)) {
-        Symbol t_actual = actual->nth(i)->typecheck(tenv);
+            type = Object;
+            return nullptr;
+        }
+        formals = method->get_formals();
+    }
 
-        if (formals->more(i)) {
-            Formal f = formals->nth(i);
-            Symbol t_formal = f->get_type_decl();
+    if (i > 0 && formals->more(i - 1)) {
+        Symbol t_actual = actual->nth(i - 1)->get_type();
+        Formal f = formals->nth(i - 1);
+        Symbol t_formal = f->get_type_decl();
 
-            if (!is_subclass(t_actual, t_formal, tenv)) {
-                classtable->semant_error(tenv.c->get_filename(), this) <<
-                    "In call of method " << name << ", type " << t_actual <<
-                    " of parameter " << f->get_name() << " does not conform to "
-                    "declared type " << t_formal << "." << std::endl;
-            }
-        } else {
-            formals_are_less = true;
+        if (!is_subclass(t_actual, t_formal, tenv)) {
+            classtable->semant_error(tenv.c->get_filename(), this) <<
+                "In call of method " << name << ", type " << t_actual <<
+                " of parameter " << f->get_name() << " does not conform to "
+                "declared type " << t_formal << "." << std::endl;
         }
     }
 
-    if (formals_are_less || formals->more(i)) {
+    if (actual->more(i)) {
+        return actual->nth(i);
+    }
+
+    if (actual->len() != formals->len()) {
         classtable->semant_error(tenv.c->get_filename(), this) <<
             "Method " << name << " called with wrong number of arguments." << std::endl;
     }
@@ -794,52 +903,54 @@ Symbol dispatch_class::typecheck(type_env &tenv) {
         type = t0;
     }
 
-    return type;
+    return nullptr;
 }
 
-Symbol static_dispatch_class::typecheck(type_env &tenv) {
-    
-    Symbol t0 = expr->typecheck(tenv);
-    Symbol t = type_name;
-
-    if (!is_subclass(t0, t, tenv)) {
-        classtable->semant_error(tenv.c->get_filename(), this) <<
-            "Expression type " << t0 << " does not conform to declared static "
-            "dispatch type " << t << "." << std::endl;
-    }
-
-    method_class *method = lookup_method(t, name);
-    if (!method) {
-        classtable->semant_error(tenv.c->get_filename(), this) <<
-            "Dispatch to undefined method " << name << "." << std::endl;
-        type = Object;
-        return type;
+// As for dispatch, after the static type is checked at step 1.
+Expression static_dispatch_class::check_step(type_env &tenv, int step) {
+    if (step == 0) {
+        return expr;
     }
 
-    Formals formals = method->get_formals();
+    Symbol t0 = expr->get_type();
+    Symbol t = type_name;
+    int i = step - 1;
 
-    bool formals_are_less;
-    int i;
+    if (i == 0) {
+        if (!is_subclass(t0, t, tenv)) {
+            classtable->semant_error(tenv.c->get_filename(), this) <<
+                "Expression type " << t0 << " does not conform to declared static "
+                "dispatch type " << t << "." << std::endl;
+        }
 
-    for (i = actual->first(); actual->more(i); i = actual->next(i)) {
-        Symbol t_actual = actual->nth(i)->typecheck(tenv);
+        method = lookup_method(t, name);
+        if (!method) {
+            classtable->semant_error(tenv.c->get_filename(), this) <<
+                "Dispatch to undefined method " << name << "." << std::endl;
+            type = Object;
+            return nullptr;
+        }
+        formals = method->get_formals();
+    }
 
-        if (formals->more(i)) {
-            Formal f = formals->nth(i);
-            Symbol t_formal = f->get_type_decl();
+    if (i > 0 && formals->more(i - 1)) {
+        Symbol t_actual = actual->nth(i - 1)->get_type();
+        Formal f = formals->nth(i - 1);
+        Symbol t_formal = f->get_type_decl();
 
-            if (!is_subclass(t_actual, t_formal, tenv)) {
-                classtable->semant_error(tenv.c->get_filename(), this) <<
-                    "In call of method " << name << ", type " << t_actual <<
-                    " of parameter " << f->get_name() << " does not conform to "
-                    "declared type " << t_formal << "." << std::endl;
-            }
-        } else {
-            formals_are_less = true;
+        if (!is_subclass(t_actual, t_formal, tenv)) {
+            classtable->semant_error(tenv.c->get_filename(), this) <<
+                "In call of method " << name << ", type " << t_actual <<
+                " of parameter " << f->get_name() << " does not conform to "
+                "declared type " << t_formal << "." << std::endl;
         }
     }
 
-    if (formals_are_less || formals->more(i)) {
+    if (actual->more(i)) {
+        return actual->nth(i);
+    }
+
+    if (actual->len() != formals->len()) {
         classtable->semant_error(tenv.c->get_filename(), this) <<
             "Method " << name << " called with wrong number of arguments." << std::endl;
     }
@@ -849,8 +960,7 @@ Symbol static_dispatch_class::typecheck(type_env &tenv) {
         type = t0;
     }
 
-    return type;
-		
+    return nullptr;
 }
 
 